@@ -0,0 +1,28 @@
+// ColorMatrices.h
+// Generated from ColorMatrices.json by GenerateColorMatrices (make ColorMatrices.h); do not edit.
+// Row-major 3x3 matrices. MatrixManager serves these unless a JSON override is set.
+#pragma once
+
+namespace ColorMatrices
+{
+
+#define kColorMatrixDisplays 2      // creative white sets: Rec.709, P3-D65
+#define kColorMatrixWhites 4        // D65 (identity), D60, D55, D50
+
+// Creative white from P3-D65, by [display][white]; Rec.2020 displays use P3-D65's
+constexpr float kCreativeWhite[kColorMatrixDisplays][kColorMatrixWhites][9] = {
+    {
+        { 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f },
+        { 1.18998682f, -0.192168415f, 0.00218549604f, -0.0416826345f, 0.992775679f, -5.56608793e-05f, -0.0193799511f, -0.0793300718f, 0.973439693f },
+        { 1.14932752f, -0.153691068f, 0.00436652685f, -0.0412590764f, 0.935171723f, -0.000116126219f, -0.0190094952f, -0.0792828277f, 0.843788445f },
+        { 1.10380733f, -0.11034251f, 0.00653167628f, -0.0407938659f, 0.870469451f, -0.000180522635f, -0.0185405593f, -0.0785758272f, 0.710549891f }
+    },
+    {
+        { 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f },
+        { 0.979832888f, 0.0183637906f, 0.00180328474f, -0.000805359799f, 0.961800039f, 1.88761205e-05f, -0.00033838232f, -0.00367183588f, 0.894139111f },
+        { 0.955979109f, 0.0403850004f, 0.00363928732f, -0.00177192991f, 0.91630584f, 3.33007592e-05f, -0.000674760784f, -0.00724663585f, 0.783118904f },
+        { 0.928712726f, 0.0657803267f, 0.00550670829f, -0.00288715912f, 0.864070952f, 4.35937181e-05f, -0.00100955158f, -0.0107350331f, 0.66726923f }
+    }
+};
+
+} // namespace ColorMatrices
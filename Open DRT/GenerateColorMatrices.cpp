@@ -0,0 +1,81 @@
+// GenerateColorMatrices.cpp
+// Build step (make ColorMatrices.h): writes ColorMatrices.json out as constexpr tables, so
+// the plugin has its matrices without reading a file when a host loads it. The file is read
+// with MatrixFile, as an override is at run time. Only the creative white matrices are
+// written: the plugin's input gamut matrices are OpenDRTPresets.h's, and the JSON's
+// input_gamuts and output_gamuts sections are not used.
+//
+//   GenerateColorMatrices ColorMatrices.json > ColorMatrices.h
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "MatrixFile.h"
+
+/***************************************************
+ Output
+--------------------------------------------------*/
+static const float kIdentity[9] = { 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+
+// %.9g reads back as the same float
+static void printMatrix(const float m[9], const char* indent)
+{
+    printf("%s{ ", indent);
+    for (int i = 0; i < 9; ++i) {
+        char number[32];
+        snprintf(number, sizeof(number), "%.9g", m[i]);
+        if (!strpbrk(number, ".e")) strcat(number, ".0");
+        printf("%sf%s", number, i < 8 ? ", " : " }");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s ColorMatrices.json > ColorMatrices.h\n", argv[0]);
+        return 2;
+    }
+    // Read as the plugin reads an override, so the two cannot disagree on a number
+    MatrixFile file;
+    std::string error;
+    if (!file.load(argv[1], error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    // Creative white per display, D65 (identity) first
+    const char* displays[2] = { "rec709", "p3d65" };
+    const char* whites[3] = { "d60", "d55", "d50" };
+    float creativeWhite[2][4][9];
+    for (int d = 0; d < 2; ++d) {
+        memcpy(creativeWhite[d][0], kIdentity, sizeof(kIdentity));
+        for (int w = 0; w < 3; ++w) {
+            const std::string key = std::string("creative_whitepoints/") + displays[d] + "/" + whites[w];
+            const float* matrix = file.find(key);
+            if (!matrix) {
+                fprintf(stderr, "%s: no creative white matrix %s\n", argv[1], key.c_str());
+                return 1;
+            }
+            memcpy(creativeWhite[d][w + 1], matrix, 9*sizeof(float));
+        }
+    }
+
+    printf("// ColorMatrices.h\n");
+    printf("// Generated from ColorMatrices.json by GenerateColorMatrices (make ColorMatrices.h); do not edit.\n");
+    printf("// Row-major 3x3 matrices. MatrixManager serves these unless a JSON override is set.\n");
+    printf("#pragma once\n\nnamespace ColorMatrices\n{\n\n");
+    printf("#define kColorMatrixDisplays 2      // creative white sets: Rec.709, P3-D65\n");
+    printf("#define kColorMatrixWhites 4        // D65 (identity), D60, D55, D50\n\n");
+
+    printf("// Creative white from P3-D65, by [display][white]; Rec.2020 displays use P3-D65's\n");
+    printf("constexpr float kCreativeWhite[kColorMatrixDisplays][kColorMatrixWhites][9] = {\n");
+    for (int d = 0; d < 2; ++d) {
+        printf("    {\n");
+        for (int w = 0; w < 4; ++w) {
+            printMatrix(creativeWhite[d][w], "        ");
+            printf("%s\n", w < 3 ? "," : "");
+        }
+        printf("    }%s\n", d < 1 ? "," : "");
+    }
+    printf("};\n\n} // namespace ColorMatrices\n");
+    return 0;
+}
@@ -0,0 +1,358 @@
+#include "MatrixFile.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <fstream>
+#include <sstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only view of a whole file: mapped where the system can, else read into memory
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filePath) : m_Data(nullptr), m_Size(0) {
+#ifdef _WIN32
+        std::ifstream file(filePath, std::ios::binary);
+        if (!file.is_open()) return;
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        m_Copy = buffer.str();
+        m_Data = m_Copy.data();
+        m_Size = m_Copy.size();
+        m_Open = true;
+#else
+        int fd = open(filePath.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat info;
+        if (fstat(fd, &info) == 0) {
+            m_Open = true;
+            m_Size = (size_t)info.st_size;
+            if (m_Size > 0) {
+                void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data == MAP_FAILED) {
+                    m_Open = false;
+                    m_Size = 0;
+                } else {
+                    m_Data = static_cast<const char*>(data);
+                }
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (m_Data) munmap(const_cast<char*>(m_Data), m_Size);
+#endif
+    }
+
+    bool isOpen() const { return m_Open; }
+    std::string_view text() const { return std::string_view(m_Data ? m_Data : "", m_Size); }
+
+private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* m_Data;
+    size_t m_Size;
+    bool m_Open = false;
+#ifdef _WIN32
+    std::string m_Copy;
+#endif
+};
+
+// Recursive descent over the text, recording matrices as they close. The path of keys is
+// one string that grows and shrinks with the nesting, so a value costs no allocation.
+class MatrixParser {
+public:
+    MatrixParser(std::string_view text, std::vector<MatrixEntry>& entries, std::vector<MatrixString>& strings)
+        : m_Text(text), m_Pos(0), m_Entries(entries), m_Strings(strings) {}
+
+    bool parse() {
+        if (!parseValue(0)) return false;
+        skipSpace();
+        if (m_Pos != m_Text.size()) return fail("unexpected text after the document");
+        return true;
+    }
+
+    // "line:column: message" for the failure
+    std::string error() const {
+        size_t line = 1, lineStart = 0;
+        for (size_t i = 0; i < m_Pos && i < m_Text.size(); ++i) {
+            if (m_Text[i] == '\n') {
+                ++line;
+                lineStart = i + 1;
+            }
+        }
+        return std::to_string(line) + ":" + std::to_string(m_Pos - lineStart + 1) + ": " + m_Error;
+    }
+
+private:
+    // Nesting is bounded so a hostile file cannot exhaust the stack
+    static const int kMaxDepth = 256;
+
+    // Shape of the array being read, to tell if it is a matrix
+    struct Shape {
+        float v[9];
+        int count;          // numbers read, in rows or flat
+        int rows;
+        int flat;
+        bool ok;
+    };
+
+    bool fail(const char* message) {
+        m_Error = message;
+        return false;
+    }
+
+    void skipSpace() {
+        while (m_Pos < m_Text.size()) {
+            char c = m_Text[m_Pos];
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+            ++m_Pos;
+        }
+    }
+
+    bool peek(char c) {
+        skipSpace();
+        return m_Pos < m_Text.size() && m_Text[m_Pos] == c;
+    }
+
+    bool expect(char c, const char* message) {
+        if (!peek(c)) return fail(message);
+        ++m_Pos;
+        return true;
+    }
+
+    // Contents of a string, escapes left as written
+    bool parseString(std::string_view& value) {
+        if (!expect('"', "expected a string")) return false;
+        size_t start = m_Pos;
+        while (m_Pos < m_Text.size() && m_Text[m_Pos] != '"') {
+            if ((unsigned char)m_Text[m_Pos] < 0x20) return fail("control character in string");
+            m_Pos += m_Text[m_Pos] == '\\' ? 2 : 1;
+        }
+        if (m_Pos >= m_Text.size()) {
+            m_Pos = start - 1;
+            return fail("unterminated string");
+        }
+        value = m_Text.substr(start, m_Pos - start);
+        ++m_Pos;
+        return true;
+    }
+
+    bool parseNumber(float& value) {
+        size_t start = m_Pos;
+        while (m_Pos < m_Text.size() && m_Text[m_Pos] && strchr("+-.0123456789eE", m_Text[m_Pos])) ++m_Pos;
+        size_t length = m_Pos - start;
+        if (length == 0) return fail("bad number");
+
+#if defined(__cpp_lib_to_chars)
+        // In place, and several times quicker than strtof on long literals
+        std::from_chars_result result = std::from_chars(m_Text.data() + start, m_Text.data() + m_Pos, value);
+        if (result.ec != std::errc() || result.ptr != m_Text.data() + m_Pos) {
+            m_Pos = start;
+            return fail("bad number");
+        }
+#else
+        // strtof needs a terminated copy; numbers are short
+        char buffer[64];
+        if (length >= sizeof(buffer)) {
+            m_Pos = start;
+            return fail("bad number");
+        }
+        memcpy(buffer, m_Text.data() + start, length);
+        buffer[length] = 0;
+        char* end;
+        value = strtof(buffer, &end);
+        if (end != buffer + length) {
+            m_Pos = start;
+            return fail("bad number");
+        }
+#endif
+        return true;
+    }
+
+    bool parseLiteral() {
+        static const char* literals[3] = { "true", "false", "null" };
+        for (const char* literal : literals) {
+            size_t length = strlen(literal);
+            if (m_Text.compare(m_Pos, length, literal) == 0) {
+                m_Pos += length;
+                return true;
+            }
+        }
+        return fail("unexpected character");
+    }
+
+    bool parseObject(int depth) {
+        ++m_Pos;
+        if (peek('}')) {
+            ++m_Pos;
+            return true;
+        }
+        do {
+            std::string_view key;
+            if (!parseString(key) || !expect(':', "expected ':' after key")) return false;
+
+            // "a/b/matrix" is kept as "a/b"
+            size_t pathLength = m_Path.size();
+            if (key != "matrix") {
+                if (!m_Path.empty()) m_Path += '/';
+                m_Path.append(key.data(), key.size());
+            }
+            if (peek('"')) {
+                std::string_view value;
+                if (!parseString(value)) return false;
+                m_Strings.push_back(MatrixString());
+                m_Strings.back().key = m_Path;
+                m_Strings.back().value.assign(value.data(), value.size());
+            } else if (!parseValue(depth + 1)) {
+                return false;
+            }
+            m_Path.resize(pathLength);
+        } while (peek(',') && ++m_Pos);
+        return expect('}', "expected ',' or '}'");
+    }
+
+    // Numbers go into shape if the array may still be a matrix; row says the array is one
+    // of the matrix's rows
+    bool parseArray(int depth, Shape* shape, bool row) {
+        ++m_Pos;
+        int rowCount = 0;
+        if (!peek(']')) {
+            do {
+                skipSpace();
+                if (m_Pos >= m_Text.size()) return fail("unexpected end of file");
+                char c = m_Text[m_Pos];
+                if (c == '-' || (c >= '0' && c <= '9')) {
+                    float value;
+                    if (!parseNumber(value)) return false;
+                    if (shape && shape->count < 9) shape->v[shape->count] = value;
+                    if (shape) ++shape->count;
+                    if (row) ++rowCount;
+                    else if (shape) ++shape->flat;
+                } else if (c == '[' && shape && !row) {
+                    ++shape->rows;
+                    if (!parseArray(depth + 1, shape, true)) return false;
+                } else {
+                    if (shape) shape->ok = false;
+                    if (!parseValue(depth + 1)) return false;
+                }
+            } while (peek(',') && ++m_Pos);
+        }
+        if (row && rowCount != 3) shape->ok = false;
+        return expect(']', "expected ',' or ']'");
+    }
+
+    bool parseValue(int depth) {
+        if (depth > kMaxDepth) return fail("nested too deeply");
+        skipSpace();
+        if (m_Pos >= m_Text.size()) return fail("unexpected end of file");
+        switch (m_Text[m_Pos]) {
+        case '{':
+            return parseObject(depth);
+        case '[': {
+            Shape shape;
+            shape.count = 0;
+            shape.rows = 0;
+            shape.flat = 0;
+            shape.ok = true;
+            if (!parseArray(depth, &shape, false)) return false;
+            bool rows = shape.rows == 3 && shape.flat == 0;
+            bool flat = shape.rows == 0 && shape.flat == 9;
+            if (shape.ok && shape.count == 9 && (rows || flat)) {
+                m_Entries.push_back(MatrixEntry());
+                m_Entries.back().key = m_Path;
+                memcpy(m_Entries.back().m, shape.v, sizeof(shape.v));
+            }
+            return true;
+        }
+        case '"': {
+            std::string_view value;
+            return parseString(value);
+        }
+        default: {
+            char c = m_Text[m_Pos];
+            if (c == '-' || (c >= '0' && c <= '9')) {
+                float value;
+                return parseNumber(value);
+            }
+            return parseLiteral();
+        }
+        }
+    }
+
+    std::string_view m_Text;
+    size_t m_Pos;
+    std::string m_Path;
+    std::string m_Error;
+    std::vector<MatrixEntry>& m_Entries;
+    std::vector<MatrixString>& m_Strings;
+};
+
+// Sorted by key; of a repeated key the last one read is kept
+template <typename T>
+static void sortByKey(std::vector<T>& values) {
+    std::stable_sort(values.begin(), values.end(), [](const T& a, const T& b) {
+        return a.key < b.key;
+    });
+    size_t kept = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i + 1 < values.size() && values[i + 1].key == values[i].key) continue;
+        if (kept != i) values[kept] = std::move(values[i]);
+        ++kept;
+    }
+    values.resize(kept);
+}
+
+template <typename T>
+static const T* findKey(const std::vector<T>& values, std::string_view key) {
+    auto it = std::lower_bound(values.begin(), values.end(), key, [](const T& value, std::string_view k) {
+        return std::string_view(value.key) < k;
+    });
+    if (it == values.end() || it->key != key) return nullptr;
+    return &*it;
+}
+
+bool MatrixFile::load(const std::string& filePath, std::string& error) {
+    m_Entries.clear();
+    m_Strings.clear();
+
+    MappedFile file(filePath);
+    if (!file.isOpen()) {
+        error = filePath + ": cannot open file";
+        return false;
+    }
+
+    MatrixParser parser(file.text(), m_Entries, m_Strings);
+    if (!parser.parse()) {
+        error = filePath + ":" + parser.error();
+        m_Entries.clear();
+        m_Strings.clear();
+        return false;
+    }
+
+    sortByKey(m_Entries);
+    sortByKey(m_Strings);
+    return true;
+}
+
+const float* MatrixFile::find(std::string_view key) const {
+    const MatrixEntry* entry = findKey(m_Entries, key);
+    return entry ? entry->m : nullptr;
+}
+
+const std::string* MatrixFile::findString(std::string_view key) const {
+    const MatrixString* entry = findKey(m_Strings, key);
+    return entry ? &entry->value : nullptr;
+}
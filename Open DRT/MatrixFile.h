@@ -0,0 +1,45 @@
+#ifndef MATRIX_FILE_H
+#define MATRIX_FILE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Every 3x3 matrix of a JSON matrix file (ColorMatrices.json, or a studio's camera gamut
+// library), read in one pass. The file is memory-mapped and tokenized in place; a matrix
+// is any array of three rows of three numbers (or of nine numbers), kept under the path of
+// object keys that leads to it, joined by '/'. A trailing "matrix" key is dropped, so
+// ColorMatrices.json gives "input_gamuts/5" and "creative_whitepoints/rec709/d60". Keys
+// are taken as written, escapes included. String members are kept the same way, for the
+// gamut names ("input_gamuts/5/name"). The tables are flat and sorted by path; when a
+// path repeats the last value wins.
+struct MatrixEntry {
+    std::string key;
+    float m[9];             // row-major
+};
+
+struct MatrixString {
+    std::string key;
+    std::string value;      // as written, escapes included
+};
+
+class MatrixFile {
+public:
+    // False, with "path:line:column: message" in error, if the file cannot be read or is
+    // not JSON; the tables are then left empty
+    bool load(const std::string& filePath, std::string& error);
+
+    // Matrix at a path, null if there is none
+    const float* find(std::string_view key) const;
+
+    // String member at a path, null if there is none
+    const std::string* findString(std::string_view key) const;
+
+    const std::vector<MatrixEntry>& entries() const { return m_Entries; }
+
+private:
+    std::vector<MatrixEntry> m_Entries;    // sorted by key
+    std::vector<MatrixString> m_Strings;   // sorted by key
+};
+
+#endif // MATRIX_FILE_H
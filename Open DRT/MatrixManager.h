@@ -2,8 +2,8 @@
 #define MATRIX_MANAGER_H
 
 #include <string>
-#include <map>
-#include <array>
+#include <memory>
+#include "ColorMatrices.h"
 
 // Simple 3x3 matrix structure
 struct Matrix3x3 {
@@ -27,35 +27,35 @@ struct Matrix3x3 {
     }
 };
 
+// The creative white matrices, held in an immutable MatrixSet. The built-in set is
+// ColorMatrices.h, generated from ColorMatrices.json when the plugin is built, so nothing
+// is read from disk when a host loads the plugin. A JSON file in the same layout named by
+// OPENDRT_COLOR_MATRICES replaces the matrices it holds; it is read on the first lookup,
+// which the first render plan makes (buildRenderPlan() takes its creative white from
+// here), so every render of the process sees the same set. The input gamut matrices are
+// OpenDRTPresets.h's: they cover the 16 input gamuts the plugin offers, which the JSON's
+// gamut sections do not. loadMatrices() parses into a new set and publishes it
+// atomically; readers take a reference to the current set, so lookups from concurrent
+// renders need no lock and never see a half-loaded table.
 class MatrixManager {
 public:
-    // Get matrix for input/output gamut conversion
-    static Matrix3x3 getInputMatrix(int gamutIndex);
-    static Matrix3x3 getOutputMatrix(int gamutIndex);
+    // Creative white from P3-D65 for a display gamut as the render plan numbers them
+    // (0 Rec.709, 1 P3-D65, 2 Rec.2020, which uses P3-D65's); cwpIndex 0 is D65
     static Matrix3x3 getCreativeWhitepointMatrix(int displayGamut, int cwpIndex);
     
-    // Load matrices from JSON configuration file
+    // Load matrices from JSON configuration file, over the built-in ones
     static bool loadMatrices(const std::string& configFilePath);
     
-    // Generate Metal kernel source with only needed matrices
-    static std::string generateMatrixConstants(int inputGamut, int outputGamut, int cwp = 0);
-    
-    // Check if matrices are loaded
-    static bool isInitialized();
-    
-    // Get gamut name for debugging
-    static std::string getGamutName(int gamutIndex, bool isOutput = false);
-    
 private:
-    static std::map<int, Matrix3x3> inputMatrices;
-    static std::map<int, Matrix3x3> outputMatrices;
-    static std::map<std::string, Matrix3x3> creativeWhitepointMatrices;
-    static bool initialized;
-    static std::string configPath;
-    
-    // Helper functions
-    static Matrix3x3 parseMatrixFromJson(const std::string& jsonArray);
-    static std::string matrixToMetalString(const Matrix3x3& matrix, const std::string& name);
+    // Row-major 3x3 matrices, as in ColorMatrices.h
+    struct MatrixSet {
+        float creativeWhiteMatrices[kColorMatrixDisplays][kColorMatrixWhites][9];
+    };
+
+    // Current set: the built-in one until an override loads
+    static std::shared_ptr<const MatrixSet> getMatrixSet();
+    static std::shared_ptr<MatrixSet> builtInMatrixSet();
+    static std::shared_ptr<const MatrixSet> matrixSet;
 };
 
 #endif // MATRIX_MANAGER_H
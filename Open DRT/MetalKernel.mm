@@ -613,32 +613,55 @@ const char* kernelSource =  \
 "    }\n" \
 "}\n" \
 "\n" \
+"// Render window and buffer layout, as OpenDRTImageLayout in OpenDRTParams.h\n" \
+"struct OpenDRTImageLayout {\n" \
+"    int windowX1, windowY1, windowX2, windowY2;\n" \
+"    int srcX1, srcY1, srcX2, srcY2, srcStride;\n" \
+"    int dstX1, dstY1, dstStride;\n" \
+"};\n" \
+"\n" \
+"// The grid covers the render window; p_Width and p_Height are the whole frame, which the\n" \
+"// diagnostics ramps and the tonescale overlay are drawn across\n" \
 "kernel void OpenDRTKernel(constant int& p_Width [[buffer(11)]], constant int& p_Height [[buffer(12)]],\n" \
+"                          constant OpenDRTImageLayout& p_Layout [[buffer(13)]],\n" \
 "                          const device float* p_Input [[buffer(0)]], device float* p_Output [[buffer(8)]],\n" \
 "                          constant OpenDRTParams& params [[buffer(9)]],\n" \
 "                          uint2 id [[thread_position_in_grid]])\n" \
 "{\n" \
-"    if ((id.x < p_Width) && (id.y < p_Height))\n" \
+"    const int x = p_Layout.windowX1 + (int)id.x;\n" \
+"    const int y = p_Layout.windowY1 + (int)id.y;\n" \
+"    if ((x < p_Layout.windowX2) && (y < p_Layout.windowY2))\n" \
 "    {\n" \
-"        const int index = ((id.y * p_Width) + id.x) * 4;\n" \
+"        const uint2 pix = uint2(x, y);\n" \
+"        const int index = (y - p_Layout.dstY1) * p_Layout.dstStride + (x - p_Layout.dstX1) * 4;\n" \
+"        \n" \
+"        // Outside the source: black and transparent, as on the CPU\n" \
+"        if (x < p_Layout.srcX1 || x >= p_Layout.srcX2 || y < p_Layout.srcY1 || y >= p_Layout.srcY2) {\n" \
+"            p_Output[index + 0] = 0.0f;\n" \
+"            p_Output[index + 1] = 0.0f;\n" \
+"            p_Output[index + 2] = 0.0f;\n" \
+"            p_Output[index + 3] = 0.0f;\n" \
+"            return;\n" \
+"        }\n" \
+"        const int srcIndex = (y - p_Layout.srcY1) * p_Layout.srcStride + (x - p_Layout.srcX1) * 4;\n" \
 "        \n" \
 "        /***************************************************\n" \
 "         setup and extraction\n" \
 "        --------------------------------------------------*/\n" \
 "        // Extract RGBA values\n" \
-"        float3 rgb = float3(p_Input[index + 0], p_Input[index + 1], p_Input[index + 2]);\n" \
-"        float a = p_Input[index + 3];\n" \
+"        float3 rgb = float3(p_Input[srcIndex + 0], p_Input[srcIndex + 1], p_Input[srcIndex + 2]);\n" \
+"        float a = p_Input[srcIndex + 3];\n" \
 "        \n" \
 "        // If diagnostics mode is enabled and in ramp area, set input to ramp value\n" \
-"        if (params.diagnosticsMode == 1 && id.y < 100) {\n" \
-"            float ramp = (float)id.x / (float)(p_Width - 1);\n" \
+"        if (params.diagnosticsMode == 1 && pix.y < 100) {\n" \
+"            float ramp = (float)pix.x / (float)(p_Width - 1);\n" \
 "            rgb = float3(ramp, ramp, ramp);\n" \
 "        }\n" \
 "        \n" \
 "        // If RGB chips mode is enabled, create RGB test pattern\n" \
 "        if (params.rgbChipsMode == 1) {\n" \
-"            float ramp = (float)id.x / (float)(p_Width - 1);\n" \
-"            int band = id.y * 7 / p_Height;\n" \
+"            float ramp = (float)pix.x / (float)(p_Width - 1);\n" \
+"            int band = pix.y * 7 / p_Height;\n" \
 "            \n" \
 "            switch (band) {\n" \
 "                case 0: rgb = float3(ramp, 0.0f, 0.0f); break;     // Red\n" \
@@ -754,7 +777,7 @@ const char* kernelSource =  \
 "         Tonescale Overlay Initialization\n" \
 "        --------------------------------------------------*/\n" \
 "        float crv_val = 0.0f;\n" \
-"        float2 pos = float2(id.x, id.y);\n" \
+"        float2 pos = float2(pix.x, pix.y);\n" \
 "        float2 res = float2(p_Width, p_Height);\n" \
 "        \n" \
 "        // x-position based input value for tonescale overlay\n" \
@@ -1170,7 +1193,8 @@ const char* kernelSource =  \
 
 std::mutex s_PipelineQueueMutex;
 typedef std::unordered_map<id<MTLCommandQueue>, id<MTLComputePipelineState>> PipelineQueueMap;
-PipelineQueueMap s_PipelineQueueMap;
+// One pipeline per queue and precision: Fast compiles with fast math, Exact without
+PipelineQueueMap s_PipelineQueueMap[2];
 
 // Helper function to populate OpenDRT parameters struct
 OpenDRTParams createOpenDRTParams(
@@ -1409,7 +1433,7 @@ params.hcPresetEnable = p_HcPresetEnable ? 1 : 0;
     return params;
 }
 
-void OpenDRTKernel(void* p_CmdQ, int p_Width, int p_Height,
+void OpenDRTKernel(void* p_CmdQ, int p_Width, int p_Height, const OpenDRTImageLayout& p_Layout,
                    const float* p_Input, float* p_Output,
                    int p_InGamut, int p_InOetf,
                    float p_TnLp, float p_TnGb, float p_PtHdr,
@@ -1442,7 +1466,7 @@ void OpenDRTKernel(void* p_CmdQ, int p_Width, int p_Height,
                    bool p_FilmicMode, float p_FilmicDynamicRange, int p_FilmicProjectorSim,
                    float p_FilmicSourceStops, float p_FilmicTargetStops, float p_FilmicStrength,
                    bool p_AdvHueContrast, bool p_TonescaleMap, bool p_DiagnosticsMode, bool p_RgbChipsMode, bool p_BetaFeaturesEnable,
-                   int p_DisplayGamut, int p_Eotf)
+                   int p_DisplayGamut, int p_Eotf, int p_Precision)
 {
     const char* kernelName = "OpenDRTKernel";
 
@@ -1455,13 +1479,15 @@ void OpenDRTKernel(void* p_CmdQ, int p_Width, int p_Height,
 
     std::unique_lock<std::mutex> lock(s_PipelineQueueMutex);
 
-    auto it = s_PipelineQueueMap.find(queue);
-    if (it == s_PipelineQueueMap.end()) {
+    const bool exact = p_Precision == kPrecisionExact;
+    PipelineQueueMap& pipelines = s_PipelineQueueMap[exact ? 1 : 0];
+    auto it = pipelines.find(queue);
+    if (it == pipelines.end()) {
         MTLCompileOptions* options = [MTLCompileOptions new];
         #if defined(__MAC_OS_X_VERSION_MAX_ALLOWED) && __MAC_OS_X_VERSION_MAX_ALLOWED >= 150000
-            options.mathMode = MTLMathModeFast;
+            options.mathMode = exact ? MTLMathModeSafe : MTLMathModeFast;
         #else
-            options.fastMathEnabled = YES;
+            options.fastMathEnabled = exact ? NO : YES;
         #endif
 
         metalLibrary = [device newLibraryWithSource:@(kernelSource) options:options error:&err];
@@ -1486,7 +1512,7 @@ void OpenDRTKernel(void* p_CmdQ, int p_Width, int p_Height,
             return;
         }
 
-        s_PipelineQueueMap[queue] = pipelineState;
+        pipelines[queue] = pipelineState;
         [metalLibrary release];
         [kernelFunction release];
     } else {
@@ -1543,7 +1569,14 @@ void OpenDRTKernel(void* p_CmdQ, int p_Width, int p_Height,
 
     int exeWidth = [pipelineState threadExecutionWidth];
     MTLSize threadGroupCount = MTLSizeMake(exeWidth, 1, 1);
-    MTLSize threadGroups = MTLSizeMake((p_Width + exeWidth - 1)/exeWidth, p_Height, 1);
+    const int windowWidth = p_Layout.windowX2 - p_Layout.windowX1;
+    const int windowHeight = p_Layout.windowY2 - p_Layout.windowY1;
+    if (windowWidth <= 0 || windowHeight <= 0) {
+        [computeEncoder endEncoding];
+        [paramBuffer release];
+        return;
+    }
+    MTLSize threadGroups = MTLSizeMake((windowWidth + exeWidth - 1)/exeWidth, windowHeight, 1);
     
     // Set buffers - now much cleaner!
     [computeEncoder setBuffer:srcDeviceBuf offset:0 atIndex:0];      // Input buffer
@@ -1552,6 +1585,7 @@ void OpenDRTKernel(void* p_CmdQ, int p_Width, int p_Height,
     [computeEncoder setBytes:&p_Width length:sizeof(int) atIndex:11]; // Width
 
     [computeEncoder setBytes:&p_Height length:sizeof(int) atIndex:12]; // Height
+    [computeEncoder setBytes:&p_Layout length:sizeof(OpenDRTImageLayout) atIndex:13]; // Render window and strides
 
     [computeEncoder dispatchThreadgroups:threadGroups threadsPerThreadgroup:threadGroupCount];
     [computeEncoder endEncoding];
@@ -2,25 +2,24 @@
 #include <cmath>
 #include <algorithm>
 #include <cstring>
+#include <vector>
 #include "OpenDRTParams.h"
 #include "OpenDRTPresets.h"
+#include "OpenDRTRenderPlan.h"
+#include "OpenDRTOverlay.h"
+#include "OpenDRTScopes.h"
 
 // OpenCL constants
 #define SQRT3 1.73205080756887729353f
 #define PI 3.14159265358979323846f
 
-// OpenCL float3 utilities
-typedef struct {
-    float x, y, z;
-} float3;
-
+// OpenCL float3 utilities (float3 itself comes from OpenDRTParams.h)
 typedef struct {
     float x, y;
 } float2;
 
 float3 make_float3(float x, float y, float z) {
-    float3 result = {x, y, z};
-    return result;
+    return float3(x, y, z);
 }
 
 float2 make_float2(float x, float y) {
@@ -49,11 +48,11 @@ float3 float3_div(float3 a, float b) {
 }
 
 // Matrix operations
-float3 vdot(float matrix[9], float3 v) {
-    // Matrix is stored in column-major order
-    return make_float3(matrix[0]*v.x + matrix[3]*v.y + matrix[6]*v.z,
-                      matrix[1]*v.x + matrix[4]*v.y + matrix[7]*v.z,
-                      matrix[2]*v.x + matrix[5]*v.y + matrix[8]*v.z);
+float3 vdot(const float matrix[9], float3 v) {
+    // Matrix is stored in row-major order (same as OpenDRTPresets::ColorMatrix3x3)
+    return make_float3(matrix[0]*v.x + matrix[1]*v.y + matrix[2]*v.z,
+                      matrix[3]*v.x + matrix[4]*v.y + matrix[5]*v.z,
+                      matrix[6]*v.x + matrix[7]*v.y + matrix[8]*v.z);
 }
 
 // Math Helper Functions
@@ -293,121 +292,384 @@ float3 linearize(float3 rgb, int tf) {
     }
 }
 
-// HARDCODED INPUT MATRIX FUNCTIONS
-void getInputMatrix(int gamut, float matrix[9]) {
-    switch(gamut) {
-        case 0: // XYZ (Identity)
-            matrix[0] = 1.0f; matrix[3] = 0.0f; matrix[6] = 0.0f;
-            matrix[1] = 0.0f; matrix[4] = 1.0f; matrix[7] = 0.0f;
-            matrix[2] = 0.0f; matrix[5] = 0.0f; matrix[8] = 1.0f;
-            break;
-        case 1: // AP0 to XYZ
-            matrix[0] = 0.93863094875f; matrix[3] = 0.338093594922f; matrix[6] = 0.000723121511f;
-            matrix[1] = -0.00574192055f; matrix[4] = 0.727213902811f; matrix[7] = 0.000818441849f;
-            matrix[2] = 0.017566898852f; matrix[5] = -0.065307497733f; matrix[8] = 1.0875161874f;
-            break;
-        case 2: // AP1 to XYZ
-            matrix[0] = 0.652418717672f; matrix[3] = 0.268064059194f; matrix[6] = -0.00546992851f;
-            matrix[1] = 0.127179925538f; matrix[4] = 0.672464478993f; matrix[7] = 0.005182799977f;
-            matrix[2] = 0.170857283842f; matrix[5] = 0.059471461813f; matrix[8] = 1.08934487929f;
-            break;
-        case 3: // P3-D65 to XYZ
-            matrix[0] = 0.486571133137f; matrix[3] = 0.228974640369f; matrix[6] = 0.0f;
-            matrix[1] = 0.265667706728f; matrix[4] = 0.691738605499f; matrix[7] = 0.045113388449f;
-            matrix[2] = 0.198217317462f; matrix[5] = 0.079286918044f; matrix[8] = 1.043944478035f;
-            break;
-        case 4: // Rec.2020 to XYZ
-            matrix[0] = 0.636958122253f; matrix[3] = 0.262700229883f; matrix[6] = 0.0f;
-            matrix[1] = 0.144616916776f; matrix[4] = 0.677998125553f; matrix[7] = 0.028072696179f;
-            matrix[2] = 0.168880969286f; matrix[5] = 0.059301715344f; matrix[8] = 1.060985088348f;
-            break;
-        case 5: // Rec.709 to XYZ
-            matrix[0] = 0.412390917540f; matrix[3] = 0.212639078498f; matrix[6] = 0.019330825657f;
-            matrix[1] = 0.357584357262f; matrix[4] = 0.715168714523f; matrix[7] = 0.119194783270f;
-            matrix[2] = 0.180480793118f; matrix[5] = 0.072192311287f; matrix[8] = 0.950532138348f;
-            break;
-        // ... add other cases as needed
-        default:
-            matrix[0] = 1.0f; matrix[3] = 0.0f; matrix[6] = 0.0f;
-            matrix[1] = 0.0f; matrix[4] = 1.0f; matrix[7] = 0.0f;
-            matrix[2] = 0.0f; matrix[5] = 0.0f; matrix[8] = 1.0f;
-            break;
+// Per-pixel OpenDRT transform (equivalent to the body of the Metal/CUDA kernel, less the
+// diagnostics ramps, RGB chips and tonescale overlay, which the CPU runs as separate passes:
+// see OpenDRTOverlay.h). p_In/p_Out point at a single RGBA pixel; p_Scopes, if set, gets
+// the pixel's gamut counts.
+// M is the module mask the instantiation is specialized for (see OpenDRTRenderPlan.h).
+template <unsigned M>
+static void OpenDRTPixel(const float* p_In, float* p_Out, const OpenDRTRenderPlan& plan, OpenDRTScopes* p_Scopes)
+{
+    const OpenDRTParams& params = plan.params;
+
+    /***************************************************
+     setup and extraction
+    --------------------------------------------------*/
+    // Extract RGBA values
+    float3 rgb = make_float3(p_In[0], p_In[1], p_In[2]);
+    float a = p_In[3];
+    
+    rgb = linearize(rgb, params.inOetf);
+    
+    // Input gamut -> XYZ -> P3-D65, fused in the render plan
+    rgb = vdot(plan.inputMatrix, rgb);
+    
+    // Rendering Space: "Desaturate" to control scale of the color volume in the rgb ratios.
+    float3 rs_w = make_float3(plan.rsW[0], plan.rsW[1], plan.rsW[2]);
+    float sat_L = rgb.x*rs_w.x + rgb.y*rs_w.y + rgb.z*rs_w.z;
+    rgb = float3_add(float3_mul(make_float3(sat_L, sat_L, sat_L), params.rsSa), float3_mul(rgb, (1.0f - params.rsSa)));
+    
+    // Offset
+    rgb = float3_add(rgb, make_float3(params.tnOff, params.tnOff, params.tnOff));
+    
+    /***************************************************
+      Contrast Low Module
+    --------------------------------------------------*/
+    if (OPENDRT_MODULE_ON(M, plan, kModuleLcon)) {
+        const float mcon_m = plan.mconM;
+        const float mcon_w = plan.mconW;
+
+        // Normalize for ts_x0 intersection constraint
+        const float mcon_cnst_sc = plan.mconCnstSc;
+        rgb = float3_mul(rgb, mcon_cnst_sc);
+
+        // Scale for ratio-preserving midtone contrast
+        float mcon_nm = hypotf3(clampminf3(rgb, 0.0f))/SQRT3;
+        float mcon_sc = (mcon_nm*mcon_nm + mcon_m*mcon_w)/(mcon_nm*mcon_nm + mcon_w);
+
+        if (params.tnLconPc > 0.0f) {
+            // Mix between ratio-preserving and per-channel by blending based on distance from achromatic
+            // Apply per-channel midtone contrast
+            float3 mcon_rgb = rgb;
+            mcon_rgb.x = compress_toe_cubic(rgb.x, mcon_m, mcon_w, 0);
+            mcon_rgb.y = compress_toe_cubic(rgb.y, mcon_m, mcon_w, 0);
+            mcon_rgb.z = compress_toe_cubic(rgb.z, mcon_m, mcon_w, 0);
+
+            // Always use some amount of ratio-preserving method towards gamut boundary
+            float mcon_mx = fmaxf3(rgb);
+            float mcon_mn = fminf3(rgb);
+            float mcon_ch = clampf(1.0f - sdivf(mcon_mn, mcon_mx), 0.0, 1.0);
+            mcon_ch = powf(mcon_ch, 4.0f*params.tnLconPc);
+            rgb = float3_add(float3_mul(float3_mul(rgb, mcon_sc), mcon_ch), float3_mul(mcon_rgb, (1.0f - mcon_ch)));
+        }
+        else { // Just use ratio-preserving
+            rgb = float3_mul(rgb, mcon_sc);
+        }
+
+    }
+
+    /***************************************************
+      Filmic Dynamic Range Compression (BETA FEATURE)
+    --------------------------------------------------*/
+    if (OPENDRT_MODULE_ON(M, plan, kModuleFilmic)) {
+        // Normalize RGB to 0-1 range based on original camera stops
+        float3 normalizedRGB = float3_mul(rgb, plan.filmicInvMaxIn);
+        
+        // Use Film Dynamic Range to control highlight rolloff characteristics
+        float rolloff_s = plan.filmicS;
+        float rolloff_p = plan.filmicP;
+        
+        // Apply hyperbolic compression with dynamic rolloff
+        float3 compressedRGB = make_float3(
+            compress_hyperbolic_power(normalizedRGB.x, rolloff_s, rolloff_p),
+            compress_hyperbolic_power(normalizedRGB.y, rolloff_s, rolloff_p),
+            compress_hyperbolic_power(normalizedRGB.z, rolloff_s, rolloff_p)
+        );
+        
+        // Rescale to target film range
+        float maxOutput = plan.filmicMaxOut;
+        float3 rescaledRGB = float3_mul(compressedRGB, maxOutput);
+        
+        // Mix between original and filmic compressed result
+        rgb = float3_add(float3_mul(rgb, (1.0f - params.filmicStrength)), float3_mul(rescaledRGB, params.filmicStrength));
+    }
+
+    /***************************************************
+     Tonescale and RGB Ratios
+    --------------------------------------------------*/
+    // Tonescale Norm
+    float tsn = hypotf3(clampminf3(rgb, 0.0f)) / SQRT3;
+    // Purity Compression Norm
+    float ts_pt = sqrtf(fmaxf(0.0f, rgb.x * rgb.x * params.ptR + rgb.y * rgb.y * params.ptG + rgb.z * rgb.z * params.ptB));
+    
+    // RGB Ratios
+    rgb = sdivf3f(clampminf3(rgb, -2.0f), tsn);
+    
+    /***************************************************
+      Apply High Contrast
+    --------------------------------------------------*/
+    if (OPENDRT_MODULE_ON(M, plan, kModuleHcon)) {
+        float hcon_p = plan.hconP;
+        tsn = contrast_high(tsn, hcon_p, params.tnHconPv, params.tnHconSt, 0);
+        ts_pt = contrast_high(ts_pt, hcon_p, params.tnHconPv, params.tnHconSt, 0);
+    }
+
+    /***************************************************
+      Apply Tonescale
+    --------------------------------------------------*/
+    tsn = compress_hyperbolic_power(tsn, params.ts_s, params.tnCon);
+    ts_pt = compress_hyperbolic_power(ts_pt, params.ts_s1, params.tnCon);
+    
+    /***************************************************
+      Prerequisite color spaces
+    --------------------------------------------------*/
+    // Simple Cyan-Yellow / Green-Magenta opponent space
+    float opp_cy = rgb.x - rgb.z;
+    float opp_gm = rgb.y - (rgb.x + rgb.z)/2.0f;
+    float ach_d = sqrtf(fmaxf(0.0f, opp_cy*opp_cy + opp_gm*opp_gm))/SQRT3;
+
+    // Smooth ach_d, normalized so 1.0 doesn't change
+    ach_d = (1.25f)*compress_toe_quadratic(ach_d, 0.25f, 0);
+
+    // Hue angle, rotated so that red = 0.0
+    float hue = fmodf(atan2f(opp_cy, opp_gm) + PI + 1.10714931f, 2.0f*PI);
+
+    // RGB Hue Angles
+    float3 ha_rgb = make_float3(
+      gauss_window(hue_offset(hue, 0.1f), 0.9f),
+      gauss_window(hue_offset(hue, 4.3f), 0.9f),
+      gauss_window(hue_offset(hue, 2.3f), 0.9f));
+
+    // CMY Hue Angles
+    float3 ha_cmy = make_float3(
+      gauss_window(hue_offset(hue, 3.3f), 0.6f),
+      gauss_window(hue_offset(hue, 1.3f), 0.6f),
+      gauss_window(hue_offset(hue, -1.2f), 0.6f));
+
+    // Purity Compression Range
+    float ts_pt_cmp = 1.0f - powf(ts_pt, 1.0f/params.ptRngLow);
+
+    float pt_rng_high_f = fminf(1.0f, ach_d/1.2f);
+    pt_rng_high_f *= pt_rng_high_f;
+    pt_rng_high_f = params.ptRngHigh < 1.0f ? 1.0f - pt_rng_high_f : pt_rng_high_f;
+    ts_pt_cmp = powf(ts_pt_cmp, params.ptRngHigh)*(1.0f - pt_rng_high_f) + ts_pt_cmp*pt_rng_high_f;
+
+    /***************************************************
+      Brilliance
+    --------------------------------------------------*/
+    float brl_f = 1.0f;
+    if (OPENDRT_MODULE_ON(M, plan, kModuleBrl)) {
+        brl_f = -params.brlR*ha_rgb.x - params.brlG*ha_rgb.y - params.brlB*ha_rgb.z - params.brlC*ha_cmy.x - params.brlM*ha_cmy.y - params.brlY*ha_cmy.z;
+        brl_f = (1.0f - ach_d)*brl_f + 1.0f - brl_f;
+        brl_f = softplus(brl_f, 0.25f, -100.0f, 0.0f);
+        
+        // Limit Brilliance adjustment by tonescale
+        float brl_ts = brl_f > 1.0f ? 1.0f - ts_pt : ts_pt;
+        float brl_lim = spowf(brl_ts, 1.0f - params.brlRng);
+        brl_f = brl_f*brl_lim + 1.0f - brl_lim;
+        brl_f = fmaxf(0.0f, fminf(2.0f, brl_f));
+    }
+
+    /***************************************************
+      Mid-Range Purity
+    --------------------------------------------------*/
+    float ptm_sc = 1.0f;
+    if (OPENDRT_MODULE_ON(M, plan, kModulePtm)) {
+        // Mid Purity Low
+        float ptm_ach_d = complement_power(ach_d, params.ptmLowSt);
+        ptm_sc = sigmoid_cubic(ptm_ach_d, params.ptmLow*(1.0f - ts_pt));
+        
+        // Mid Purity High
+        ptm_ach_d = complement_power(ach_d, params.ptmHighSt)*(1.0f - ts_pt) + ach_d*ach_d*ts_pt;
+        ptm_sc *= sigmoid_cubic(ptm_ach_d, params.ptmHigh*ts_pt);
+        ptm_sc = fmaxf(0.0f, ptm_sc);
+    }
+    
+    /***************************************************
+      Hue Angle Premultiplication
+    --------------------------------------------------*/
+    ha_rgb = float3_mul(ha_rgb, ach_d);
+    ha_cmy = float3_mul(ha_cmy, (1.5f)*compress_toe_quadratic(ach_d, 0.5f, 0));
+    
+    /***************************************************
+      Hue Contrast R
+    --------------------------------------------------*/
+    if (OPENDRT_MODULE_ON(M, plan, kModuleHc)) {
+        float hc_ts = 1.0f - ts_pt;
+        float hc_c = (1.0f - ach_d)*hc_ts + ach_d*(1.0f - hc_ts);
+        hc_c *= ha_rgb.x;
+        hc_ts *= hc_ts;
+        float hc_f = params.hcR*(hc_c - 2.0f*hc_c*hc_ts) + 1.0f;
+        rgb = make_float3(rgb.x, rgb.y*hc_f, rgb.z*hc_f);
+    }
+
+    /***************************************************
+      Hue Shift
+    --------------------------------------------------*/
+    // Hue Shift RGB
+    if (OPENDRT_MODULE_ON(M, plan, kModuleHsRgb)) {
+        float3 hs_rgb = float3_mul(ha_rgb, powf(ts_pt, 1.0f/params.hsRgbRng));
+        float3 hsf = make_float3(hs_rgb.x*params.hsR, hs_rgb.y*-params.hsG, hs_rgb.z*-params.hsB);
+        hsf = make_float3(hsf.z - hsf.y, hsf.x - hsf.z, hsf.y - hsf.x);
+        rgb = float3_add(rgb, hsf);
+    }
+
+    // Hue Shift CMY
+    if (OPENDRT_MODULE_ON(M, plan, kModuleHsCmy)) {
+        float3 hs_cmy = float3_mul(ha_cmy, (1.0f - ts_pt));
+        float3 hsf = make_float3(hs_cmy.x*-params.hsC, hs_cmy.y*params.hsM, hs_cmy.z*params.hsY);
+        hsf = make_float3(hsf.z - hsf.y, hsf.x - hsf.z, hsf.y - hsf.x);
+        rgb = float3_add(rgb, hsf);
     }
+
+    /***************************************************
+      Module Application
+    --------------------------------------------------*/
+    // Apply brilliance
+    rgb = float3_mul(rgb, brl_f);
+    
+    // Apply purity compression and mid purity
+    ts_pt_cmp *= ptm_sc;
+    rgb = float3_add(float3_mul(rgb, ts_pt_cmp), make_float3(1.0f - ts_pt_cmp, 1.0f - ts_pt_cmp, 1.0f - ts_pt_cmp));
+
+    // Inverse Rendering Space
+    sat_L = rgb.x*rs_w.x + rgb.y*rs_w.y + rgb.z*rs_w.z;
+    rgb = float3_div(float3_sub(float3_mul(make_float3(sat_L, sat_L, sat_L), params.rsSa), rgb), (params.rsSa - 1.0f));
+
+    /***************************************************
+      Creative White Point and Output Transform
+    --------------------------------------------------*/
+    float3 cwp_rgb = rgb;
+
+    // Apply creative whitepoint transform and convert to the display gamut
+    // (the plan resolves D65 on Rec.709 to the plain P3 -> Rec.709 matrix)
+    cwp_rgb = vdot(plan.cwpMatrix, rgb);
+    rgb = vdot(plan.displayMatrix, rgb);
+
+    // Mix between Creative Whitepoint and base by tsn
+    float cwp_f = powf(tsn, 1.0f - params.cwpRng);
+    rgb = float3_add(float3_mul(cwp_rgb, cwp_f), float3_mul(rgb, (1.0f - cwp_f)));
+
+    /***************************************************
+      Purity Compress Low
+    --------------------------------------------------*/
+    if (OPENDRT_MODULE_ON(M, plan, kModulePtl)) {
+        float sum0 = softplus(rgb.x, 0.2f, -100.0f, -0.3f) + rgb.y + softplus(rgb.z, 0.2f, -100.0f, -0.3f);
+        rgb.x = softplus(rgb.x, 0.04f, -0.3f, 0.0f);
+        rgb.y = softplus(rgb.y, 0.06f, -0.3f, 0.0f);
+        rgb.z = softplus(rgb.z, 0.01f, -0.05f, 0.0f);
+
+        float ptl_norm = fminf(1.0f, sdivf(sum0, rgb.x + rgb.y + rgb.z));
+        rgb = float3_mul(rgb, ptl_norm);
+    }
+
+    /***************************************************
+      Final Tonescale and Display Transform
+    --------------------------------------------------*/
+    // Final tonescale adjustments
+    tsn *= params.ts_m2;
+    tsn = compress_toe_quadratic(tsn, params.tnToe, 0);
+    tsn *= params.ts_dsc;
+    
+    // Return from RGB ratios to final values
+    rgb = float3_mul(rgb, tsn);
+    if (p_Scopes) countGamut(*p_Scopes, rgb.x, rgb.y, rgb.z);
+    
+    // Clamp if enabled
+    if (params.clamp != 0) {
+        rgb = clampf3(rgb, 0.0f, 1.0f);
+    }
+    
+    // Rec.2020 conversion
+    if (plan.rec2020) {
+        rgb = clampminf3(rgb, 0.0f);
+        rgb = vdot(plan.rec2020Matrix, rgb);
+    }
+    
+    // ENCODE FOR DISPLAY
+    rgb = encode_for_display(rgb, params.eotf);
+    
+    // Output to buffer
+    p_Out[0] = rgb.x;
+    p_Out[1] = rgb.y;
+    p_Out[2] = rgb.z;
+    p_Out[3] = a;
 }
 
-void getOutputMatrix(int displayGamut, float matrix[9]) {
-    switch(displayGamut) {
-        case 0: // P3 to Rec.709
-            matrix[0] = 1.224940181f; matrix[3] = -0.04205697775f; matrix[6] = -0.01963755488f;
-            matrix[1] = -0.2249402404f; matrix[4] = 1.042057037f; matrix[7] = -0.07863604277f;
-            matrix[2] = 0.0f; matrix[5] = -1.4901e-08f; matrix[8] = 1.098273635f;
-            break;
-        case 1: // P3 Identity
-            matrix[0] = 1.0f; matrix[3] = 0.0f; matrix[6] = 0.0f;
-            matrix[1] = 0.0f; matrix[4] = 1.0f; matrix[7] = 0.0f;
-            matrix[2] = 0.0f; matrix[5] = 0.0f; matrix[8] = 1.0f;
-            break;
-        case 2: // P3 to Rec.2020
-            matrix[0] = 0.7538330344f; matrix[3] = 0.04574384897f; matrix[6] = -0.001210340355f;
-            matrix[1] = 0.1985973691f; matrix[4] = 0.9417772198f; matrix[7] = 0.0176017173f;
-            matrix[2] = 0.04756959659f; matrix[5] = 0.01247893122f; matrix[8] = 0.9836086231f;
-            break;
-        default:
-            matrix[0] = 1.0f; matrix[3] = 0.0f; matrix[6] = 0.0f;
-            matrix[1] = 0.0f; matrix[4] = 1.0f; matrix[7] = 0.0f;
-            matrix[2] = 0.0f; matrix[5] = 0.0f; matrix[8] = 1.0f;
-            break;
+template <unsigned M>
+static void OpenDRTRow(int p_X1, int p_X2, const float* p_Input, float* p_Output, const OpenDRTRenderPlan& p_Plan,
+                       OpenDRTScopes* p_Scopes)
+{
+    for (int x = p_X1; x < p_X2; ++x) {
+        OpenDRTPixel<M>(p_Input, p_Output, p_Plan, p_Scopes);
+        p_Input += 4;
+        p_Output += 4;
     }
 }
 
-void getCreativeWhitepointMatrix(int displayGamut, int cwp, float matrix[9]) {
-    if (displayGamut == 0) { // Rec.709
-        switch(cwp) {
-            case 1: // D60
-                matrix[0] = 1.189986856f; matrix[3] = -0.04168263635f; matrix[6] = -0.01937995127f;
-                matrix[1] = -0.192168414f; matrix[4] = 0.9927757018f; matrix[7] = -0.07933006919f;
-                matrix[2] = 0.002185496045f; matrix[5] = -5.5660878e-05f; matrix[8] = 0.9734397041f;
-                break;
-            case 2: // D55
-                matrix[0] = 1.149327514f; matrix[3] = -0.0412590771f; matrix[6] = -0.01900949528f;
-                matrix[1] = -0.1536910745f; matrix[4] = 0.9351717477f; matrix[7] = -0.07928282823f;
-                matrix[2] = 0.004366526746f; matrix[5] = -0.000116126221f; matrix[8] = 0.8437884317f;
-                break;
-            case 3: // D50
-                matrix[0] = 1.103807322f; matrix[3] = -0.04079386701f; matrix[6] = -0.01854055914f;
-                matrix[1] = -0.1103425121f; matrix[4] = 0.8704694227f; matrix[7] = -0.07857582481f;
-                matrix[2] = 0.006531676079f; matrix[5] = -0.000180522628f; matrix[8] = 0.7105498861f;
-                break;
-            default: // D65 (Identity)
-                matrix[0] = 1.0f; matrix[3] = 0.0f; matrix[6] = 0.0f;
-                matrix[1] = 0.0f; matrix[4] = 1.0f; matrix[7] = 0.0f;
-                matrix[2] = 0.0f; matrix[5] = 0.0f; matrix[8] = 1.0f;
-                break;
-        }
-    } else { // P3 and Rec.2020
-        switch(cwp) {
-            case 1: // D60
-                matrix[0] = 0.979832881f; matrix[3] = -0.000805359793f; matrix[6] = -0.000338382322f;
-                matrix[1] = 0.01836378979f; matrix[4] = 0.9618000331f; matrix[7] = -0.003671835795f;
-                matrix[2] = 0.001803284786f; matrix[5] = 1.8876121e-05f; matrix[8] = 0.894139105f;
-                break;
-            case 2: // D55
-                matrix[0] = 0.9559790976f; matrix[3] = -0.001771929896f; matrix[6] = -0.000674760809f;
-                matrix[1] = 0.0403850003f; matrix[4] = 0.9163058305f; matrix[7] = -0.0072466358f;
-                matrix[2] = 0.003639287409f; matrix[5] = 3.3300759e-05f; matrix[8] = 0.7831189153f;
-                break;
-            case 3: // D50
-                matrix[0] = 0.9287127388f; matrix[3] = -0.002887159176f; matrix[6] = -0.001009551548f;
-                matrix[1] = 0.06578032793f; matrix[4] = 0.8640709228f; matrix[7] = -0.01073503317f;
-                matrix[2] = 0.005506708345f; matrix[5] = 4.3593718e-05f; matrix[8] = 0.6672692039f;
-                break;
-            default: // D65 (Identity)
-                matrix[0] = 1.0f; matrix[3] = 0.0f; matrix[6] = 0.0f;
-                matrix[1] = 0.0f; matrix[4] = 1.0f; matrix[7] = 0.0f;
-                matrix[2] = 0.0f; matrix[5] = 0.0f; matrix[8] = 1.0f;
-                break;
-        }
+// CPU fallback entry point, called per row by ImageProcessor::multiThreadProcessImages.
+// Processes the packed RGBA span [p_X1, p_X2) of a row; coordinates are frame-relative.
+// The frame patterns are the caller's passes (OpenDRTOverlay.h), not drawn here; so are
+// the output scopes, but for the gamut counts, which are taken before the clamp.
+void RunCPUKernelRow(int p_X1, int p_X2, const float* p_Input, float* p_Output, const OpenDRTRenderPlan& p_Plan,
+                     OpenDRTScopes* p_Scopes)
+{
+#define OPENDRT_ROW(MASK) \
+    case (MASK): OpenDRTRow<(MASK)>(p_X1, p_X2, p_Input, p_Output, p_Plan, p_Scopes); break;
+
+    switch (p_Plan.kernelModules) {
+        OPENDRT_SPECIALIZED_MODULES(OPENDRT_ROW)
+        default: OpenDRTRow<kModulesDynamic>(p_X1, p_X2, p_Input, p_Output, p_Plan, p_Scopes); break;
     }
+#undef OPENDRT_ROW
+}
+
+// Tonescale overlay curve at frame column p_X: the column, read as a T-Log code value,
+// tracked through the tonescale the way OpenDRTPixel() tracks a pixel's norm, then
+// display encoded. p_Out is R, G, B; OpenDRTOverlay builds a frame's curve from it.
+void OpenDRTOverlayColumn(int p_X, int p_Width, const OpenDRTRenderPlan& plan, float p_Out[3])
+{
+    const OpenDRTParams& params = plan.params;
+
+    // x-position based input value
+    float crv_val = oetf_filmlight_tlog((float)p_X/(float)p_Width);
+    crv_val += params.tnOff;
+
+    // Contrast low
+    if (plan.modules & kModuleLcon) {
+        crv_val *= plan.mconCnstSc;
+        crv_val = crv_val*(crv_val*crv_val + plan.mconM*plan.mconW)/(crv_val*crv_val + plan.mconW);
+    }
+
+    // Filmic dynamic range compression
+    if (plan.modules & kModuleFilmic) {
+        float crv_normalized = crv_val * plan.filmicInvMaxIn;
+        float crv_compressed = compress_hyperbolic_power(crv_normalized, plan.filmicS, plan.filmicP);
+        float crv_rescaled = crv_compressed * plan.filmicMaxOut;
+        crv_val = crv_val * (1.0f - params.filmicStrength) + crv_rescaled * params.filmicStrength;
+    }
+
+    // Contrast high and tonescale
+    if (plan.modules & kModuleHcon) crv_val = contrast_high(crv_val, plan.hconP, params.tnHconPv, params.tnHconSt, 0);
+    crv_val = compress_hyperbolic_power(crv_val, params.ts_s, params.tnCon);
+
+    // Creative whitepoint and display gamut
+    float3 crv_rgb = make_float3(crv_val, crv_val, crv_val);
+    float3 crv_rgb_cwp = vdot(plan.cwpMatrix, crv_rgb);
+    crv_rgb = vdot(plan.displayMatrix, crv_rgb);
+    float crv_rgb_cwp_f = powf(crv_val, 1.0f - params.cwpRng);
+    crv_rgb = float3_add(float3_mul(crv_rgb_cwp, crv_rgb_cwp_f), float3_mul(crv_rgb, (1.0f - crv_rgb_cwp_f)));
+
+    // Final tonescale adjustments
+    crv_rgb = float3_mul(crv_rgb, params.ts_m2);
+    crv_rgb.x = compress_toe_quadratic(crv_rgb.x, params.tnToe, 0);
+    crv_rgb.y = compress_toe_quadratic(crv_rgb.y, params.tnToe, 0);
+    crv_rgb.z = compress_toe_quadratic(crv_rgb.z, params.tnToe, 0);
+    crv_rgb = float3_mul(crv_rgb, params.ts_dsc);
+    // scale to 1.0 = 1000 nits for st2084 PQ
+    if (params.eotf == 4) crv_rgb = float3_mul(crv_rgb, 10.0f);
+
+    // Display encoding
+    if ((params.eotf > 0) && (params.eotf < 4)) {
+        float eotf_p = 2.0f + params.eotf * 0.2f;
+        crv_rgb = spowf3(crv_rgb, 1.0f/eotf_p);
+    }
+    else if (params.eotf == 4) crv_rgb = eotf_pq(crv_rgb, 1);
+    else if (params.eotf == 5) crv_rgb = eotf_hlg(crv_rgb, 1);
+
+    p_Out[0] = crv_rgb.x;
+    p_Out[1] = crv_rgb.y;
+    p_Out[2] = crv_rgb.z;
 }
 
 // Main kernel function (equivalent to Metal/CUDA kernel)
@@ -415,441 +677,22 @@ void OpenDRTKernel_OpenCL(int p_Width, int p_Height,
                           const float* p_Input, float* p_Output,
                           OpenDRTParams params)
 {
-    // Process each pixel
+    OpenDRTRenderPlan plan;
+    buildRenderPlan(params, plan);
+    OpenDRTOverlay overlay;
+    overlay.build(plan, p_Width, p_Height);
+    std::vector<float> pattern(p_Width * 4);
+
+    // Process each row, with the test patterns as input and the overlay drawn over it
     for (int y = 0; y < p_Height; y++) {
-        for (int x = 0; x < p_Width; x++) {
-            const int index = ((y * p_Width) + x) * 4;
-            
-            /***************************************************
-             setup and extraction
-            --------------------------------------------------*/
-            // Extract RGBA values
-            float3 rgb = make_float3(p_Input[index + 0], p_Input[index + 1], p_Input[index + 2]);
-            float a = p_Input[index + 3];
-            
-            // If diagnostics mode is enabled and in ramp area, set input to ramp value
-            if (params.diagnosticsMode == 1 && y < 100) {
-                float ramp = (float)x / (float)(p_Width - 1);
-                rgb = make_float3(ramp, ramp, ramp);
-            }
-            
-            // If RGB chips mode is enabled, create RGB test pattern
-            if (params.rgbChipsMode == 1) {
-                float ramp = (float)x / (float)(p_Width - 1);
-                int band = y * 7 / p_Height;
-                
-                switch (band) {
-                    case 0: rgb = make_float3(ramp, 0.0f, 0.0f); break;     // Red
-                    case 1: rgb = make_float3(ramp, ramp, 0.0f); break;     // Yellow
-                    case 2: rgb = make_float3(0.0f, ramp, 0.0f); break;     // Green
-                    case 3: rgb = make_float3(0.0f, ramp, ramp); break;     // Cyan
-                    case 4: rgb = make_float3(0.0f, 0.0f, ramp); break;     // Blue
-                    case 5: rgb = make_float3(ramp, 0.0f, ramp); break;     // Magenta
-                    case 6: rgb = make_float3(ramp, ramp, ramp); break;    // White/Gray
-                    default: rgb = make_float3(ramp, ramp, ramp); break;    // White/Gray
-                }
-            }
-            
-            rgb = linearize(rgb, params.inOetf);
-            
-            // Load dynamic matrices using switch functions
-            float inputMatrix[9];
-            float outputMatrix[9];
-            float cwpMatrix[9];
-            getInputMatrix(params.inGamut, inputMatrix);
-            getOutputMatrix(params.displayGamut, outputMatrix);
-            getCreativeWhitepointMatrix(params.displayGamut, params.cwp, cwpMatrix);
-            
-            // Apply input matrix transform
-            rgb = vdot(inputMatrix, rgb);
-            
-            // XYZ to P3 transform (hardcoded)
-            float hardcodedxyzToP3Matrix[9] = {
-                 2.49349691194f, -0.931383617919f, -0.402710784451f,
-                -0.829488694668f, 1.76266097069f, 0.0236246771724f,
-                 0.0358458302915f, -0.0761723891287f, 0.956884503364f
-            };
-            rgb = vdot(hardcodedxyzToP3Matrix, rgb);
-            
-            /***************************************************
-             Tonescale Overlay Initialization
-            --------------------------------------------------*/
-            float crv_val = 0.0f;
-            float2 pos = make_float2(x, y);
-            float2 res = make_float2(p_Width, p_Height);
-            
-            // x-position based input value for tonescale overlay
-            if (params.tonescaleMap == 1) {
-                crv_val = oetf_filmlight_tlog(pos.x/res.x);
-            }
-            
-            // Rendering Space: "Desaturate" to control scale of the color volume in the rgb ratios.
-            float3 rs_w = make_float3(params.rsRw, 1.0f - params.rsRw - params.rsBw, params.rsBw);
-            float sat_L = rgb.x*rs_w.x + rgb.y*rs_w.y + rgb.z*rs_w.z;
-            rgb = float3_add(float3_mul(make_float3(sat_L, sat_L, sat_L), params.rsSa), float3_mul(rgb, (1.0f - params.rsSa)));
-            
-            // Offset
-            rgb = float3_add(rgb, make_float3(params.tnOff, params.tnOff, params.tnOff));
-            if (params.tonescaleMap == 1) crv_val += params.tnOff;
-            
-            /***************************************************
-              Contrast Low Module
-            --------------------------------------------------*/
-            if (params.tnLconPresetEnable || params.tnLconUIEnable) {
-                float mcon_m = powf(2.0f, -params.tnLcon);
-                float mcon_w = params.tnLconW/4.0f;
-                mcon_w *= mcon_w;
-
-                // Normalize for ts_x0 intersection constraint
-                const float mcon_cnst_sc = compress_toe_cubic(params.ts_x0, mcon_m, mcon_w, 1)/params.ts_x0;
-                rgb = float3_mul(rgb, mcon_cnst_sc);
-
-                // Scale for ratio-preserving midtone contrast
-                float mcon_nm = hypotf3(clampminf3(rgb, 0.0f))/SQRT3;
-                float mcon_sc = (mcon_nm*mcon_nm + mcon_m*mcon_w)/(mcon_nm*mcon_nm + mcon_w);
-
-                if (params.tnLconPc > 0.0f) {
-                    // Mix between ratio-preserving and per-channel by blending based on distance from achromatic
-                    // Apply per-channel midtone contrast
-                    float3 mcon_rgb = rgb;
-                    mcon_rgb.x = compress_toe_cubic(rgb.x, mcon_m, mcon_w, 0);
-                    mcon_rgb.y = compress_toe_cubic(rgb.y, mcon_m, mcon_w, 0);
-                    mcon_rgb.z = compress_toe_cubic(rgb.z, mcon_m, mcon_w, 0);
-
-                    // Always use some amount of ratio-preserving method towards gamut boundary
-                    float mcon_mx = fmaxf3(rgb);
-                    float mcon_mn = fminf3(rgb);
-                    float mcon_ch = clampf(1.0f - sdivf(mcon_mn, mcon_mx), 0.0, 1.0);
-                    mcon_ch = powf(mcon_ch, 4.0f*params.tnLconPc);
-                    rgb = float3_add(float3_mul(float3_mul(rgb, mcon_sc), mcon_ch), float3_mul(mcon_rgb, (1.0f - mcon_ch)));
-                }
-                else { // Just use ratio-preserving
-                    rgb = float3_mul(rgb, mcon_sc);
-                }
-                
-                // Overlay tracking for low contrast
-                if (params.tonescaleMap == 1) {
-                    crv_val *= mcon_cnst_sc;
-                    crv_val = crv_val*(crv_val*crv_val + mcon_m*mcon_w)/(crv_val*crv_val + mcon_w);
-                }
-            }
-
-            /***************************************************
-              Filmic Dynamic Range Compression (BETA FEATURE)
-            --------------------------------------------------*/
-            if (params.filmicMode == 1 && params.betaFeaturesEnable == 1) {
-                // Calculate maximum input based on original camera range
-                float maxInput = powf(2.0f, params.filmicSourceStops);
-                
-                // Normalize RGB to 0-1 range based on original camera stops
-                float3 normalizedRGB = float3_div(rgb, maxInput);
-                
-                // Use Film Dynamic Range to control highlight rolloff characteristics
-                float rolloff_s = 0.05f + (params.filmicDynamicRange / 10.0f);
-                float rolloff_p = 0.8f + (params.filmicDynamicRange / 25.0f);
-                
-                // Apply hyperbolic compression with dynamic rolloff
-                float3 compressedRGB = make_float3(
-                    compress_hyperbolic_power(normalizedRGB.x, rolloff_s, rolloff_p),
-                    compress_hyperbolic_power(normalizedRGB.y, rolloff_s, rolloff_p),
-                    compress_hyperbolic_power(normalizedRGB.z, rolloff_s, rolloff_p)
-                );
-                
-                // Rescale to target film range
-                float maxOutput = powf(2.0f, params.filmicTargetStops);
-                float3 rescaledRGB = float3_mul(compressedRGB, maxOutput);
-                
-                // Mix between original and filmic compressed result
-                rgb = float3_add(float3_mul(rgb, (1.0f - params.filmicStrength)), float3_mul(rescaledRGB, params.filmicStrength));
-                
-                // Apply same compression to overlay curve
-                if (params.tonescaleMap == 1) {
-                    float crv_normalized = crv_val / maxInput;
-                    float crv_compressed = compress_hyperbolic_power(crv_normalized, rolloff_s, rolloff_p);
-                    float crv_rescaled = crv_compressed * maxOutput;
-                    crv_val = crv_val * (1.0f - params.filmicStrength) + crv_rescaled * params.filmicStrength;
-                }
-            }
-
-            /***************************************************
-             Tonescale and RGB Ratios
-            --------------------------------------------------*/
-            // Tonescale Norm
-            float tsn = hypotf3(clampminf3(rgb, 0.0f)) / SQRT3;
-            // Purity Compression Norm
-            float ts_pt = sqrtf(fmaxf(0.0f, rgb.x * rgb.x * params.ptR + rgb.y * rgb.y * params.ptG + rgb.z * rgb.z * params.ptB));
-            
-            // RGB Ratios
-            rgb = sdivf3f(clampminf3(rgb, -2.0f), tsn);
-            
-            /***************************************************
-              Apply High Contrast
-            --------------------------------------------------*/
-            if (params.tnHconPresetEnable || params.tnHconUIEnable) {
-                float hcon_p = powf(2.0f, params.tnHcon);
-                tsn = contrast_high(tsn, hcon_p, params.tnHconPv, params.tnHconSt, 0);
-                ts_pt = contrast_high(ts_pt, hcon_p, params.tnHconPv, params.tnHconSt, 0);
-                if (params.tonescaleMap == 1) crv_val = contrast_high(crv_val, hcon_p, params.tnHconPv, params.tnHconSt, 0);
-            }
-
-            /***************************************************
-              Apply Tonescale
-            --------------------------------------------------*/
-            tsn = compress_hyperbolic_power(tsn, params.ts_s, params.tnCon);
-            ts_pt = compress_hyperbolic_power(ts_pt, params.ts_s1, params.tnCon);
-            
-            if (params.tonescaleMap == 1) crv_val = compress_hyperbolic_power(crv_val, params.ts_s, params.tnCon);
-            
-            /***************************************************
-              Prerequisite color spaces
-            --------------------------------------------------*/
-            // Simple Cyan-Yellow / Green-Magenta opponent space
-            float opp_cy = rgb.x - rgb.z;
-            float opp_gm = rgb.y - (rgb.x + rgb.z)/2.0f;
-            float ach_d = sqrtf(fmaxf(0.0f, opp_cy*opp_cy + opp_gm*opp_gm))/SQRT3;
-
-            // Smooth ach_d, normalized so 1.0 doesn't change
-            ach_d = (1.25f)*compress_toe_quadratic(ach_d, 0.25f, 0);
-
-            // Hue angle, rotated so that red = 0.0
-            float hue = fmodf(atan2f(opp_cy, opp_gm) + PI + 1.10714931f, 2.0f*PI);
-
-            // RGB Hue Angles
-            float3 ha_rgb = make_float3(
-              gauss_window(hue_offset(hue, 0.1f), 0.9f),
-              gauss_window(hue_offset(hue, 4.3f), 0.9f),
-              gauss_window(hue_offset(hue, 2.3f), 0.9f));
-
-            // CMY Hue Angles
-            float3 ha_cmy = make_float3(
-              gauss_window(hue_offset(hue, 3.3f), 0.6f),
-              gauss_window(hue_offset(hue, 1.3f), 0.6f),
-              gauss_window(hue_offset(hue, -1.2f), 0.6f));
-
-            // Purity Compression Range
-            float ts_pt_cmp = 1.0f - powf(ts_pt, 1.0f/params.ptRngLow);
-
-            float pt_rng_high_f = fminf(1.0f, ach_d/1.2f);
-            pt_rng_high_f *= pt_rng_high_f;
-            pt_rng_high_f = params.ptRngHigh < 1.0f ? 1.0f - pt_rng_high_f : pt_rng_high_f;
-            ts_pt_cmp = powf(ts_pt_cmp, params.ptRngHigh)*(1.0f - pt_rng_high_f) + ts_pt_cmp*pt_rng_high_f;
-
-            /***************************************************
-              Brilliance
-            --------------------------------------------------*/
-            float brl_f = 1.0f;
-            if (params.brlPresetEnable || params.brlUIEnable) {
-                brl_f = -params.brlR*ha_rgb.x - params.brlG*ha_rgb.y - params.brlB*ha_rgb.z - params.brlC*ha_cmy.x - params.brlM*ha_cmy.y - params.brlY*ha_cmy.z;
-                brl_f = (1.0f - ach_d)*brl_f + 1.0f - brl_f;
-                brl_f = softplus(brl_f, 0.25f, -100.0f, 0.0f);
-                
-                // Limit Brilliance adjustment by tonescale
-                float brl_ts = brl_f > 1.0f ? 1.0f - ts_pt : ts_pt;
-                float brl_lim = spowf(brl_ts, 1.0f - params.brlRng);
-                brl_f = brl_f*brl_lim + 1.0f - brl_lim;
-                brl_f = fmaxf(0.0f, fminf(2.0f, brl_f));
-            }
-
-            /***************************************************
-              Mid-Range Purity
-            --------------------------------------------------*/
-            float ptm_sc = 1.0f;
-            if (params.ptmPresetEnable || params.ptmUIEnable) {
-                // Mid Purity Low
-                float ptm_ach_d = complement_power(ach_d, params.ptmLowSt);
-                ptm_sc = sigmoid_cubic(ptm_ach_d, params.ptmLow*(1.0f - ts_pt));
-                
-                // Mid Purity High
-                ptm_ach_d = complement_power(ach_d, params.ptmHighSt)*(1.0f - ts_pt) + ach_d*ach_d*ts_pt;
-                ptm_sc *= sigmoid_cubic(ptm_ach_d, params.ptmHigh*ts_pt);
-                ptm_sc = fmaxf(0.0f, ptm_sc);
-            }
-            
-            /***************************************************
-              Hue Angle Premultiplication
-            --------------------------------------------------*/
-            ha_rgb = float3_mul(ha_rgb, ach_d);
-            ha_cmy = float3_mul(ha_cmy, (1.5f)*compress_toe_quadratic(ach_d, 0.5f, 0));
-            
-            /***************************************************
-              Hue Contrast R
-            --------------------------------------------------*/
-            if (params.hcPresetEnable || params.hcUIEnable) {
-                float hc_ts = 1.0f - ts_pt;
-                float hc_c = (1.0f - ach_d)*hc_ts + ach_d*(1.0f - hc_ts);
-                hc_c *= ha_rgb.x;
-                hc_ts *= hc_ts;
-                float hc_f = params.hcR*(hc_c - 2.0f*hc_c*hc_ts) + 1.0f;
-                rgb = make_float3(rgb.x, rgb.y*hc_f, rgb.z*hc_f);
-            }
-
-            /***************************************************
-              Hue Shift
-            --------------------------------------------------*/
-            // Hue Shift RGB
-            if (params.hsRgbPresetEnable || params.hsRgbUIEnable) {
-                float3 hs_rgb = float3_mul(ha_rgb, powf(ts_pt, 1.0f/params.hsRgbRng));
-                float3 hsf = make_float3(hs_rgb.x*params.hsR, hs_rgb.y*-params.hsG, hs_rgb.z*-params.hsB);
-                hsf = make_float3(hsf.z - hsf.y, hsf.x - hsf.z, hsf.y - hsf.x);
-                rgb = float3_add(rgb, hsf);
-            }
-
-            // Hue Shift CMY
-            if (params.hsCmyPresetEnable || params.hsCmyUIEnable) {
-                float3 hs_cmy = float3_mul(ha_cmy, (1.0f - ts_pt));
-                float3 hsf = make_float3(hs_cmy.x*-params.hsC, hs_cmy.y*params.hsM, hs_cmy.z*params.hsY);
-                hsf = make_float3(hsf.z - hsf.y, hsf.x - hsf.z, hsf.y - hsf.x);
-                rgb = float3_add(rgb, hsf);
-            }
-
-            /***************************************************
-              Module Application
-            --------------------------------------------------*/
-            // Apply brilliance
-            rgb = float3_mul(rgb, brl_f);
-            
-            // Apply purity compression and mid purity
-            ts_pt_cmp *= ptm_sc;
-            rgb = float3_add(float3_mul(rgb, ts_pt_cmp), make_float3(1.0f - ts_pt_cmp, 1.0f - ts_pt_cmp, 1.0f - ts_pt_cmp));
-
-            // Inverse Rendering Space
-            sat_L = rgb.x*rs_w.x + rgb.y*rs_w.y + rgb.z*rs_w.z;
-            rgb = float3_div(float3_sub(float3_mul(make_float3(sat_L, sat_L, sat_L), params.rsSa), rgb), (params.rsSa - 1.0f));
-
-            /***************************************************
-              Creative White Point and Output Transform
-            --------------------------------------------------*/
-            float3 cwp_rgb = rgb;
-
-            // Apply creative whitepoint transform
-            cwp_rgb = vdot(cwpMatrix, rgb);
-
-            if (params.displayGamut == 0) { // Rec.709
-                // Convert rgb to Rec.709 D65
-                float p3ToRec709D65[9] = {
-                    1.224940181f, -0.2249402404f, 0.0f,
-                    -0.04205697775f, 1.042057037f, -1.4901e-08f,
-                    -0.01963755488f, -0.07863604277f, 1.098273635f
-                };
-                rgb = vdot(p3ToRec709D65, rgb);
-                
-                if (params.cwp == 0) cwp_rgb = rgb;
-            }
-
-            // Mix between Creative Whitepoint and base by tsn
-            float cwp_f = powf(tsn, 1.0f - params.cwpRng);
-            rgb = float3_add(float3_mul(cwp_rgb, cwp_f), float3_mul(rgb, (1.0f - cwp_f)));
-
-            // Process overlay curve for display gamut and creative whitepoint
-            float3 crv_rgb = make_float3(crv_val, crv_val, crv_val);
-            float3 crv_rgb_cwp = crv_rgb;
-            if (params.tonescaleMap == 1) {
-                if (params.displayGamut == 0) { // Rec.709
-                    // Apply creative whitepoint transform for overlay
-                    crv_rgb_cwp = vdot(cwpMatrix, crv_rgb);
-                    // Apply P3 to Rec.709 transform
-                    float p3ToRec709[9] = {
-                        1.224940181f, -0.2249402404f, 0.0f,
-                        -0.04205697775f, 1.042057037f, -1.4901e-08f,
-                        -0.01963755488f, -0.07863604277f, 1.098273635f
-                    };
-                    crv_rgb = vdot(p3ToRec709, crv_rgb);
-                    if (params.cwp == 0) crv_rgb_cwp = crv_rgb;
-                }
-                else if (params.displayGamut >= 1) {
-                    // Apply creative whitepoint transform for P3 and Rec.2020
-                    crv_rgb_cwp = vdot(cwpMatrix, crv_rgb);
-                    if (params.cwp == 0) crv_rgb_cwp = crv_rgb;
-                }
-                
-                // Mix creative whitepoint for overlay curve
-                float crv_rgb_cwp_f = powf(crv_val, 1.0f - params.cwpRng);
-                crv_rgb = float3_add(float3_mul(crv_rgb_cwp, crv_rgb_cwp_f), float3_mul(crv_rgb, (1.0f - crv_rgb_cwp_f)));
-            }
-            
-            /***************************************************
-              Purity Compress Low
-            --------------------------------------------------*/
-            if (params.ptlPresetEnable || params.ptlUIEnable) {
-                float sum0 = softplus(rgb.x, 0.2f, -100.0f, -0.3f) + rgb.y + softplus(rgb.z, 0.2f, -100.0f, -0.3f);
-                rgb.x = softplus(rgb.x, 0.04f, -0.3f, 0.0f);
-                rgb.y = softplus(rgb.y, 0.06f, -0.3f, 0.0f);
-                rgb.z = softplus(rgb.z, 0.01f, -0.05f, 0.0f);
-
-                float ptl_norm = fminf(1.0f, sdivf(sum0, rgb.x + rgb.y + rgb.z));
-                rgb = float3_mul(rgb, ptl_norm);
-            }
-
-            /***************************************************
-              Final Tonescale and Display Transform
-            --------------------------------------------------*/
-            // Final tonescale adjustments
-            tsn *= params.ts_m2;
-            tsn = compress_toe_quadratic(tsn, params.tnToe, 0);
-            tsn *= params.ts_dsc;
-            
-            // Track overlay value through final tonescale adjustments
-            if (params.tonescaleMap == 1) {
-                crv_rgb = float3_mul(crv_rgb, params.ts_m2);
-                crv_rgb.x = compress_toe_quadratic(crv_rgb.x, params.tnToe, 0);
-                crv_rgb.y = compress_toe_quadratic(crv_rgb.y, params.tnToe, 0);
-                crv_rgb.z = compress_toe_quadratic(crv_rgb.z, params.tnToe, 0);
-                crv_rgb = float3_mul(crv_rgb, params.ts_dsc);
-                // scale to 1.0 = 1000 nits for st2084 PQ
-                if (params.eotf == 4) crv_rgb = float3_mul(crv_rgb, 10.0f);
-            }
-            
-            // Return from RGB ratios to final values
-            rgb = float3_mul(rgb, tsn);
-            
-            // Clamp if enabled
-            if (params.clamp != 0) {
-                rgb = clampf3(rgb, 0.0f, 1.0f);
-            }
-            
-            // Rec.2020 conversion
-            if (params.displayGamut == 2) { // Rec.2020
-                rgb = clampminf3(rgb, 0.0f);
-                float p3ToRec2020[9] = {
-                    0.7538330344f, 0.1985973691f, 0.04756959659f,
-                    0.04574384897f, 0.9417772198f, 0.01247893122f,
-                    -0.001210340355f, 0.0176017173f, 0.9836086231f
-                };
-                rgb = vdot(p3ToRec2020, rgb);
-            }
-            
-            // ENCODE FOR DISPLAY
-            rgb = encode_for_display(rgb, params.eotf);
-            
-            // Apply EOTF to overlay curve
-            if (params.tonescaleMap == 1) {
-                if ((params.eotf > 0) && (params.eotf < 4)) {
-                    float eotf_p = 2.0f + params.eotf * 0.2f;
-                    crv_rgb = spowf3(crv_rgb, 1.0f/eotf_p);
-                }
-                else if (params.eotf == 4) crv_rgb = eotf_pq(crv_rgb, 1);
-                else if (params.eotf == 5) crv_rgb = eotf_hlg(crv_rgb, 1);
-            }
-            
-            // Render overlay curve
-            if (params.tonescaleMap == 1) {
-                float3 crv_rgb_dst = make_float3(pos.y-crv_rgb.x*res.y, pos.y-crv_rgb.y*res.y, pos.y-crv_rgb.z*res.y);
-                float crv_w0 = 0.05f;
-                crv_rgb_dst.x = expf(-crv_rgb_dst.x*crv_rgb_dst.x*crv_w0);
-                crv_rgb_dst.y = expf(-crv_rgb_dst.y*crv_rgb_dst.y*crv_w0);
-                crv_rgb_dst.z = expf(-crv_rgb_dst.z*crv_rgb_dst.z*crv_w0);
-                float crv_lm = params.eotf < 4 ? 1.0f : 0.5f;
-                crv_rgb_dst = clampf3(crv_rgb_dst, 0.0f, 1.0f);
-                rgb = float3_add(float3_mul(rgb, float3_sub(make_float3(1.0f, 1.0f, 1.0f), crv_rgb_dst)), 
-                                float3_mul3(float3_mul(make_float3(crv_lm, crv_lm, crv_lm), crv_rgb_dst), crv_rgb_dst));
-            }
-            
-            // Output to buffer
-            p_Output[index + 0] = rgb.x;
-            p_Output[index + 1] = rgb.y;
-            p_Output[index + 2] = rgb.z;
-            p_Output[index + 3] = a;
+        const int index = y * p_Width * 4;
+        const float* input = p_Input + index;
+        if (hasTestPattern(params, y)) {
+            fillTestPattern(p_Width, p_Height, 0, p_Width, y, input, &pattern[0], params);
+            input = &pattern[0];
         }
+        RunCPUKernelRow(0, p_Width, input, p_Output + index, plan, 0);
+        if (plan.overlay) compositeOverlay(*plan.overlay, 0, p_Width, y, p_Output + index);
     }
 }
 
@@ -980,40 +823,21 @@ OpenDRTParams createOpenDRTParams_OpenCL(
     params.eotf = p_Eotf;
     
     // Calculate derived parameters (same as Metal version)
-    // Tonescale Parameters
-    float m1 = powf(2.0f, params.tnLp);
-    float m2 = powf(2.0f, params.tnGb);
-    float g = 1.12f;
-    float c = params.tnLg / 100.0f;
-    float n = 0.18f;
-    float k = fmaxf(1e-10f, n * m2);
-    float ip = 2.0f; // Intermediate peak
-    float s0 = n / k;
-    float s1 = m1 * (1.0f - s0);
-    float cp = c * powf(ip * m1, -g);
-    float w2 = m1 * (1.0f + c * powf(m1, g));
-    float s = (w2 - m1) / w2;
-    float t = (ip * m1 - m1) / (ip * m1 - ip * m1 * s);
-    float nd = params.tnSh;
-    
-    // Store derived values in params
-    params.ts_m1 = m1;
-    params.ts_m2 = m2;
-    params.ts_g = g;
-    params.ts_c = c;
-    params.ts_n = n;
-    params.ts_k = k;
-    params.ts_ip = ip;
-    params.ts_s0 = s0;
-    params.ts_s1 = s1;
-    params.ts_cp = cp;
-    params.ts_w2 = w2;
-    params.ts_s = s;
-    params.ts_t = t;
-    params.ts_nd = nd;
-    params.ts_x0 = 0.18f;
-    params.ts_s1 = 1.25f;
-    params.ts_dsc = 1.0f;
+    const OpenDRTPresets::TonescaleConstants tc = OpenDRTPresets::calculateTonescaleConstants(
+        p_TnLp, p_TnGb, p_PtHdr, p_TnLg, p_TnCon, p_TnSh, p_TnToe, p_TnOff, p_Eotf);
+    params.ts_x1 = tc.ts_x1;
+    params.ts_y1 = tc.ts_y1;
+    params.ts_x0 = tc.ts_x0;
+    params.ts_y0 = tc.ts_y0;
+    params.ts_s0 = tc.ts_s0;
+    params.ts_s10 = tc.ts_s10;
+    params.ts_m1 = tc.ts_m1;
+    params.ts_m2 = tc.ts_m2;
+    params.ts_s = tc.ts_s;
+    params.ts_dsc = tc.ts_dsc;
+    params.pt_cmp_Lf = tc.pt_cmp_Lf;
+    params.s_Lp100 = tc.s_Lp100;
+    params.ts_s1 = tc.ts_s1;
     
     return params;
 }
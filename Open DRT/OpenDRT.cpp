@@ -3,9 +3,24 @@
 #include "OpenDRTPresets.h"
 #include "OpenDRTParams.h"  // Include the shared header
 #include "MatrixManager.h"   // Include matrix manager
+#include "SimdKernel.h"      // Vectorized CPU kernel
+#include "OpenDRTLUTBaker.h" // Baked LUT render mode
+#include "OpenDRTLUTExport.h" // .cube/CLF export
+#include "OpenDRTSharedTables.h" // Render plan and lookup tables shared across instances
+#include "OpenDRTOverlay.h" // Test patterns and tonescale overlay around the CPU kernel
+#include "OpenDRTScopes.h"  // Output scopes
+#include "OpenDRTDither.h"   // Integer output dither
+#include "OpenDRTTileCache.h" // Output tiles of earlier renders
 
 #include <stdio.h>
 #include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <vector>
 
 // CUDA headers for error checking (only when USE_CUDA is defined)
 #ifdef USE_CUDA
@@ -40,7 +55,7 @@ using namespace OpenDRTPresets;
 #define kPluginVersionMinor 0
 
 // BOILERPLATE: Keep these unless you need different capabilities
-#define kSupportsTiles false
+#define kSupportsTiles true
 #define kSupportsMultiResolution false
 #define kSupportsMultipleClipPARs false
 
@@ -50,6 +65,16 @@ using namespace OpenDRTPresets;
 // #define GREEN_ONLY 1
 // #define BLUE_ONLY 2
 
+// Draft renders (the host's render quality, OFX 1.4): what the CPU render gives up while
+// the host asks for draft quality, e.g. when scrubbing. Finals always render at the
+// Precision and Tonescale Table settings.
+#define kDraftFull 0        // draft frames render as finals
+#define kDraftFast 1        // Fast precision with the tonescale and hue tables
+#define kDraftSubsampled 2  // the same, evaluating every other row and column and filling between
+
+// Tile cache budgets, per instance
+static const int kTileCacheBudgetMB[] = { 0, 256, 1024, 4096 };
+
 ////////////////////////////////////////////////////////////////////////////////
 // IMAGE PROCESSOR CLASS - WHERE THE ACTUAL IMAGE PROCESSING HAPPENS
 ////////////////////////////////////////////////////////////////////////////////
@@ -68,50 +93,23 @@ public:
 
     // BOILERPLATE: Basic setters
     void setSrcImg(OFX::Image* p_SrcImg);
-
-    
-    // OpenDRT parameter setter
-    void setOpenDRTParams(
-        // Input Settings
-        int p_InGamut, int p_InOetf,
-        // Tonescale Parameters
-        float p_TnLp, float p_TnGb, float p_PtHdr,
-        // Clamp Parameters
-        bool p_Clamp, float p_TnLg, float p_TnCon, float p_TnSh, float p_TnToe, float p_TnOff,
-        // High Contrast Parameters
-        bool p_TnHconEnable, float p_TnHcon, float p_TnHconPv, float p_TnHconSt,
-        // Low Contrast Parameters  
-        bool p_TnLconEnable, float p_TnLcon, float p_TnLconW, float p_TnLconPc,
-        // Creative White Parameters
-        int p_Cwp, float p_CwpRng,
-        // Render Space Parameters
-        float p_RsSa, float p_RsRw, float p_RsBw,
-        // Purity Compress Parameters
-        float p_PtR, float p_PtG, float p_PtB, float p_PtRngLow, float p_PtRngHigh,
-        // Purity Enable/Disable
-        bool p_PtlEnable, bool p_PtmEnable,
-        // Mid Purity Parameters
-        float p_PtmLow, float p_PtmLowSt, float p_PtmHigh, float p_PtmHighSt,
-        // Brilliance Parameters
-        bool p_BrlEnable, float p_BrlR, float p_BrlG, float p_BrlB, 
-        float p_BrlC, float p_BrlM, float p_BrlY, float p_BrlRng,
-        // Hueshift RGB Parameters
-        bool p_HsRgbEnable, float p_HsR, float p_HsG, float p_HsB, float p_HsRgbRng,
-        // Hueshift CMY Parameters
-        bool p_HsCmyEnable, float p_HsC, float p_HsM, float p_HsY,
-        // Hue Contrast Parameters
-        bool p_HcEnable, float p_HcR,
-        // NEW PARAMETERS - Filmic Mode and Advanced Controls
-        bool p_FilmicMode, float p_FilmicDynamicRange, int p_FilmicProjectorSim,
-        float p_FilmicSourceStops, float p_FilmicTargetStops, float p_FilmicStrength,
-        bool p_AdvHueContrast, bool p_TonescaleMap, bool p_DiagnosticsMode, bool p_RgbChipsMode, bool p_BetaFeaturesEnable,
-        // Advanced Hue Contrast Parameters
-        float p_AdvHcR, float p_AdvHcG, float p_AdvHcB, float p_AdvHcC, float p_AdvHcM, float p_AdvHcY, float p_AdvHcPower,
-        // Display Parameters
-        int p_DisplayGamut, int p_Eotf,
-        // Current preset index to look up enables
-        int p_LookPreset
-    );
+    void setBakedLUT(const OpenDRTBakedLUT* p_LUT);
+    void setOverlay();
+    void setScopes(OpenDRTScopes* p_Scopes);
+    void setIntEncode(const OpenDRTIntEncode& p_Encode);
+    void setFrame(const OfxRectI& p_Frame);
+    void setDraftSubsample(bool p_Subsample);
+    void setTileCache(OpenDRTTileCache* p_Cache, uint64_t p_Key);
+    const OpenDRTRenderPlan& getRenderPlan() const { return _plan; }
+    const OpenDRTMemoStats& getMemoStats() const { return _memoStats; }
+    const OpenDRTTileStats& getTileStats() const { return _tileStats; }
+
+    
+    // OpenDRT parameters, tonescale constants included; takes the CPU render plan with
+    // tonescale tables of 2^p_TsTableBits nodes per stop (0: none), and the hue and 16-bit
+    // input tables if asked for, from the shared cache
+    void setOpenDRTParams(const OpenDRTParams& p_Params, int p_TsTableBits = 0, bool p_HueTables = false,
+                          bool p_InputTable = false);
     
     // Step 4: ADD YOUR PARAMETER SETTERS HERE
     // void setProjectorParams(...);  // <-- Replace with your own parameter setter
@@ -123,11 +121,52 @@ public:
 
 */
 private:
+    OpenDRTImageLayout getImageLayout() const;
+
+    // Runs the kernel or baked LUT over a span of a row, in the image's pixel format
+    void processSpan(int p_Width, int p_Height, int p_X1, int p_X2, int p_Y, const void* p_Src, void* p_Dst,
+                     OpenDRTScopes* p_Scopes, OpenDRTColorCache* p_Cache);
+
+    // Subsampled draft render of a float row span, and the evaluated rows it fills from
+    struct DraftRows
+    {
+        DraftRows() { y[0] = y[1] = INT_MIN; }
+
+        int y[2];                   // rows held, by (frame row / 2) parity
+        int x1[2], x2[2];           // and the spans they were evaluated over
+        std::vector<float> rgba[2]; // RGBA over the span
+        std::vector<float> in, out; // even columns, gathered for the kernel
+    };
+    void processDraftSpan(int p_X1, int p_X2, int p_Y, const OfxRectI& p_SrcBounds, float* p_Dst,
+                          DraftRows& p_Rows, OpenDRTColorCache* p_Cache);
+    const float* getDraftRow(int p_X1, int p_X2, int p_Y, DraftRows& p_Rows, OpenDRTColorCache* p_Cache);
+
+    // Renders the rows of p_Window, black outside the source
+    void processRows(const OfxRectI& p_Window, int p_PixelBytes, OpenDRTScopes* p_Scopes,
+                     OpenDRTColorCache* p_Cache, DraftRows& p_DraftRows);
+
+    // Renders a tile, or copies it from the tile cache
+    void processCachedTile(const OfxRectI& p_Tile, int p_PixelBytes, OpenDRTColorCache* p_Cache,
+                           DraftRows& p_DraftRows, OpenDRTTileStats& p_Stats);
+
     // BOILERPLATE: Keep these basic members
     OFX::Image* _srcImg;
     
     // Replace all individual parameter variables with a single struct
     OpenDRTParams _params;  // Single struct instead of individual variables
+    OpenDRTRenderPlan _plan; // CPU kernel constants derived from _params
+    const OpenDRTBakedLUT* _lut; // Baked LUT mode: replaces the CPU kernel when set
+    OpenDRTIntEncode _intEncode; // Quantization and dither for integer images
+    OfxRectI _frame;             // Whole frame in pixels; tiles and render windows lie inside it
+    std::shared_ptr<const OpenDRTDerivedTables> _tables; // Shared plan and lookup tables _plan points at
+    OpenDRTOverlay _overlay;     // Tonescale overlay curve of the frame _plan points at, if enabled
+    OpenDRTScopes* _scopes;      // Output scopes of the render, if asked for: each thread's band merged in
+    OpenDRTMemoStats _memoStats; // Kernel reuse of the render, each thread's band merged in
+    bool _draftSubsample;        // Draft render evaluating every other row and column, float images only
+    OpenDRTTileCache* _tileCache; // Output tiles of the instance's earlier renders, if used
+    uint64_t _tileKey;           // Hash of the render settings the tiles are kept under
+    OpenDRTTileStats _tileStats; // Tiles of the render rendered and copied, each thread's band merged in
+    std::mutex _bandMutex;       // Guards what the threads merge when their band is done
     
     // Remove all the individual parameter variables that are currently declared
 };
@@ -138,6 +177,18 @@ private:
 // BOILERPLATE: Constructor
 ImageProcessor::ImageProcessor(OFX::ImageEffect& p_Instance)
     : OFX::ImageProcessor(p_Instance)
+    , _srcImg(0)
+    , _params()
+    , _plan()
+    , _lut(0)
+    , _intEncode()
+    , _frame()
+    , _scopes(0)
+    , _memoStats()
+    , _draftSubsample(false)
+    , _tileCache(0)
+    , _tileKey(0)
+    , _tileStats()
 {
 }
 ////////////////////////////////////////////////////////////////////////////////
@@ -146,14 +197,14 @@ ImageProcessor::ImageProcessor(OFX::ImageEffect& p_Instance)
 ////////////////////////////////////////////////////////////////////////////////
 // Step 6: ADD EXTERNAL KERNEL DECLARATIONS HERE
 // Make sure to pass the correct parameters to your kernels See Metal Example below
-#ifndef __APPLE__
-extern void RunCudaKernel(void* p_Stream, int p_Width, int p_Height, 
+#if !defined(__APPLE__) && !defined(OPENDRT_CPU_ONLY)
+extern void RunCudaKernel(void* p_Stream, int p_Width, int p_Height, const OpenDRTImageLayout& p_Layout,
                          const float* p_Input, float* p_Output);
 #endif
 
 // Example Metal kernel (remove if not using Metal)
 #ifdef __APPLE__
-extern void OpenDRTKernel(void* p_CmdQ, int p_Width, int p_Height,
+extern void OpenDRTKernel(void* p_CmdQ, int p_Width, int p_Height, const OpenDRTImageLayout& p_Layout,
                           const float* p_Input, float* p_Output,
                           // Basic Parameters
                           int p_InGamut, int p_InOetf,
@@ -187,12 +238,15 @@ extern void OpenDRTKernel(void* p_CmdQ, int p_Width, int p_Height,
                           bool p_FilmicMode, float p_FilmicDynamicRange, int p_FilmicProjectorSim,
                           float p_FilmicSourceStops, float p_FilmicTargetStops, float p_FilmicStrength,
                           bool p_AdvHueContrast, bool p_TonescaleMap, bool p_DiagnosticsMode, bool p_RgbChipsMode, bool p_BetaFeaturesEnable,
-                          int p_DisplayGamut, int p_Eotf);
+                          int p_DisplayGamut, int p_Eotf, int p_Precision);
 #endif
 
 // Example OpenCL kernel
-extern void RunOpenCLKernel(void* p_CmdQ, int p_Width, int p_Height, 
+#if !defined(__APPLE__) && !defined(OPENDRT_CPU_ONLY)
+extern void RunOpenCLKernel(void* p_CmdQ, int p_Width, int p_Height, const OpenDRTImageLayout& p_Layout,
                            const float* p_Input, float* p_Output);
+#endif
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // CORE  FUNCTIONS
@@ -213,31 +267,52 @@ void ImageProcessor::setYourParams(float param1, bool param2, int param3)
 ////////////////////////////////////////////////////////////////////////////////
 // Step 8: IMPLEMENT PROCESSING METHODS
 // Make sure to pass the correct parameters to your kernels See Metal Example below
+// GPU kernels run over the render window only, at frame coordinates; see OpenDRTImageLayout
+OpenDRTImageLayout ImageProcessor::getImageLayout() const
+{
+    const OfxRectI& src = _srcImg->getBounds();
+    const OfxRectI& dst = _dstImg->getBounds();
+    const int fx = _frame.x1, fy = _frame.y1;
+
+    OpenDRTImageLayout layout;
+    layout.windowX1 = _renderWindow.x1 - fx;
+    layout.windowY1 = _renderWindow.y1 - fy;
+    layout.windowX2 = _renderWindow.x2 - fx;
+    layout.windowY2 = _renderWindow.y2 - fy;
+    layout.srcX1 = src.x1 - fx;
+    layout.srcY1 = src.y1 - fy;
+    layout.srcX2 = src.x2 - fx;
+    layout.srcY2 = src.y2 - fy;
+    layout.srcStride = _srcImg->getRowBytes() / (int)sizeof(float);
+    layout.dstX1 = dst.x1 - fx;
+    layout.dstY1 = dst.y1 - fy;
+    layout.dstStride = _dstImg->getRowBytes() / (int)sizeof(float);
+    return layout;
+}
+
 void ImageProcessor::processImagesCUDA()
 {
-#ifndef __APPLE__
-    const OfxRectI& bounds = _srcImg->getBounds();
-    const int width = bounds.x2 - bounds.x1;
-    const int height = bounds.y2 - bounds.y1;
+#if !defined(__APPLE__) && !defined(OPENDRT_CPU_ONLY)
+    const int width = _frame.x2 - _frame.x1;
+    const int height = _frame.y2 - _frame.y1;
 
     float* input = static_cast<float*>(_srcImg->getPixelData());
     float* output = static_cast<float*>(_dstImg->getPixelData());
 
-    RunCudaKernel(_pCudaStream, width, height, input, output);
+    RunCudaKernel(_pCudaStream, width, height, getImageLayout(), input, output);
 #endif
 }
 
 void ImageProcessor::processImagesMetal()
 {
 #ifdef __APPLE__
-    const OfxRectI& bounds = _srcImg->getBounds();
-    const int width = bounds.x2 - bounds.x1;
-    const int height = bounds.y2 - bounds.y1;
+    const int width = _frame.x2 - _frame.x1;
+    const int height = _frame.y2 - _frame.y1;
 
     float* input = static_cast<float*>(_srcImg->getPixelData());
     float* output = static_cast<float*>(_dstImg->getPixelData());
 
-    OpenDRTKernel(_pMetalCmdQ, width, height, input, output,
+    OpenDRTKernel(_pMetalCmdQ, width, height, getImageLayout(), input, output,
                   // Basic Parameters
                   _params.inGamut, _params.inOetf,
                   _params.tnLp, _params.tnGb, _params.ptHdr,
@@ -270,58 +345,286 @@ void ImageProcessor::processImagesMetal()
                   (_params.filmicMode != 0), _params.filmicDynamicRange, _params.filmicProjectorSim,
                   _params.filmicSourceStops, _params.filmicTargetStops, _params.filmicStrength,
                   (_params.advHueContrast != 0), (_params.tonescaleMap != 0), (_params.diagnosticsMode != 0), (_params.rgbChipsMode != 0), (_params.betaFeaturesEnable != 0),
-                  _params.displayGamut, _params.eotf);
+                  _params.displayGamut, _params.eotf, _params.precision);
 #endif
 }
 
 void ImageProcessor::processImagesOpenCL()
 {
-#ifndef __APPLE__
-    const OfxRectI& bounds = _srcImg->getBounds();
-    const int width = bounds.x2 - bounds.x1;
-    const int height = bounds.y2 - bounds.y1;
+#if !defined(__APPLE__) && !defined(OPENDRT_CPU_ONLY)
+    const int width = _frame.x2 - _frame.x1;
+    const int height = _frame.y2 - _frame.y1;
 
     float* input = static_cast<float*>(_srcImg->getPixelData());
     float* output = static_cast<float*>(_dstImg->getPixelData());
 
     // Replace with your own kernel call:
-    RunOpenCLKernel(_pOpenCLCmdQ, width, height, input, output);
+    RunOpenCLKernel(_pOpenCLCmdQ, width, height, getImageLayout(), input, output);
 #endif
 }
 
-// BOILERPLATE: CPU fallback processing
+// CPU fallback processing - called by OFX::ImageProcessor::multiThreadFunction
+// once per thread with a band of rows from the render window
 void ImageProcessor::multiThreadProcessImages(OfxRectI p_ProcWindow)
 {
-    // Step 9: IMPLEMENT YOUR CPU PROCESSING HERE What happens when GPU is not available
-    // This is a simple passthrough example - replace with your effect
-    for (int y = p_ProcWindow.y1; y < p_ProcWindow.y2; ++y)
+    // RGBA pixel size; all-zero bytes are black and transparent in every format
+    int pixelBytes = 16;
+    switch (_dstImg->getPixelDepth())
     {
-        if (_effect.abort()) break;
+        case OFX::eBitDepthHalf:
+        case OFX::eBitDepthUShort: pixelBytes = 8; break;
+        case OFX::eBitDepthUByte: pixelBytes = 4; break;
+        default: break;
+    }
 
-        float* dstPix = static_cast<float*>(_dstImg->getPixelAddress(p_ProcWindow.x1, y));
+    // This thread's share of the scopes, merged once its rows are done, and its colour
+    // cache; a baked LUT has no use for one
+    OpenDRTScopes band;
+    if (_scopes) resetScopes(band);
+    std::unique_ptr<OpenDRTColorCache> cache;
+    if (!_lut)
+    {
+        cache.reset(new OpenDRTColorCache);
+        resetColorCache(*cache);
+    }
+    DraftRows draftRows;
+    OpenDRTTileStats tileStats = {};
 
-        for (int x = p_ProcWindow.x1; x < p_ProcWindow.x2; ++x)
+    if (!_tileCache)
+    {
+        processRows(p_ProcWindow, pixelBytes, _scopes ? &band : 0, cache.get(), draftRows);
+    }
+    else
+    {
+        // Tiles on the cache's grid from the frame origin, cut to the band
+        for (int y1 = p_ProcWindow.y1; y1 < p_ProcWindow.y2 && !_effect.abort(); )
         {
-            float* srcPix = static_cast<float*>(_srcImg ? _srcImg->getPixelAddress(x, y) : 0);
-
-            if (srcPix)
+            const int y2 = std::min(p_ProcWindow.y2, _frame.y1 + ((y1 - _frame.y1) / kTileCacheRows + 1) * kTileCacheRows);
+            for (int x1 = p_ProcWindow.x1; x1 < p_ProcWindow.x2; )
             {
-                // EXAMPLE: Simple effect - replace with your processing
-                dstPix[0] = srcPix[0]; // Red
-                dstPix[1] = srcPix[1]; // Green
-                dstPix[2] = srcPix[2]; // Blue
-                dstPix[3] = srcPix[3]; // Alpha
+                const int x2 = std::min(p_ProcWindow.x2, _frame.x1 + ((x1 - _frame.x1) / kTileCacheColumns + 1) * kTileCacheColumns);
+                processCachedTile(OfxRectI{x1, y1, x2, y2}, pixelBytes, cache.get(), draftRows, tileStats);
+                x1 = x2;
             }
-            else
-            {
-                // No src pixel, make it black and transparent
-                for (int c = 0; c < 4; ++c)
-                {
-                    dstPix[c] = 0;
-                }
-            }
-            dstPix += 4;
+            y1 = y2;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_bandMutex);
+    if (_scopes) mergeScopes(*_scopes, band);
+    if (cache) mergeMemoStats(_memoStats, cache->stats);
+    mergeTileStats(_tileStats, tileStats);
+}
+
+void ImageProcessor::processRows(const OfxRectI& p_Window, int p_PixelBytes, OpenDRTScopes* p_Scopes,
+                                 OpenDRTColorCache* p_Cache, DraftRows& p_DraftRows)
+{
+    // Frame-relative coordinates for the diagnostics ramps, tonescale overlay and dither, so
+    // that they line up across tiles
+    const int width = _frame.x2 - _frame.x1;
+    const int height = _frame.y2 - _frame.y1;
+    const OfxRectI srcBounds = _srcImg ? _srcImg->getBounds() : OfxRectI{0, 0, 0, 0};
+
+    for (int y = p_Window.y1; y < p_Window.y2; ++y)
+    {
+        if (_effect.abort()) break;
+
+        char* dstPix = static_cast<char*>(_dstImg->getPixelAddress(p_Window.x1, y));
+
+        // Source span for this row, anything outside it is black and transparent
+        int x1 = std::max(p_Window.x1, srcBounds.x1);
+        int x2 = std::min(p_Window.x2, srcBounds.x2);
+        if (y < srcBounds.y1 || y >= srcBounds.y2 || x1 >= x2)
+        {
+            x1 = x2 = p_Window.x2;
+        }
+
+        std::memset(dstPix, 0, (x1 - p_Window.x1) * p_PixelBytes);
+
+        if (x1 < x2 && _draftSubsample)
+        {
+            processDraftSpan(x1, x2, y, srcBounds, reinterpret_cast<float*>(dstPix + (x1 - p_Window.x1) * p_PixelBytes),
+                             p_DraftRows, p_Cache);
+        }
+        else if (x1 < x2)
+        {
+            processSpan(width, height, x1 - _frame.x1, x2 - _frame.x1, y - _frame.y1,
+                        _srcImg->getPixelAddress(x1, y), dstPix + (x1 - p_Window.x1) * p_PixelBytes,
+                        p_Scopes, p_Cache);
+        }
+
+        std::memset(dstPix + (x2 - p_Window.x1) * p_PixelBytes, 0, (p_Window.x2 - x2) * p_PixelBytes);
+    }
+}
+
+// A tile is found by the render settings and its place in the frame, and reused if its
+// source pixels hash the same as when it was kept; source and output have the same pixel size
+void ImageProcessor::processCachedTile(const OfxRectI& p_Tile, int p_PixelBytes, OpenDRTColorCache* p_Cache,
+                                       DraftRows& p_DraftRows, OpenDRTTileStats& p_Stats)
+{
+    const OfxRectI srcBounds = _srcImg ? _srcImg->getBounds() : OfxRectI{0, 0, 0, 0};
+    const int x1 = std::max(p_Tile.x1, srcBounds.x1);
+    const int x2 = std::min(p_Tile.x2, srcBounds.x2);
+    const int y1 = std::max(p_Tile.y1, srcBounds.y1);
+    const int y2 = std::min(p_Tile.y2, srcBounds.y2);
+
+    const int place[8] = {
+        p_Tile.x1 - _frame.x1, p_Tile.y1 - _frame.y1, p_Tile.x2 - _frame.x1, p_Tile.y2 - _frame.y1,
+        x1 - _frame.x1, y1 - _frame.y1, x2 - _frame.x1, y2 - _frame.y1
+    };
+    const uint64_t key = hashBytes(place, sizeof(place), _tileKey);
+    // A subsampled draft fills odd rows from the rows either side, so a tile starting or
+    // ending on one also depends on the source row above or below it
+    const int sourceY1 = _draftSubsample ? std::max(y1 - 1, srcBounds.y1) : y1;
+    const int sourceY2 = _draftSubsample ? std::min(y2 + 1, srcBounds.y2) : y2;
+    uint64_t source = 0;
+    for (int y = sourceY1; y < sourceY2 && x1 < x2; ++y)
+    {
+        source = hashBytes(_srcImg->getPixelAddress(x1, y), (x2 - x1) * p_PixelBytes, source);
+    }
+
+    const size_t rowBytes = (size_t)(p_Tile.x2 - p_Tile.x1) * p_PixelBytes;
+    ++p_Stats.tiles;
+    if (std::shared_ptr<const std::vector<char>> pixels = _tileCache->find(key, source))
+    {
+        for (int y = p_Tile.y1; y < p_Tile.y2; ++y)
+        {
+            std::memcpy(_dstImg->getPixelAddress(p_Tile.x1, y), &(*pixels)[(y - p_Tile.y1) * rowBytes], rowBytes);
+        }
+        ++p_Stats.hits;
+        return;
+    }
+
+    processRows(p_Tile, p_PixelBytes, 0, p_Cache, p_DraftRows);
+    if (_effect.abort()) return;
+
+    std::vector<char> pixels(rowBytes * (p_Tile.y2 - p_Tile.y1));
+    for (int y = p_Tile.y1; y < p_Tile.y2; ++y)
+    {
+        std::memcpy(&pixels[(y - p_Tile.y1) * rowBytes], _dstImg->getPixelAddress(p_Tile.x1, y), rowBytes);
+    }
+    _tileCache->store(key, source, std::move(pixels));
+}
+
+void ImageProcessor::processSpan(int p_Width, int p_Height, int p_X1, int p_X2, int p_Y, const void* p_Src, void* p_Dst,
+                                 OpenDRTScopes* p_Scopes, OpenDRTColorCache* p_Cache)
+{
+    switch (_dstImg->getPixelDepth())
+    {
+        case OFX::eBitDepthHalf:
+        {
+            const uint16_t* src = static_cast<const uint16_t*>(p_Src);
+            uint16_t* dst = static_cast<uint16_t*>(p_Dst);
+            if (_lut) RunSIMDLUTRow(p_X1, p_X2, src, dst, *_lut);
+            else RunSIMDKernelRow(p_Width, p_Height, p_X1, p_X2, p_Y, src, dst, _plan, p_Scopes, p_Cache);
+            break;
+        }
+        case OFX::eBitDepthUShort:
+        case OFX::eBitDepthUByte:
+        {
+            if (_lut) RunSIMDLUTRow(p_X1, p_X2, p_Y, p_Src, p_Dst, *_lut, _intEncode);
+            else RunSIMDKernelRow(p_Width, p_Height, p_X1, p_X2, p_Y, p_Src, p_Dst, _plan, _intEncode, p_Scopes, p_Cache);
+            break;
+        }
+        default:
+        {
+            const float* src = static_cast<const float*>(p_Src);
+            float* dst = static_cast<float*>(p_Dst);
+            if (_lut) RunSIMDLUTRow(p_X1, p_X2, src, dst, *_lut);
+            else RunSIMDKernelRow(p_Width, p_Height, p_X1, p_X2, p_Y, src, dst, _plan, p_Scopes, p_Cache);
+            break;
+        }
+    }
+}
+
+/***************************************************
+ Subsampled draft render
+--------------------------------------------------*/
+// The kernel runs on the even frame columns of the even frame rows, a quarter of the
+// pixels; odd columns take the mean of the display-encoded pixels either side, odd rows
+// the mean of the rows above and below, and a missing neighbour at the edge of the source
+// leaves the one there is. Alpha is the source's everywhere. Rows are evaluated over the
+// source span of the band (or cached tile) and kept two at a time, so each is computed once
+// for the odd rows on both sides of it (again where two bands or tiles meet).
+const float* ImageProcessor::getDraftRow(int p_X1, int p_X2, int p_Y, DraftRows& p_Rows, OpenDRTColorCache* p_Cache)
+{
+    const int slot = ((p_Y - _frame.y1) >> 1) & 1;
+    std::vector<float>& row = p_Rows.rgba[slot];
+    if (p_Rows.y[slot] == p_Y && p_Rows.x1[slot] == p_X1 && p_Rows.x2[slot] == p_X2) return &row[0];
+
+    const int width = _frame.x2 - _frame.x1;
+    const int height = _frame.y2 - _frame.y1;
+    const int y = p_Y - _frame.y1;
+    const float* src = static_cast<const float*>(_srcImg->getPixelAddress(p_X1, p_Y));
+    row.resize(4 * (p_X2 - p_X1));
+
+    // First even frame column and how many there are; a span of one odd column is evaluated as it is
+    const int s1 = p_X1 + ((p_X1 - _frame.x1) & 1);
+    const int n = s1 < p_X2 ? (p_X2 - 1 - s1) / 2 + 1 : 0;
+    if (n == 0)
+    {
+        RunSIMDKernelRow(width, height, p_X1 - _frame.x1, p_X2 - _frame.x1, y, src, &row[0], _plan, 0, p_Cache);
+        p_Rows.y[slot] = p_Y;
+        p_Rows.x1[slot] = p_X1;
+        p_Rows.x2[slot] = p_X2;
+        return &row[0];
+    }
+
+    // The gathered columns are not contiguous in the frame; the kernel only reads positions
+    // for the patterns and overlay, which keep a render from being subsampled
+    p_Rows.in.resize(4 * n);
+    p_Rows.out.resize(4 * n);
+    for (int j = 0; j < n; ++j)
+    {
+        std::memcpy(&p_Rows.in[4 * j], src + 4 * (s1 - p_X1 + 2 * j), 4 * sizeof(float));
+    }
+    RunSIMDKernelRow(width, height, 0, n, y, &p_Rows.in[0], &p_Rows.out[0], _plan, 0, p_Cache);
+
+    const float* out = &p_Rows.out[0];
+    for (int x = p_X1; x < p_X2; ++x)
+    {
+        float* rgba = &row[4 * (x - p_X1)];
+        const int d = x - s1;
+        if ((d & 1) == 0)
+        {
+            std::memcpy(rgba, out + 2 * d, 4 * sizeof(float));
+            continue;
+        }
+        const float* left = d > 0 ? out + 2 * (d - 1) : out + 2 * (d + 1);
+        const float* right = d + 1 < 2 * n ? out + 2 * (d + 1) : left;
+        for (int c = 0; c < 3; ++c) rgba[c] = 0.5f * (left[c] + right[c]);
+    }
+    p_Rows.y[slot] = p_Y;
+    p_Rows.x1[slot] = p_X1;
+    p_Rows.x2[slot] = p_X2;
+    return &row[0];
+}
+
+void ImageProcessor::processDraftSpan(int p_X1, int p_X2, int p_Y, const OfxRectI& p_SrcBounds, float* p_Dst,
+                                      DraftRows& p_Rows, OpenDRTColorCache* p_Cache)
+{
+    const float* above = 0;
+    const float* below = 0;
+    if (((p_Y - _frame.y1) & 1) == 0)
+    {
+        above = getDraftRow(p_X1, p_X2, p_Y, p_Rows, p_Cache);
+    }
+    else
+    {
+        if (p_Y - 1 >= p_SrcBounds.y1) above = getDraftRow(p_X1, p_X2, p_Y - 1, p_Rows, p_Cache);
+        if (p_Y + 1 < p_SrcBounds.y2) below = getDraftRow(p_X1, p_X2, p_Y + 1, p_Rows, p_Cache);
+        if (!above && !below) above = getDraftRow(p_X1, p_X2, p_Y, p_Rows, p_Cache);
+    }
+    if (!above) above = below;
+
+    const float* src = static_cast<const float*>(_srcImg->getPixelAddress(p_X1, p_Y));
+    for (int i = 0; i < p_X2 - p_X1; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            p_Dst[4 * i + c] = below ? 0.5f * (above[4 * i + c] + below[4 * i + c]) : above[4 * i + c];
         }
+        p_Dst[4 * i + 3] = src[4 * i + 3];
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
@@ -334,167 +637,51 @@ void ImageProcessor::setSrcImg(OFX::Image* p_SrcImg)
     _srcImg = p_SrcImg;
 }
 
+void ImageProcessor::setBakedLUT(const OpenDRTBakedLUT* p_LUT)
+{
+    _lut = p_LUT;
+}
 
+void ImageProcessor::setOverlay()
+{
+    _overlay.build(_plan, _frame.x2 - _frame.x1, _frame.y2 - _frame.y1);
+}
 
-void ImageProcessor::setOpenDRTParams(
-    // Input Settings
-    int p_InGamut, int p_InOetf,
-    // Tonescale Parameters
-    float p_TnLp, float p_TnGb, float p_PtHdr,
-    // Clamp Parameters
-    bool p_Clamp, float p_TnLg, float p_TnCon, float p_TnSh, float p_TnToe, float p_TnOff,
-    // High Contrast Parameters
-    bool p_TnHconEnable, float p_TnHcon, float p_TnHconPv, float p_TnHconSt,
-    // Low Contrast Parameters  
-    bool p_TnLconEnable, float p_TnLcon, float p_TnLconW, float p_TnLconPc,
-    // Creative White Parameters
-    int p_Cwp, float p_CwpRng,
-    // Render Space Parameters
-    float p_RsSa, float p_RsRw, float p_RsBw,
-    // Purity Compress Parameters
-    float p_PtR, float p_PtG, float p_PtB, float p_PtRngLow, float p_PtRngHigh,
-    // Purity Enable/Disable
-    bool p_PtlEnable, bool p_PtmEnable,
-    // Mid Purity Parameters
-    float p_PtmLow, float p_PtmLowSt, float p_PtmHigh, float p_PtmHighSt,
-    // Brilliance Parameters
-    bool p_BrlEnable, float p_BrlR, float p_BrlG, float p_BrlB, 
-    float p_BrlC, float p_BrlM, float p_BrlY, float p_BrlRng,
-    // Hueshift RGB Parameters
-    bool p_HsRgbEnable, float p_HsR, float p_HsG, float p_HsB, float p_HsRgbRng,
-    // Hueshift CMY Parameters
-    bool p_HsCmyEnable, float p_HsC, float p_HsM, float p_HsY,
-    // Hue Contrast Parameters
-    bool p_HcEnable, float p_HcR,
-    // NEW PARAMETERS - Filmic Mode and Advanced Controls
-    bool p_FilmicMode, float p_FilmicDynamicRange, int p_FilmicProjectorSim,
-    float p_FilmicSourceStops, float p_FilmicTargetStops, float p_FilmicStrength,
-    bool p_AdvHueContrast, bool p_TonescaleMap, bool p_DiagnosticsMode, bool p_RgbChipsMode, bool p_BetaFeaturesEnable,
-    // Advanced Hue Contrast Parameters
-    float p_AdvHcR, float p_AdvHcG, float p_AdvHcB, float p_AdvHcC, float p_AdvHcM, float p_AdvHcY, float p_AdvHcPower,
-    // Display Parameters
-    int p_DisplayGamut, int p_Eotf,
-    // Current preset index to look up enables
-    int p_LookPreset
-)
+void ImageProcessor::setScopes(OpenDRTScopes* p_Scopes)
 {
-    // Store UI enable flags (from user checkboxes)
-    _params.tnHconUIEnable = p_TnHconEnable ? 1 : 0;
-    _params.tnLconUIEnable = p_TnLconEnable ? 1 : 0;
-    _params.ptlUIEnable = p_PtlEnable ? 1 : 0;
-    _params.ptmUIEnable = p_PtmEnable ? 1 : 0;
-    _params.brlUIEnable = p_BrlEnable ? 1 : 0;
-    _params.hsRgbUIEnable = p_HsRgbEnable ? 1 : 0;
-    _params.hsCmyUIEnable = p_HsCmyEnable ? 1 : 0;
-    _params.hcUIEnable = p_HcEnable ? 1 : 0;
-    
-    // Store preset enable flags (from current preset)
-    if (p_LookPreset >= 0 && p_LookPreset <= 3) {
-        const OpenDRTLookPreset& preset = LOOK_PRESETS[p_LookPreset];  // Direct mapping
-        _params.tnHconPresetEnable = preset.tn_hcon_enable ? 1 : 0;
-        _params.tnLconPresetEnable = preset.tn_lcon_enable ? 1 : 0;
-        _params.ptlPresetEnable = preset.ptl_enable ? 1 : 0;
-        _params.ptmPresetEnable = preset.ptm_enable ? 1 : 0;
-        _params.brlPresetEnable = preset.brl_enable ? 1 : 0;
-        _params.hsRgbPresetEnable = preset.hs_rgb_enable ? 1 : 0;
-        _params.hsCmyPresetEnable = preset.hs_cmy_enable ? 1 : 0;
-        _params.hcPresetEnable = preset.hc_enable ? 1 : 0;
-    } else {
-        // Invalid preset - all disabled
-        _params.tnHconPresetEnable = 0;
-        _params.tnLconPresetEnable = 0;
-        _params.ptlPresetEnable = 0;
-        _params.ptmPresetEnable = 0;
-        _params.brlPresetEnable = 0;
-        _params.hsRgbPresetEnable = 0;
-        _params.hsCmyPresetEnable = 0;
-        _params.hcPresetEnable = 0;
-    }
-    
-    // Store other parameters (modify existing logic)
-    _params.inGamut = p_InGamut;
-    _params.inOetf = p_InOetf;
-    _params.tnHcon = p_TnHcon;  // Don't zero out here - let Metal kernel decide
-    _params.tnLcon = p_TnLcon;  // Don't zero out here - let Metal kernel decide
-    _params.tnLp = p_TnLp;
-    _params.tnGb = p_TnGb;
-    _params.ptHdr = p_PtHdr;
-    _params.clamp = p_Clamp ? 1 : 0;  // Convert bool to int
-    _params.tnLg = p_TnLg;
-    _params.tnCon = p_TnCon;
-    _params.tnSh = p_TnSh;
-    _params.tnToe = p_TnToe;
-    _params.tnOff = p_TnOff;
-    _params.tnHcon = p_TnHcon;
-    _params.tnHconPv = p_TnHconPv;
-    _params.tnHconSt = p_TnHconSt;
-    _params.tnLcon = p_TnLcon;
-    _params.tnLconW = p_TnLconW;
-    _params.tnLconPc = p_TnLconPc;
-int final_cwp = p_Cwp;
-if (p_Cwp == 4) { // "Use Look Preset" selected
-    // Get the current look preset's CWP value
-    if (p_LookPreset >= 0 && p_LookPreset <= 3) {
-        const OpenDRTLookPreset& preset = LOOK_PRESETS[p_LookPreset];
-        final_cwp = preset.cwp; // Use the preset's CWP value (0-3)
-    } else {
-        final_cwp = 0; // Fallback to D65 if invalid preset
-    }
+    _scopes = p_Scopes;
 }
-_params.cwp = final_cwp; // Now guaranteed to be 0-3
-    _params.cwpRng = p_CwpRng;
-    _params.rsSa = p_RsSa;
-    _params.rsRw = p_RsRw;
-    _params.rsBw = p_RsBw;
-    _params.ptR = p_PtR;
-    _params.ptG = p_PtG;
-    _params.ptB = p_PtB;
-    _params.ptRngLow = p_PtRngLow;
-    _params.ptRngHigh = p_PtRngHigh;
-    _params.ptmLow = p_PtmLow;
-    _params.ptmLowSt = p_PtmLowSt;
-    _params.ptmHigh = p_PtmHigh;
-    _params.ptmHighSt = p_PtmHighSt;
-    _params.brlR = p_BrlR;
-    _params.brlG = p_BrlG;
-    _params.brlB = p_BrlB;
-    _params.brlC = p_BrlC;
-    _params.brlM = p_BrlM;
-    _params.brlY = p_BrlY;
-    _params.brlRng = p_BrlRng;
-    _params.hsR = p_HsR;
-    _params.hsG = p_HsG;
-    _params.hsB = p_HsB;
-    _params.hsRgbRng = p_HsRgbRng;
-    _params.hsC = p_HsC;
-    _params.hsM = p_HsM;
-    _params.hsY = p_HsY;
-    _params.hcR = p_HcR;
-    
-    // NEW PARAMETERS - Advanced Hue Contrast
-    _params.advHcR = p_AdvHcR;
-    _params.advHcG = p_AdvHcG;
-    _params.advHcB = p_AdvHcB;
-    _params.advHcC = p_AdvHcC;
-    _params.advHcM = p_AdvHcM;
-    _params.advHcY = p_AdvHcY;
-    _params.advHcPower = p_AdvHcPower;
-    
-    // NEW PARAMETERS - Filmic Mode and Advanced Controls
-    _params.filmicMode = p_FilmicMode ? 1 : 0;
-    _params.filmicDynamicRange = p_FilmicDynamicRange;
-    _params.filmicProjectorSim = p_FilmicProjectorSim;
-    _params.filmicSourceStops = p_FilmicSourceStops;
-    _params.filmicTargetStops = p_FilmicTargetStops;
-    _params.filmicStrength = p_FilmicStrength;
-    _params.advHueContrast = p_AdvHueContrast ? 1 : 0;
-    _params.tonescaleMap = p_TonescaleMap ? 1 : 0;
-    _params.diagnosticsMode = p_DiagnosticsMode ? 1 : 0;
-    _params.rgbChipsMode = p_RgbChipsMode ? 1 : 0;
-    _params.betaFeaturesEnable = p_BetaFeaturesEnable ? 1 : 0;
-    
-    _params.displayGamut = p_DisplayGamut;
-    _params.eotf = p_Eotf;
+
+void ImageProcessor::setIntEncode(const OpenDRTIntEncode& p_Encode)
+{
+    _intEncode = p_Encode;
+}
+
+void ImageProcessor::setFrame(const OfxRectI& p_Frame)
+{
+    _frame = p_Frame;
+}
+
+void ImageProcessor::setDraftSubsample(bool p_Subsample)
+{
+    _draftSubsample = p_Subsample;
+}
+
+void ImageProcessor::setTileCache(OpenDRTTileCache* p_Cache, uint64_t p_Key)
+{
+    _tileCache = p_Cache;
+    _tileKey = p_Key;
+}
+
+void ImageProcessor::setOpenDRTParams(const OpenDRTParams& p_Params, int p_TsTableBits, bool p_HueTables,
+                                      bool p_InputTable)
+{
+    _params = p_Params;
+
+    // Frame constants, matrices, module selection and tables for the CPU kernels, derived
+    // once for every instance rendering the same parameters
+    _tables = OpenDRTSharedTables::instance().getTables(_params, p_TsTableBits, p_HueTables, p_InputTable);
+    _plan = _tables->plan;
 }
 /*
 void ImageProcessor::setContrastParams(float p_GammaR, float p_GammaG, float p_GammaB, 
@@ -524,6 +711,20 @@ void ImageProcessor::setContrastParams(float p_GammaR, float p_GammaG, float p_G
 ////////////////////////////////////////////////////////////////////////////////
 // The plugin that does our work */
 
+// Everything a render reads from the parameters, at one time
+struct OpenDRTParamSnapshot
+{
+    OpenDRTParams params;   // tonescale constants included
+    bool bakedLUT;
+    int tsTable;
+    int intBits;
+    int intRange;
+    int dither;
+    bool scopes;
+    int draft;              // kDraftFull, kDraftFast or kDraftSubsampled
+    int tileCache;          // tile cache budget, an index into kTileCacheBudgetMB
+};
+
 // BOILERPLATE: Main plugin class - rename if needed Hint Change all Class names with update all occurences
 //OpenDRT Should match everywhere in the code
 class OpenDRT : public OFX::ImageEffect  // <-- RENAME: Change class name
@@ -537,8 +738,12 @@ public:
     virtual void changedParam(const OFX::InstanceChangedArgs& p_Args, const std::string& p_ParamName);
     virtual void changedClip(const OFX::InstanceChangedArgs& p_Args, const std::string& p_ClipName);
 
-    void setEnabledness();
+    int setEnabledness();
     void setupAndProcess(ImageProcessor &p_Processor, const OFX::RenderArguments& p_Args);
+    void setOpenDRTParams(ImageProcessor& p_Processor, double p_Time);
+    void fetchOpenDRTParams(double p_Time, OpenDRTParams& p_Params);
+    OpenDRTParamSnapshot getParamSnapshot(double p_Time);
+    OfxRectI getFrame(const OFX::RenderArguments& p_Args, const OfxRectI& p_Fallback);
 
 private:
     // BOILERPLATE: Keep these basic clips
@@ -547,6 +752,8 @@ private:
 
     // Add preset application method
     void applyPresetValues(const OFX::InstanceChangedArgs& p_Args);
+    template <class Preset>
+    int applyTonescaleValues(const Preset& p_Preset, bool p_LockHighContrast, bool p_LockLowContrast);
 
     // Group Parameter Pointers
     OFX::GroupParam* m_HighContrastGroup;
@@ -700,6 +907,40 @@ private:
     OFX::GroupParam* m_AdvHueContrastGroup;     // Advanced Hue Contrast Group
 
     OFX::PushButtonParam* m_CoffeeButton;        // Coffee support button
+
+    // Baked LUT render mode
+    OFX::BooleanParam* m_BakedLUT;
+    OFX::ChoiceParam* m_TsTable;
+    OFX::ChoiceParam* m_Precision;
+    OFX::ChoiceParam* m_Draft;
+    OFX::ChoiceParam* m_IntBits;
+    OFX::ChoiceParam* m_IntRange;
+    OFX::ChoiceParam* m_Dither;
+    OpenDRTLUTBaker m_LUTBaker;                  // Last baked LUT, rebaked when params change
+    std::atomic<bool> m_LUTFallback;             // Baked LUT on but none met the error target
+
+    // Output tiles of recent CPU renders
+    OFX::ChoiceParam* m_TileCacheSize;
+    OpenDRTTileCache m_TileCache;
+
+    // LUT export
+    OFX::StringParam* m_LUTExportPath;           // .cube/.clf file, or the base name for both
+    OFX::ChoiceParam* m_LUTExportSize;           // 3D LUT points per axis
+
+    // Parameter snapshot: reused for any frame while no parameter is animated, else for
+    // the same time only; changedParam() drops it
+    std::mutex m_SnapshotMutex;
+    OpenDRTParamSnapshot m_Snapshot;
+    double m_SnapshotTime;
+    bool m_SnapshotValid;
+    bool m_SnapshotAnimated;
+    std::vector<OFX::ValueParam*> m_SnapshotParams; // Every parameter the snapshot reads
+
+    // Output scopes of the last CPU render, shown by Read Scopes
+    OFX::BooleanParam* m_OutputScopes;
+    OFX::StringParam* m_ScopesSummary;
+    std::mutex m_ScopesMutex;
+    OpenDRTScopes m_LastScopes;
 };
 ////////////////////////////////////////////////////////////////////////////////
 // PLUGIN CONSTRUCTOR - CONNECTS TO ALL THE UI PARAMETERS
@@ -707,6 +948,11 @@ private:
 // BOILERPLATE: Constructor - update parameter names
 OpenDRT::OpenDRT(OfxImageEffectHandle p_Handle)
     : ImageEffect(p_Handle)
+    , m_LUTFallback(false)
+    , m_Snapshot()
+    , m_SnapshotTime(0.0)
+    , m_SnapshotValid(false)
+    , m_SnapshotAnimated(false)
 {
     // Connect to input/output clips Don't Chage This
     m_DstClip = fetchClip(kOfxImageEffectOutputClipName);
@@ -860,6 +1106,41 @@ OpenDRT::OpenDRT(OfxImageEffectHandle p_Handle)
     m_LockHueContrast = fetchBooleanParam("_lock_hc");
 
     m_CoffeeButton = fetchPushButtonParam("buymeacoffee");
+    m_BakedLUT = fetchBooleanParam("_baked_lut");
+    m_TsTable = fetchChoiceParam("_ts_table");
+    m_Precision = fetchChoiceParam("_precision");
+    m_Draft = fetchChoiceParam("_draft");
+    m_TileCacheSize = fetchChoiceParam("_tile_cache");
+    m_IntBits = fetchChoiceParam("_int_bits");
+    m_IntRange = fetchChoiceParam("_int_range");
+    m_Dither = fetchChoiceParam("_dither");
+    m_LUTExportPath = fetchStringParam("_lut_export_path");
+    m_LUTExportSize = fetchChoiceParam("_lut_export_size");
+    m_OutputScopes = fetchBooleanParam("_scopes");
+    m_ScopesSummary = fetchStringParam("_scopes_summary");
+
+    // Parameters the render snapshot reads, checked for keyframes when it is taken
+    OFX::ValueParam* snapshotParams[] = {
+        m_InGamut, m_InOetf, m_TnLp, m_TnGb, m_PtHdr,
+        m_Clamp, m_TnLg, m_TnCon, m_TnSh, m_TnToe, m_TnOff,
+        m_TnHconEnable, m_TnHcon, m_TnHconPv, m_TnHconSt,
+        m_TnLconEnable, m_TnLcon, m_TnLconW, m_TnLconPc,
+        m_Cwp, m_CwpRng, m_RsSa, m_RsRw, m_RsBw,
+        m_PtR, m_PtG, m_PtB, m_PtRngLow, m_PtRngHigh, m_PtlEnable, m_PtmEnable,
+        m_PtmLow, m_PtmLowSt, m_PtmHigh, m_PtmHighSt,
+        m_BrlEnable, m_BrlR, m_BrlG, m_BrlB, m_BrlC, m_BrlM, m_BrlY, m_BrlRng,
+        m_HsRgbEnable, m_HsR, m_HsG, m_HsB, m_HsRgbRng,
+        m_HsCmyEnable, m_HsC, m_HsM, m_HsY, m_HcEnable, m_HcR,
+        m_FilmicMode, m_FilmicDynamicRange, m_FilmicProjectorSim,
+        m_FilmicSourceStops, m_FilmicTargetStops, m_FilmicStrength,
+        m_AdvHueContrast, m_AdvHcR, m_AdvHcG, m_AdvHcB, m_AdvHcC, m_AdvHcM, m_AdvHcY, m_AdvHcPower,
+        m_TonescaleMap, m_DiagnosticsMode, m_RgbChipsMode, m_BetaFeaturesEnable,
+        m_DisplayGamut, m_Eotf, m_LookPreset, m_Precision, m_Draft, m_TileCacheSize,
+        m_BakedLUT, m_TsTable, m_IntBits, m_IntRange, m_Dither, m_OutputScopes
+    };
+    m_SnapshotParams.assign(snapshotParams, snapshotParams + sizeof(snapshotParams)/sizeof(snapshotParams[0]));
+    resetScopes(m_LastScopes);
+
     setEnabledness();
 }
 
@@ -869,7 +1150,9 @@ OpenDRT::OpenDRT(OfxImageEffectHandle p_Handle)
 // BOILERPLATE: Keep render method structure
 void OpenDRT::render(const OFX::RenderArguments& p_Args)
 {
-    if ((m_DstClip->getPixelDepth() == OFX::eBitDepthFloat) && 
+    const OFX::BitDepthEnum dstBitDepth = m_DstClip->getPixelDepth();
+    if ((dstBitDepth == OFX::eBitDepthFloat || dstBitDepth == OFX::eBitDepthHalf ||
+         dstBitDepth == OFX::eBitDepthUShort || dstBitDepth == OFX::eBitDepthUByte) &&
         (m_DstClip->getPixelComponents() == OFX::ePixelComponentRGBA))
     {
         ImageProcessor processor(*this);  // <-- UPDATE: Match your class name
@@ -919,6 +1202,12 @@ bool OpenDRT::isIdentity(const OFX::IsIdentityArguments& p_Args, OFX::Clip*& p_I
 ////////////////////////////////////////////////////////////////////////////////
 void OpenDRT::changedParam(const OFX::InstanceChangedArgs& p_Args, const std::string& p_ParamName)
 {
+    // Any change, keyframes included, invalidates the render snapshot
+    {
+        std::lock_guard<std::mutex> lock(m_SnapshotMutex);
+        m_SnapshotValid = false;
+    }
+
     // Handle preset parameter changes
     if (p_ParamName == "look_preset" || p_ParamName == "tonescale_preset")
     {
@@ -961,6 +1250,38 @@ void OpenDRT::changedParam(const OFX::InstanceChangedArgs& p_Args, const std::st
         
         system(command.c_str());
     }
+    else if (p_ParamName == "_scopes_read")
+    {
+        std::string summary;
+        {
+            std::lock_guard<std::mutex> lock(m_ScopesMutex);
+            summary = formatScopesSummary(m_LastScopes);
+        }
+        m_ScopesSummary->setValue(summary);
+    }
+    else if (p_ParamName == "_lut_export")
+    {
+        // Bake the transform as it is at the current time and write <path>.cube and <path>.clf
+        static const int kLUTExportSizes[] = { 17, 33, 65 };
+        std::string path;
+        m_LUTExportPath->getValue(path);
+        int sizeIndex;
+        m_LUTExportSize->getValue(sizeIndex);
+        const int size = kLUTExportSizes[std::min(std::max(sizeIndex, 0), 2)];
+
+        ImageProcessor processor(*this);
+        setOpenDRTParams(processor, p_Args.time);
+
+        std::string error;
+        if (exportLUT(processor.getRenderPlan(), size, path, error))
+        {
+            sendMessage(OFX::Message::eMessageMessage, "", "Exported " + std::to_string(size) + "^3 LUT as .cube and .clf");
+        }
+        else
+        {
+            sendMessage(OFX::Message::eMessageError, "", error);
+        }
+    }
 
     
 }
@@ -977,7 +1298,40 @@ void OpenDRT::changedClip(const OFX::InstanceChangedArgs& p_Args, const std::str
 ////////////////////////////////////////////////////////////////////////////////
 // UI CONTROL ENABLEMENT - MANAGES WHICH CONTROLS ARE AVAILABLE
 ////////////////////////////////////////////////////////////////////////////////
-void OpenDRT::setEnabledness()
+// Parameter writes that skip values already set. Every setValue(), setIsSecret() and
+// setEnabled() reaches the host as a change it may answer with a re-render; each returns
+// 1 if it wrote, for the count preset application logs.
+static int setValueIfChanged(OFX::DoubleParam* p_Param, double p_Value)
+{
+    if (p_Param->getValue() == p_Value) return 0;
+    p_Param->setValue(p_Value);
+    return 1;
+}
+
+static int setValueIfChanged(OFX::ChoiceParam* p_Param, int p_Value)
+{
+    int value;
+    p_Param->getValue(value);
+    if (value == p_Value) return 0;
+    p_Param->setValue(p_Value);
+    return 1;
+}
+
+static int setSecretIfChanged(OFX::Param* p_Param, bool p_Secret)
+{
+    if (p_Param->getIsSecret() == p_Secret) return 0;
+    p_Param->setIsSecret(p_Secret);
+    return 1;
+}
+
+static int setEnabledIfChanged(OFX::Param* p_Param, bool p_Enabled)
+{
+    if (p_Param->getIsEnable() == p_Enabled) return 0;
+    p_Param->setEnabled(p_Enabled);
+    return 1;
+}
+
+int OpenDRT::setEnabledness()
 {
     // Check input clip
     bool hasInput = (m_SrcClip && m_SrcClip->isConnected());
@@ -1000,23 +1354,26 @@ void OpenDRT::setEnabledness()
     bool betaFeaturesEnabled = m_BetaFeaturesEnable->getValue();
     bool advHueContrastEnabled = m_AdvHueContrast->getValue();
     
+    // Only states that differ are written, so most calls change nothing
+    int changes = 0;
+
     // Show/hide groups based on enable states using setIsSecret()
-    m_HighContrastGroup->setIsSecret(!hconEnabled);
-    m_LowContrastGroup->setIsSecret(!lconEnabled);
-    m_PurityLowGroup->setIsSecret(!ptlEnabled);
-    m_MidPurityGroup->setIsSecret(!ptmEnabled);
-    m_BrillianceGroup->setIsSecret(!brlEnabled);
-    m_HueshiftRgbGroup->setIsSecret(!hsRgbEnabled);
-    m_HueshiftCmyGroup->setIsSecret(!hsCmyEnabled);
-    m_HueContrastGroup->setIsSecret(!hcEnabled);
+    changes += setSecretIfChanged(m_HighContrastGroup, !hconEnabled);
+    changes += setSecretIfChanged(m_LowContrastGroup, !lconEnabled);
+    changes += setSecretIfChanged(m_PurityLowGroup, !ptlEnabled);
+    changes += setSecretIfChanged(m_MidPurityGroup, !ptmEnabled);
+    changes += setSecretIfChanged(m_BrillianceGroup, !brlEnabled);
+    changes += setSecretIfChanged(m_HueshiftRgbGroup, !hsRgbEnabled);
+    changes += setSecretIfChanged(m_HueshiftCmyGroup, !hsCmyEnabled);
+    changes += setSecretIfChanged(m_HueContrastGroup, !hcEnabled);
     
     // NEW GROUP VISIBILITY CONTROL
     // Diagnostics Group - Always visible but closed
-    m_DiagnosticsGroup->setIsSecret(false);
+    changes += setSecretIfChanged(m_DiagnosticsGroup, false);
     
     // ✅ STEP 1: First enable/disable the mode parameters based on Beta Features
-    m_FilmicMode->setEnabled(betaFeaturesEnabled);
-    m_AdvHueContrast->setEnabled(betaFeaturesEnabled);
+    changes += setEnabledIfChanged(m_FilmicMode, betaFeaturesEnabled);
+    changes += setEnabledIfChanged(m_AdvHueContrast, betaFeaturesEnabled);
     
     // ✅ STEP 2: Then show/hide groups based on BOTH conditions
     // If Beta Features is OFF, hide everything regardless of individual mode states
@@ -1024,22 +1381,49 @@ void OpenDRT::setEnabledness()
     bool showFilmicGroups = betaFeaturesEnabled && filmicModeEnabled;
     bool showAdvHueContrastGroup = betaFeaturesEnabled && advHueContrastEnabled;
     
-    m_FilmicDynamicRangeGroup->setIsSecret(!showFilmicGroups);
-    m_FilmicProjectorSimGroup->setIsSecret(!showFilmicGroups);
-    m_AdvHueContrastGroup->setIsSecret(!showAdvHueContrastGroup);
-    
-    // Beta Features - Control individual parameter enablement (not group visibility)
-    m_FilmicMode->setEnabled(betaFeaturesEnabled);
-    m_AdvHueContrast->setEnabled(betaFeaturesEnabled);
+    changes += setSecretIfChanged(m_FilmicDynamicRangeGroup, !showFilmicGroups);
+    changes += setSecretIfChanged(m_FilmicProjectorSimGroup, !showFilmicGroups);
+    changes += setSecretIfChanged(m_AdvHueContrastGroup, !showAdvHueContrastGroup);
     
     // The individual parameters within the groups are automatically handled
     // by the group visibility, so we can remove the individual setEnabled calls
     
+    return changes;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // PRESET APPLICATION - APPLIES PRESET VALUES TO PARAMETERS
 ////////////////////////////////////////////////////////////////////////////////
+// Tonescale and contrast values, shared by the look and tonescale presets
+template <class Preset>
+int OpenDRT::applyTonescaleValues(const Preset& p_Preset, bool p_LockHighContrast, bool p_LockLowContrast)
+{
+    int changes = 0;
+
+    // Always apply basic tonescale values (never locked)
+    changes += setValueIfChanged(m_TnLg, p_Preset.tn_Lg);
+    changes += setValueIfChanged(m_TnCon, p_Preset.tn_con);
+    changes += setValueIfChanged(m_TnSh, p_Preset.tn_sh);
+    changes += setValueIfChanged(m_TnToe, p_Preset.tn_toe);
+    changes += setValueIfChanged(m_TnOff, p_Preset.tn_off);
+    
+    // Apply contrast settings only if not locked
+    if (!p_LockHighContrast) {
+        changes += setValueIfChanged(m_TnHcon, p_Preset.tn_hcon);
+        changes += setValueIfChanged(m_TnHconPv, p_Preset.tn_hcon_pv);
+        changes += setValueIfChanged(m_TnHconSt, p_Preset.tn_hcon_st);
+    }
+    
+    if (!p_LockLowContrast) {
+        changes += setValueIfChanged(m_TnLcon, p_Preset.tn_lcon);
+        changes += setValueIfChanged(m_TnLconW, p_Preset.tn_lcon_w);
+        changes += setValueIfChanged(m_TnLconPc, p_Preset.tn_lcon_pc);
+    }
+    return changes;
+}
+
+// One edit block, and only the values that differ: the host sees a single undoable change
+// and re-renders once
 void OpenDRT::applyPresetValues(const OFX::InstanceChangedArgs& p_Args)
 {
     int lookPreset;
@@ -1048,9 +1432,6 @@ void OpenDRT::applyPresetValues(const OFX::InstanceChangedArgs& p_Args)
     int tonescalePreset;
     m_TonescalePreset->getValueAtTime(p_Args.time, tonescalePreset);
     
-    // Check if stickshift adjustments should be locked
-    bool lockStickshift = m_LockStickshift->getValue();
-    
     // GET INDIVIDUAL LOCK VALUES (ADD THESE LINES):
     bool lockHighContrast = m_LockHighContrast->getValue();
     bool lockLowContrast = m_LockLowContrast->getValue();
@@ -1061,279 +1442,372 @@ void OpenDRT::applyPresetValues(const OFX::InstanceChangedArgs& p_Args)
     bool lockHueshiftCmy = m_LockHueshiftCmy->getValue();
     bool lockHueContrast = m_LockHueContrast->getValue();
     
+    // A tonescale preset replaces the look's tonescale and contrast values
+    const bool tonescaleOverride = tonescalePreset >= 1 && tonescalePreset <= 9;
+
+    beginEditBlock("OpenDRT Preset");
+    int changes = 0;
+
     // Apply look preset values
-    if (lookPreset >= 0 && lookPreset <= 4) {
+    if (lookPreset >= 0 && lookPreset <= 3) {
         const OpenDRTLookPreset& preset = LOOK_PRESETS[lookPreset];
         
-        // Always apply basic tonescale parameters (never locked)
-        m_TnLg->setValue(preset.tn_Lg);
-        m_TnCon->setValue(preset.tn_con);
-        m_TnSh->setValue(preset.tn_sh);
-        m_TnToe->setValue(preset.tn_toe);
-        m_TnOff->setValue(preset.tn_off);
+        // Tonescale and contrast, unless a tonescale preset overrides them below
+        if (!tonescaleOverride) {
+            changes += applyTonescaleValues(preset, lockHighContrast, lockLowContrast);
+        }
         
         // Always apply creative white parameters (never locked)
-        m_Cwp->setValue(preset.cwp);
-        m_CwpRng->setValue(preset.cwp_rng);
+        changes += setValueIfChanged(m_Cwp, preset.cwp);
+        changes += setValueIfChanged(m_CwpRng, preset.cwp_rng);
         
         // Always apply render space parameters (never locked)
-        m_RsSa->setValue(preset.rs_sa);
-        m_RsRw->setValue(preset.rs_rw);
-        m_RsBw->setValue(preset.rs_bw);
+        changes += setValueIfChanged(m_RsSa, preset.rs_sa);
+        changes += setValueIfChanged(m_RsRw, preset.rs_rw);
+        changes += setValueIfChanged(m_RsBw, preset.rs_bw);
         
         // GRANULAR LOCK LOGIC: Apply preset only if specific module is NOT locked
         
-        // High Contrast: Apply only if not locked
-        if (!lockHighContrast) {  // ✅ Now using the VALUE
-            m_TnHcon->setValue(preset.tn_hcon);
-            m_TnHconPv->setValue(preset.tn_hcon_pv);
-            m_TnHconSt->setValue(preset.tn_hcon_st);
-        }
-        
-        // Low Contrast: Apply only if not locked
-        if (!lockLowContrast) {  // ✅ Now using the VALUE
-            m_TnLcon->setValue(preset.tn_lcon);
-            m_TnLconW->setValue(preset.tn_lcon_w);
-            m_TnLconPc->setValue(preset.tn_lcon_pc);
-        }
-        
         // Purity Low: Apply only if not locked
-        if (!lockPurityLow) {  // ✅ Now using the VALUE
-            m_PtR->setValue(preset.pt_r);
-            m_PtG->setValue(preset.pt_g);
-            m_PtB->setValue(preset.pt_b);
-            m_PtRngLow->setValue(preset.pt_rng_low);
-            m_PtRngHigh->setValue(preset.pt_rng_high);
+        if (!lockPurityLow) {
+            changes += setValueIfChanged(m_PtR, preset.pt_r);
+            changes += setValueIfChanged(m_PtG, preset.pt_g);
+            changes += setValueIfChanged(m_PtB, preset.pt_b);
+            changes += setValueIfChanged(m_PtRngLow, preset.pt_rng_low);
+            changes += setValueIfChanged(m_PtRngHigh, preset.pt_rng_high);
         }
         
         // Mid Purity: Apply only if not locked
-        if (!lockMidPurity) {  // ✅ Now using the VALUE
-            m_PtmLow->setValue(preset.ptm_low);
-            m_PtmLowSt->setValue(preset.ptm_low_st);
-            m_PtmHigh->setValue(preset.ptm_high);
-            m_PtmHighSt->setValue(preset.ptm_high_st);
+        if (!lockMidPurity) {
+            changes += setValueIfChanged(m_PtmLow, preset.ptm_low);
+            changes += setValueIfChanged(m_PtmLowSt, preset.ptm_low_st);
+            changes += setValueIfChanged(m_PtmHigh, preset.ptm_high);
+            changes += setValueIfChanged(m_PtmHighSt, preset.ptm_high_st);
         }
         
         // Brilliance: Apply only if not locked
-        if (!lockBrilliance) {  // ✅ Now using the VALUE
-            m_BrlR->setValue(preset.brl_r);
-            m_BrlG->setValue(preset.brl_g);
-            m_BrlB->setValue(preset.brl_b);
-            m_BrlC->setValue(preset.brl_c);
-            m_BrlM->setValue(preset.brl_m);
-            m_BrlY->setValue(preset.brl_y);
-            m_BrlRng->setValue(preset.brl_rng);
+        if (!lockBrilliance) {
+            changes += setValueIfChanged(m_BrlR, preset.brl_r);
+            changes += setValueIfChanged(m_BrlG, preset.brl_g);
+            changes += setValueIfChanged(m_BrlB, preset.brl_b);
+            changes += setValueIfChanged(m_BrlC, preset.brl_c);
+            changes += setValueIfChanged(m_BrlM, preset.brl_m);
+            changes += setValueIfChanged(m_BrlY, preset.brl_y);
+            changes += setValueIfChanged(m_BrlRng, preset.brl_rng);
         }
         
         // Hueshift RGB: Apply only if not locked
-        if (!lockHueshiftRgb) {  // ✅ Now using the VALUE
-            m_HsR->setValue(preset.hs_r);
-            m_HsG->setValue(preset.hs_g);
-            m_HsB->setValue(preset.hs_b);
-            m_HsRgbRng->setValue(preset.hs_rgb_rng);
+        if (!lockHueshiftRgb) {
+            changes += setValueIfChanged(m_HsR, preset.hs_r);
+            changes += setValueIfChanged(m_HsG, preset.hs_g);
+            changes += setValueIfChanged(m_HsB, preset.hs_b);
+            changes += setValueIfChanged(m_HsRgbRng, preset.hs_rgb_rng);
         }
         
         // Hueshift CMY: Apply only if not locked
-        if (!lockHueshiftCmy) {  // ✅ Now using the VALUE
-            m_HsC->setValue(preset.hs_c);
-            m_HsM->setValue(preset.hs_m);
-            m_HsY->setValue(preset.hs_y);
+        if (!lockHueshiftCmy) {
+            changes += setValueIfChanged(m_HsC, preset.hs_c);
+            changes += setValueIfChanged(m_HsM, preset.hs_m);
+            changes += setValueIfChanged(m_HsY, preset.hs_y);
         }
         
         // Hue Contrast: Apply only if not locked
-        if (!lockHueContrast) {  // ✅ Now using the VALUE
-            m_HcR->setValue(preset.hc_r);
+        if (!lockHueContrast) {
+            changes += setValueIfChanged(m_HcR, preset.hc_r);
         }
     }
     
-// Apply tonescale preset
-if (tonescalePreset == 0) {
-    // "Use Look Preset" - don't apply anything, just use the look preset's tonescale
-    // This is handled by the look preset logic above
-} else if (tonescalePreset >= 1 && tonescalePreset <= 9) {
-    const OpenDRTTonescalePreset& preset = TONESCALE_PRESETS[tonescalePreset - 1];  // Offset by 1set];
-        
-        // Always apply basic tonescale values (never locked)
-        m_TnLg->setValue(preset.tn_Lg);
-        m_TnCon->setValue(preset.tn_con);
-        m_TnSh->setValue(preset.tn_sh);
-        m_TnToe->setValue(preset.tn_toe);
-        m_TnOff->setValue(preset.tn_off);
-        
-        // Apply contrast settings only if not locked
-        if (!lockHighContrast) {  // ✅ Now using the VALUE
-            m_TnHcon->setValue(preset.tn_hcon);
-            m_TnHconPv->setValue(preset.tn_hcon_pv);
-            m_TnHconSt->setValue(preset.tn_hcon_st);
-        }
-        
-        if (!lockLowContrast) {  // ✅ Now using the VALUE
-            m_TnLcon->setValue(preset.tn_lcon);
-            m_TnLconW->setValue(preset.tn_lcon_w);
-            m_TnLconPc->setValue(preset.tn_lcon_pc);
-        }
+    // Apply tonescale preset; 0 is "Use Look Preset", handled above
+    if (tonescaleOverride) {
+        const OpenDRTTonescalePreset& preset = TONESCALE_PRESETS[tonescalePreset - 1];  // Offset by 1
+        changes += applyTonescaleValues(preset, lockHighContrast, lockLowContrast);
     }
     
     // Update enablement after applying presets
-    setEnabledness();
+    changes += setEnabledness();
+    endEditBlock();
+
+    OFX::Log::print("OpenDRT: preset changed %d parameters\n", changes);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// SETUP AND PROCESS - COORDINATES THE ENTIRE PROCESSING PIPELINE
+// PARAMETER FETCHING - READS EVERY OPENDRT PARAMETER INTO THE PROCESSOR
+// Shared by rendering and LUT export
 ////////////////////////////////////////////////////////////////////////////////
-// Step 15: UPDATE PARAMETER FETCHING AND PROCESSING
-void OpenDRT::setupAndProcess(ImageProcessor& p_Processor, const OFX::RenderArguments& p_Args)
+void OpenDRT::fetchOpenDRTParams(double p_Time, OpenDRTParams& p_Params)
 {
-   
-    ////////////////////////////////////////////////////////////////////////////////
-    // IMAGE SETUP - GET INPUT AND OUTPUT IMAGES
-    ////////////////////////////////////////////////////////////////////////////////
-     // BOILERPLATE: Keep image setup
-    // Get the destination (output) image
-    std::unique_ptr<OFX::Image> dst(m_DstClip->fetchImage(p_Args.time));
-    OFX::BitDepthEnum dstBitDepth = dst->getPixelDepth();
-    OFX::PixelComponentEnum dstComponents = dst->getPixelComponents();
-
-    // Get the source (input) image
-    std::unique_ptr<OFX::Image> src(m_SrcClip->fetchImage(p_Args.time));
-    OFX::BitDepthEnum srcBitDepth = src->getPixelDepth();
-    OFX::PixelComponentEnum srcComponents = src->getPixelComponents();
-
-    // Verify input and output are compatible
-    if ((srcBitDepth != dstBitDepth) || (srcComponents != dstComponents))
-    {
-        OFX::throwSuiteStatusException(kOfxStatErrValue);
-    }
     ////////////////////////////////////////////////////////////////////////////////
     // PARAMETER EXTRACTION WITH BLEND MODE AND GANG LOGIC
     ////////////////////////////////////////////////////////////////////////////////
-    // Get all OpenDRT parameter values
+    // Get all OpenDRT parameter values, straight into the struct the kernels read
+    p_Params = OpenDRTParams();
 
-    // OpenDRT Parameters
     // Input Settings
-    int inGamut;
-    m_InGamut->getValueAtTime(p_Args.time, inGamut);
-    int inOetf;
-    m_InOetf->getValueAtTime(p_Args.time, inOetf);
+    m_InGamut->getValueAtTime(p_Time, p_Params.inGamut);
+    m_InOetf->getValueAtTime(p_Time, p_Params.inOetf);
     
     // Tonescale Parameters
-    float tnLp = m_TnLp->getValueAtTime(p_Args.time);
-    float tnGb = m_TnGb->getValueAtTime(p_Args.time);
-    float ptHdr = m_PtHdr->getValueAtTime(p_Args.time);
+    p_Params.tnLp = m_TnLp->getValueAtTime(p_Time);
+    p_Params.tnGb = m_TnGb->getValueAtTime(p_Time);
+    p_Params.ptHdr = m_PtHdr->getValueAtTime(p_Time);
     
     // Clamp Parameters
-    bool clamp = m_Clamp->getValueAtTime(p_Args.time);
-    float tnLg = m_TnLg->getValueAtTime(p_Args.time);
-    float tnCon = m_TnCon->getValueAtTime(p_Args.time);
-    float tnSh = m_TnSh->getValueAtTime(p_Args.time);
-    float tnToe = m_TnToe->getValueAtTime(p_Args.time);
-    float tnOff = m_TnOff->getValueAtTime(p_Args.time);
+    p_Params.clamp = m_Clamp->getValueAtTime(p_Time) ? 1 : 0;
+    p_Params.tnLg = m_TnLg->getValueAtTime(p_Time);
+    p_Params.tnCon = m_TnCon->getValueAtTime(p_Time);
+    p_Params.tnSh = m_TnSh->getValueAtTime(p_Time);
+    p_Params.tnToe = m_TnToe->getValueAtTime(p_Time);
+    p_Params.tnOff = m_TnOff->getValueAtTime(p_Time);
     
     // High Contrast Parameters
-    bool tnHconEnable = m_TnHconEnable->getValueAtTime(p_Args.time);
-    float tnHcon = m_TnHcon->getValueAtTime(p_Args.time);
-    float tnHconPv = m_TnHconPv->getValueAtTime(p_Args.time);
-    float tnHconSt = m_TnHconSt->getValueAtTime(p_Args.time);
+    p_Params.tnHconUIEnable = m_TnHconEnable->getValueAtTime(p_Time) ? 1 : 0;
+    p_Params.tnHcon = m_TnHcon->getValueAtTime(p_Time);  // Don't zero out here - let Metal kernel decide
+    p_Params.tnHconPv = m_TnHconPv->getValueAtTime(p_Time);
+    p_Params.tnHconSt = m_TnHconSt->getValueAtTime(p_Time);
     
     // Low Contrast Parameters
-    bool tnLconEnable = m_TnLconEnable->getValueAtTime(p_Args.time);
-    float tnLcon = m_TnLcon->getValueAtTime(p_Args.time);
-    float tnLconW = m_TnLconW->getValueAtTime(p_Args.time);
-    float tnLconPc = m_TnLconPc->getValueAtTime(p_Args.time);
+    p_Params.tnLconUIEnable = m_TnLconEnable->getValueAtTime(p_Time) ? 1 : 0;
+    p_Params.tnLcon = m_TnLcon->getValueAtTime(p_Time);  // Don't zero out here - let Metal kernel decide
+    p_Params.tnLconW = m_TnLconW->getValueAtTime(p_Time);
+    p_Params.tnLconPc = m_TnLconPc->getValueAtTime(p_Time);
     
     // Creative White Parameters
     int cwp;
-    m_Cwp->getValueAtTime(p_Args.time, cwp);
-    float cwpRng = m_CwpRng->getValueAtTime(p_Args.time);
+    m_Cwp->getValueAtTime(p_Time, cwp);
+    p_Params.cwpRng = m_CwpRng->getValueAtTime(p_Time);
     
     // Render Space Parameters
-    float rsSa = m_RsSa->getValueAtTime(p_Args.time);
-    float rsRw = m_RsRw->getValueAtTime(p_Args.time);
-    float rsBw = m_RsBw->getValueAtTime(p_Args.time);
+    p_Params.rsSa = m_RsSa->getValueAtTime(p_Time);
+    p_Params.rsRw = m_RsRw->getValueAtTime(p_Time);
+    p_Params.rsBw = m_RsBw->getValueAtTime(p_Time);
     
     // Purity Compress Parameters
-    float ptR = m_PtR->getValueAtTime(p_Args.time);
-    float ptG = m_PtG->getValueAtTime(p_Args.time);
-    float ptB = m_PtB->getValueAtTime(p_Args.time);
-    float ptRngLow = m_PtRngLow->getValueAtTime(p_Args.time);
-    float ptRngHigh = m_PtRngHigh->getValueAtTime(p_Args.time);
+    p_Params.ptR = m_PtR->getValueAtTime(p_Time);
+    p_Params.ptG = m_PtG->getValueAtTime(p_Time);
+    p_Params.ptB = m_PtB->getValueAtTime(p_Time);
+    p_Params.ptRngLow = m_PtRngLow->getValueAtTime(p_Time);
+    p_Params.ptRngHigh = m_PtRngHigh->getValueAtTime(p_Time);
     
     // Purity Enable/Disable
-    bool ptlEnable = m_PtlEnable->getValueAtTime(p_Args.time);
-    bool ptmEnable = m_PtmEnable->getValueAtTime(p_Args.time);
+    p_Params.ptlUIEnable = m_PtlEnable->getValueAtTime(p_Time) ? 1 : 0;
+    p_Params.ptmUIEnable = m_PtmEnable->getValueAtTime(p_Time) ? 1 : 0;
     
     // Mid Purity Parameters
-    float ptmLow = m_PtmLow->getValueAtTime(p_Args.time);
-    float ptmLowSt = m_PtmLowSt->getValueAtTime(p_Args.time);
-    float ptmHigh = m_PtmHigh->getValueAtTime(p_Args.time);
-    float ptmHighSt = m_PtmHighSt->getValueAtTime(p_Args.time);
+    p_Params.ptmLow = m_PtmLow->getValueAtTime(p_Time);
+    p_Params.ptmLowSt = m_PtmLowSt->getValueAtTime(p_Time);
+    p_Params.ptmHigh = m_PtmHigh->getValueAtTime(p_Time);
+    p_Params.ptmHighSt = m_PtmHighSt->getValueAtTime(p_Time);
     
     // Brilliance Parameters
-    bool brlEnable = m_BrlEnable->getValueAtTime(p_Args.time);
-    float brlR = m_BrlR->getValueAtTime(p_Args.time);
-    float brlG = m_BrlG->getValueAtTime(p_Args.time);
-    float brlB = m_BrlB->getValueAtTime(p_Args.time);
-    float brlC = m_BrlC->getValueAtTime(p_Args.time);
-    float brlM = m_BrlM->getValueAtTime(p_Args.time);
-    float brlY = m_BrlY->getValueAtTime(p_Args.time);
-    float brlRng = m_BrlRng->getValueAtTime(p_Args.time);
+    p_Params.brlUIEnable = m_BrlEnable->getValueAtTime(p_Time) ? 1 : 0;
+    p_Params.brlR = m_BrlR->getValueAtTime(p_Time);
+    p_Params.brlG = m_BrlG->getValueAtTime(p_Time);
+    p_Params.brlB = m_BrlB->getValueAtTime(p_Time);
+    p_Params.brlC = m_BrlC->getValueAtTime(p_Time);
+    p_Params.brlM = m_BrlM->getValueAtTime(p_Time);
+    p_Params.brlY = m_BrlY->getValueAtTime(p_Time);
+    p_Params.brlRng = m_BrlRng->getValueAtTime(p_Time);
     
     // Hueshift RGB Parameters
-    bool hsRgbEnable = m_HsRgbEnable->getValueAtTime(p_Args.time);
-    float hsR = m_HsR->getValueAtTime(p_Args.time);
-    float hsG = m_HsG->getValueAtTime(p_Args.time);
-    float hsB = m_HsB->getValueAtTime(p_Args.time);
-    float hsRgbRng = m_HsRgbRng->getValueAtTime(p_Args.time);
+    p_Params.hsRgbUIEnable = m_HsRgbEnable->getValueAtTime(p_Time) ? 1 : 0;
+    p_Params.hsR = m_HsR->getValueAtTime(p_Time);
+    p_Params.hsG = m_HsG->getValueAtTime(p_Time);
+    p_Params.hsB = m_HsB->getValueAtTime(p_Time);
+    p_Params.hsRgbRng = m_HsRgbRng->getValueAtTime(p_Time);
     
     // Hueshift CMY Parameters
-    bool hsCmyEnable = m_HsCmyEnable->getValueAtTime(p_Args.time);
-    float hsC = m_HsC->getValueAtTime(p_Args.time);
-    float hsM = m_HsM->getValueAtTime(p_Args.time);
-    float hsY = m_HsY->getValueAtTime(p_Args.time);
+    p_Params.hsCmyUIEnable = m_HsCmyEnable->getValueAtTime(p_Time) ? 1 : 0;
+    p_Params.hsC = m_HsC->getValueAtTime(p_Time);
+    p_Params.hsM = m_HsM->getValueAtTime(p_Time);
+    p_Params.hsY = m_HsY->getValueAtTime(p_Time);
     
     // Hue Contrast Parameters
-    bool hcEnable = m_HcEnable->getValueAtTime(p_Args.time);
-    float hcR = m_HcR->getValueAtTime(p_Args.time);
+    p_Params.hcUIEnable = m_HcEnable->getValueAtTime(p_Time) ? 1 : 0;
+    p_Params.hcR = m_HcR->getValueAtTime(p_Time);
     
     // NEW PARAMETERS
     // Filmic Parameters
-    bool filmicMode = m_FilmicMode->getValueAtTime(p_Args.time);
-    float filmicDynamicRange = m_FilmicDynamicRange->getValueAtTime(p_Args.time);
-    int filmicProjectorSim;
-    m_FilmicProjectorSim->getValueAtTime(p_Args.time, filmicProjectorSim);
+    p_Params.filmicMode = m_FilmicMode->getValueAtTime(p_Time) ? 1 : 0;
+    p_Params.filmicDynamicRange = m_FilmicDynamicRange->getValueAtTime(p_Time);
+    m_FilmicProjectorSim->getValueAtTime(p_Time, p_Params.filmicProjectorSim);
     
     // NEW FILMIC PARAMETERS
-    float filmicSourceStops = m_FilmicSourceStops->getValueAtTime(p_Args.time);
-    float filmicTargetStops = m_FilmicTargetStops->getValueAtTime(p_Args.time);
-    float filmicStrength = m_FilmicStrength->getValueAtTime(p_Args.time);
+    p_Params.filmicSourceStops = m_FilmicSourceStops->getValueAtTime(p_Time);
+    p_Params.filmicTargetStops = m_FilmicTargetStops->getValueAtTime(p_Time);
+    p_Params.filmicStrength = m_FilmicStrength->getValueAtTime(p_Time);
     
     // Advanced Hue Contrast Parameters
-    bool advHueContrast = m_AdvHueContrast->getValueAtTime(p_Args.time);
-    float advHcR = m_AdvHcR->getValueAtTime(p_Args.time);
-    float advHcG = m_AdvHcG->getValueAtTime(p_Args.time);
-    float advHcB = m_AdvHcB->getValueAtTime(p_Args.time);
-    float advHcC = m_AdvHcC->getValueAtTime(p_Args.time);
-    float advHcM = m_AdvHcM->getValueAtTime(p_Args.time);
-    float advHcY = m_AdvHcY->getValueAtTime(p_Args.time);
-    float advHcPower = m_AdvHcPower->getValueAtTime(p_Args.time);
+    p_Params.advHueContrast = m_AdvHueContrast->getValueAtTime(p_Time) ? 1 : 0;
+    p_Params.advHcR = m_AdvHcR->getValueAtTime(p_Time);
+    p_Params.advHcG = m_AdvHcG->getValueAtTime(p_Time);
+    p_Params.advHcB = m_AdvHcB->getValueAtTime(p_Time);
+    p_Params.advHcC = m_AdvHcC->getValueAtTime(p_Time);
+    p_Params.advHcM = m_AdvHcM->getValueAtTime(p_Time);
+    p_Params.advHcY = m_AdvHcY->getValueAtTime(p_Time);
+    p_Params.advHcPower = m_AdvHcPower->getValueAtTime(p_Time);
     
     // Tonescale Map Parameters
-    bool tonescaleMap = m_TonescaleMap->getValueAtTime(p_Args.time);
+    p_Params.tonescaleMap = m_TonescaleMap->getValueAtTime(p_Time) ? 1 : 0;
     
     // Diagnostics Parameters
-    bool diagnosticsMode = m_DiagnosticsMode->getValueAtTime(p_Args.time);
-    bool rgbChipsMode = m_RgbChipsMode->getValueAtTime(p_Args.time);
+    p_Params.diagnosticsMode = m_DiagnosticsMode->getValueAtTime(p_Time) ? 1 : 0;
+    p_Params.rgbChipsMode = m_RgbChipsMode->getValueAtTime(p_Time) ? 1 : 0;
     
     // Beta Features Parameters
-    bool betaFeaturesEnable = m_BetaFeaturesEnable->getValueAtTime(p_Args.time);
+    p_Params.betaFeaturesEnable = m_BetaFeaturesEnable->getValueAtTime(p_Time) ? 1 : 0;
     
     // Display Parameters
-    int displayGamut;
-    m_DisplayGamut->getValueAtTime(p_Args.time, displayGamut);
-    int eotf;
-    m_Eotf->getValueAtTime(p_Args.time, eotf);
+    m_DisplayGamut->getValueAtTime(p_Time, p_Params.displayGamut);
+    m_Eotf->getValueAtTime(p_Time, p_Params.eotf);
     int lookPreset;
-    m_LookPreset->getValueAtTime(p_Args.time, lookPreset);
+    m_LookPreset->getValueAtTime(p_Time, lookPreset);
+    m_Precision->getValueAtTime(p_Time, p_Params.precision);
+
+    // Store preset enable flags (from current preset)
+    if (lookPreset >= 0 && lookPreset <= 3) {
+        const OpenDRTLookPreset& preset = LOOK_PRESETS[lookPreset];  // Direct mapping
+        p_Params.tnHconPresetEnable = preset.tn_hcon_enable ? 1 : 0;
+        p_Params.tnLconPresetEnable = preset.tn_lcon_enable ? 1 : 0;
+        p_Params.ptlPresetEnable = preset.ptl_enable ? 1 : 0;
+        p_Params.ptmPresetEnable = preset.ptm_enable ? 1 : 0;
+        p_Params.brlPresetEnable = preset.brl_enable ? 1 : 0;
+        p_Params.hsRgbPresetEnable = preset.hs_rgb_enable ? 1 : 0;
+        p_Params.hsCmyPresetEnable = preset.hs_cmy_enable ? 1 : 0;
+        p_Params.hcPresetEnable = preset.hc_enable ? 1 : 0;
+    }
+    // Invalid preset - all disabled, as zeroed above
+
+    // "Use Look Preset" takes the preset's creative white; 0-3 from here on
+    if (cwp == 4) {
+        cwp = (lookPreset >= 0 && lookPreset <= 3) ? LOOK_PRESETS[lookPreset].cwp : 0; // D65 if invalid preset
+    }
+    p_Params.cwp = cwp;
+
+    // Precalculate tonescale constants (the GPU paths derive their own copy)
+    const TonescaleConstants tc = calculateTonescaleConstants(
+        p_Params.tnLp, p_Params.tnGb, p_Params.ptHdr, p_Params.tnLg, p_Params.tnCon,
+        p_Params.tnSh, p_Params.tnToe, p_Params.tnOff, p_Params.eotf);
+    p_Params.ts_x1 = tc.ts_x1;
+    p_Params.ts_y1 = tc.ts_y1;
+    p_Params.ts_x0 = tc.ts_x0;
+    p_Params.ts_y0 = tc.ts_y0;
+    p_Params.ts_s0 = tc.ts_s0;
+    p_Params.ts_s10 = tc.ts_s10;
+    p_Params.ts_m1 = tc.ts_m1;
+    p_Params.ts_m2 = tc.ts_m2;
+    p_Params.ts_s = tc.ts_s;
+    p_Params.ts_dsc = tc.ts_dsc;
+    p_Params.pt_cmp_Lf = tc.pt_cmp_Lf;
+    p_Params.s_Lp100 = tc.s_Lp100;
+    p_Params.ts_s1 = tc.ts_s1;
+}
+
+// The host is asked again only when a parameter changed, or when one is animated and the
+// time moved. Renders may run concurrently, so the snapshot is copied out under the lock.
+OpenDRTParamSnapshot OpenDRT::getParamSnapshot(double p_Time)
+{
+    std::lock_guard<std::mutex> lock(m_SnapshotMutex);
+    if (m_SnapshotValid && (!m_SnapshotAnimated || m_SnapshotTime == p_Time))
+    {
+        return m_Snapshot;
+    }
+
+    fetchOpenDRTParams(p_Time, m_Snapshot.params);
+    m_Snapshot.bakedLUT = m_BakedLUT->getValueAtTime(p_Time);
+    m_TsTable->getValueAtTime(p_Time, m_Snapshot.tsTable);
+    m_IntBits->getValueAtTime(p_Time, m_Snapshot.intBits);
+    m_IntRange->getValueAtTime(p_Time, m_Snapshot.intRange);
+    m_Dither->getValueAtTime(p_Time, m_Snapshot.dither);
+    m_Snapshot.scopes = m_OutputScopes->getValueAtTime(p_Time);
+    m_Draft->getValueAtTime(p_Time, m_Snapshot.draft);
+    m_TileCacheSize->getValueAtTime(p_Time, m_Snapshot.tileCache);
+
+    m_SnapshotAnimated = false;
+    for (OFX::ValueParam* param : m_SnapshotParams)
+    {
+        if (param->getNumKeys() > 0)
+        {
+            m_SnapshotAnimated = true;
+            break;
+        }
+    }
+    m_SnapshotTime = p_Time;
+    m_SnapshotValid = true;
+    return m_Snapshot;
+}
+
+void OpenDRT::setOpenDRTParams(ImageProcessor& p_Processor, double p_Time)
+{
+    p_Processor.setOpenDRTParams(getParamSnapshot(p_Time).params);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SETUP AND PROCESS - COORDINATES THE ENTIRE PROCESSING PIPELINE
+////////////////////////////////////////////////////////////////////////////////
+// Step 15: UPDATE PARAMETER FETCHING AND PROCESSING
+// Whole frame in pixels: the output's region of definition at the render scale. Tiles
+// and render windows are parts of it; the frame-relative patterns are placed within it.
+OfxRectI OpenDRT::getFrame(const OFX::RenderArguments& p_Args, const OfxRectI& p_Fallback)
+{
+    const OfxRectD rod = m_DstClip->getRegionOfDefinition(p_Args.time);
+    const double sx = p_Args.renderScale.x / m_DstClip->getPixelAspectRatio();
+    const double sy = p_Args.renderScale.y;
+
+    OfxRectI frame;
+    frame.x1 = (int)std::floor(rod.x1 * sx);
+    frame.y1 = (int)std::floor(rod.y1 * sy);
+    frame.x2 = (int)std::ceil(rod.x2 * sx);
+    frame.y2 = (int)std::ceil(rod.y2 * sy);
+    if (frame.x2 <= frame.x1 || frame.y2 <= frame.y1)
+    {
+        return p_Fallback;
+    }
+    return frame;
+}
+
+void OpenDRT::setupAndProcess(ImageProcessor& p_Processor, const OFX::RenderArguments& p_Args)
+{
+   
+    ////////////////////////////////////////////////////////////////////////////////
+    // IMAGE SETUP - GET INPUT AND OUTPUT IMAGES
+    ////////////////////////////////////////////////////////////////////////////////
+     // BOILERPLATE: Keep image setup
+    // Get the destination (output) image
+    std::unique_ptr<OFX::Image> dst(m_DstClip->fetchImage(p_Args.time));
+    OFX::BitDepthEnum dstBitDepth = dst->getPixelDepth();
+    OFX::PixelComponentEnum dstComponents = dst->getPixelComponents();
+
+    // Get the source (input) image
+    std::unique_ptr<OFX::Image> src(m_SrcClip->fetchImage(p_Args.time));
+    OFX::BitDepthEnum srcBitDepth = src->getPixelDepth();
+    OFX::PixelComponentEnum srcComponents = src->getPixelComponents();
+
+    // Verify input and output are compatible
+    if ((srcBitDepth != dstBitDepth) || (srcComponents != dstComponents))
+    {
+        OFX::throwSuiteStatusException(kOfxStatErrValue);
+    }
+
+    // Half-float and integer images are converted on the CPU path only; the GPU kernels read
+    // float buffers
+    const bool gpuRender = p_Args.isEnabledOpenCLRender || p_Args.isEnabledCudaRender || p_Args.isEnabledMetalRender;
+    if (gpuRender && dstBitDepth != OFX::eBitDepthFloat)
+    {
+        OFX::throwSuiteStatusException(kOfxStatErrUnsupported);
+    }
+    // Parameters, from the snapshot unless something changed
+    const OpenDRTParamSnapshot snapshot = getParamSnapshot(p_Args.time);
+
+    // Integer output: code value precision, range and dither
+    const int intBits = snapshot.intBits;
+    OpenDRTIntEncode intEncode = {};
+    intEncode.containerBits = dstBitDepth == OFX::eBitDepthUByte ? 8 : 16;
+    intEncode.codeBits = intEncode.containerBits == 16 && intBits > 0 ? (intBits == 1 ? 10 : 12) : intEncode.containerBits;
+    intEncode.legalRange = snapshot.intRange == 1 ? 1 : 0;
+    if (dstBitDepth == OFX::eBitDepthUShort || dstBitDepth == OFX::eBitDepthUByte)
+    {
+        intEncode.dither = getDitherMatrix(snapshot.dither);
+    }
     ////////////////////////////////////////////////////////////////////////////////
     // PROCESSOR SETUP - CONFIGURE THE IMAGE PROCESSOR
     ////////////////////////////////////////////////////////////////////////////////
@@ -1342,48 +1816,95 @@ void OpenDRT::setupAndProcess(ImageProcessor& p_Processor, const OFX::RenderArgu
     p_Processor.setSrcImg(src.get());
     p_Processor.setGPURenderArgs(p_Args);
     p_Processor.setRenderWindow(p_Args.renderWindow);
+    p_Processor.setIntEncode(intEncode);
+    p_Processor.setFrame(getFrame(p_Args, dst->getBounds()));
+
+    // Output scopes, CPU only; a baked LUT cannot report values before the clamp, so the
+    // kernel runs while they are on
+    const bool scopes = snapshot.scopes && !gpuRender;
+
+    // Baked LUT mode only replaces the CPU kernel; the GPU kernels evaluate the transform directly
+    const bool bakedLUT = snapshot.bakedLUT && !gpuRender && !scopes && OpenDRTLUTBaker::canBake(snapshot.params);
+
+    // Draft frames, when the host asks for them and the setting allows: Fast precision
+    // with the tables whatever the settings say. A baked LUT is left as it is, so that
+    // draft and final frames do not rebake it in turn.
+    const int draft = p_Args.renderQualityDraft && !bakedLUT ? snapshot.draft : kDraftFull;
+    OpenDRTParams params = snapshot.params;
+    int tsTable = snapshot.tsTable;
+    if (draft != kDraftFull)
+    {
+        params.precision = kPrecisionFast;
+        if (tsTable == 0) tsTable = 2;
+    }
+
+    // Tonescale tables, 2^bits nodes per stop, and hue tables; also CPU only, and only read
+    // by the Fast kernel
+    static const int kTsTableBits[] = { 0, 4, 6, 8 };
+    const bool tables = !bakedLUT && !gpuRender && params.precision == kPrecisionFast;
 
     // Pass all OpenDRT parameters to processor
-    p_Processor.setOpenDRTParams(
-        // Input Settings
-        inGamut, inOetf,
-        // Tonescale Parameters
-        tnLp, tnGb, ptHdr,
-        // Clamp Parameters
-        clamp, tnLg, tnCon, tnSh, tnToe, tnOff,
-        // High Contrast Parameters
-        tnHconEnable, tnHcon, tnHconPv, tnHconSt,
-        // Low Contrast Parameters
-        tnLconEnable, tnLcon, tnLconW, tnLconPc,
-        // Creative White Parameters
-        cwp, cwpRng,
-        // Render Space Parameters
-        rsSa, rsRw, rsBw,
-        // Purity Compress Parameters
-        ptR, ptG, ptB, ptRngLow, ptRngHigh,
-        // Purity Enable/Disable
-        ptlEnable, ptmEnable,
-        // Mid Purity Parameters
-        ptmLow, ptmLowSt, ptmHigh, ptmHighSt,
-        // Brilliance Parameters
-        brlEnable, brlR, brlG, brlB, brlC, brlM, brlY, brlRng,
-        // Hueshift RGB Parameters
-        hsRgbEnable, hsR, hsG, hsB, hsRgbRng,
-        // Hueshift CMY Parameters
-        hsCmyEnable, hsC, hsM, hsY,
-        // Hue Contrast Parameters
-        hcEnable, hcR,
-        // NEW PARAMETERS - Filmic Mode and Advanced Controls
-        filmicMode, filmicDynamicRange, filmicProjectorSim,
-        filmicSourceStops, filmicTargetStops, filmicStrength,
-        advHueContrast, tonescaleMap, diagnosticsMode, rgbChipsMode, betaFeaturesEnable,
-        // Advanced Hue Contrast Parameters
-        advHcR, advHcG, advHcB, advHcC, advHcM, advHcY, advHcPower,
-        // Display Parameters
-        displayGamut, eotf,
-        // Look Preset
-        lookPreset
-    );
+    p_Processor.setOpenDRTParams(params, tables ? kTsTableBits[std::min(std::max(tsTable, 0), 3)] : 0, tables,
+                                 tables && srcBitDepth == OFX::eBitDepthUShort);
+
+    std::shared_ptr<const OpenDRTBakedLUT> lut;
+    if (bakedLUT)
+    {
+        lut = m_LUTBaker.getLUT(p_Processor.getRenderPlan());
+    }
+    p_Processor.setBakedLUT(lut.get());
+
+    // No grid size met the error target: the kernel renders, and the user is told why the
+    // setting has no effect. Only on a change, as renders run concurrently.
+    const bool lutFallback = bakedLUT && !lut;
+    if (m_LUTFallback.exchange(lutFallback) != lutFallback)
+    {
+        if (lutFallback)
+        {
+            setPersistentMessage(OFX::Message::eMessageWarning, "",
+                                 "Baked LUT: no LUT size stays within two 10-bit code values of the full transform for these settings; rendering without it");
+        }
+        else
+        {
+            clearPersistentMessage();
+        }
+    }
+
+    // Tonescale overlay curve, one evaluation per column of the frame, for the CPU kernels
+    if (!lut && !gpuRender)
+    {
+        p_Processor.setOverlay();
+    }
+
+    // Subsampled drafts of float images through the kernel; not with the patterns or overlay,
+    // whose lines would be averaged away, nor the scopes, which would count a quarter of the pixels
+    const bool subsample = draft == kDraftSubsampled && !lut && !gpuRender && !scopes &&
+                           dstBitDepth == OFX::eBitDepthFloat && OpenDRTLUTBaker::canBake(params);
+    p_Processor.setDraftSubsample(subsample);
+
+    // Tile cache, CPU only; the scopes need every pixel rendered. Tiles are kept under a
+    // hash of everything but the source pixels their output depends on: the params bytes,
+    // which have no padding (static_asserts in OpenDRTParams.h), and the other settings
+    // as ints.
+    m_TileCache.setBudget((size_t)kTileCacheBudgetMB[std::min(std::max(snapshot.tileCache, 0), 3)] << 20);
+    if (!gpuRender && !scopes && m_TileCache.enabled())
+    {
+        const OfxRectI frame = getFrame(p_Args, dst->getBounds());
+        const int settings[] = {
+            tsTable, lut ? 1 : 0, subsample ? 1 : 0, (int)dstBitDepth,
+            intEncode.containerBits, intEncode.codeBits, intEncode.legalRange, snapshot.dither,
+            frame.x1, frame.y1, frame.x2, frame.y2
+        };
+        p_Processor.setTileCache(&m_TileCache, hashBytes(settings, sizeof(settings), hashBytes(&params, sizeof(params), 0)));
+    }
+
+    std::unique_ptr<OpenDRTScopes> frameScopes;
+    if (scopes)
+    {
+        frameScopes.reset(new OpenDRTScopes);
+        resetScopes(*frameScopes);
+        p_Processor.setScopes(frameScopes.get());
+    }
     ////////////////////////////////////////////////////////////////////////////////
     // EXECUTE PROCESSING
     ////////////////////////////////////////////////////////////////////////////////
@@ -1391,6 +1912,35 @@ void OpenDRT::setupAndProcess(ImageProcessor& p_Processor, const OFX::RenderArgu
     // Start the actual image processing (calls multiThreadProcessImages)
     // BOILERPLATE: Keep process call
     p_Processor.process();
+
+    OFX::Log::print("OpenDRT: frame at %g rendered %s\n", p_Args.time,
+                    draft == kDraftFull ? "at full quality" : subsample ? "as a subsampled draft" : "as a Fast draft");
+
+    const OpenDRTTileStats& tiles = p_Processor.getTileStats();
+    if (tiles.tiles)
+    {
+        m_TileCache.addStats(tiles);
+        const OpenDRTTileStats totals = m_TileCache.totals();
+        OFX::Log::print("OpenDRT: %llu of %llu tiles at %g from the tile cache, %.1f%% of all so far, %.0f MB held\n",
+                        (unsigned long long)tiles.hits, (unsigned long long)tiles.tiles, p_Args.time,
+                        100.0 * totals.hits / totals.tiles, m_TileCache.bytesHeld() / 1048576.0);
+    }
+
+    const OpenDRTMemoStats& memo = p_Processor.getMemoStats();
+    if (memo.pixels)
+    {
+        OFX::Log::print("OpenDRT: %llu pixels at %g, %.1f%% repeated the pixel before, %.1f%% from the colour cache\n",
+                        (unsigned long long)memo.pixels, p_Args.time,
+                        100.0 * memo.runHits / memo.pixels, 100.0 * memo.cacheHits / memo.pixels);
+    }
+
+    if (frameScopes && !abort())
+    {
+        OFX::Log::print("OpenDRT scopes at %g: %s\n%s", p_Args.time,
+                        formatScopesSummary(*frameScopes).c_str(), formatScopesDetail(*frameScopes).c_str());
+        std::lock_guard<std::mutex> lock(m_ScopesMutex);
+        m_LastScopes = *frameScopes;
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1451,8 +2001,23 @@ void OpenDRTFactory::describe(OFX::ImageEffectDescriptor& p_Desc)
     p_Desc.addSupportedContext(eContextFilter);
     p_Desc.addSupportedContext(eContextGeneral);
     p_Desc.addSupportedBitDepth(eBitDepthFloat);
+    p_Desc.addSupportedBitDepth(eBitDepthHalf);
+    p_Desc.addSupportedBitDepth(eBitDepthUShort);
+    p_Desc.addSupportedBitDepth(eBitDepthUByte);
 
     p_Desc.setSingleInstance(false);
+    // What renders share, and how:
+    //  - immutable: the MatrixManager matrix set (swapped whole, atomically), the dither
+    //    matrices and the SIMD dispatch table
+    //  - OpenDRTSharedTables, across instances: render plans, tonescale/hue tables and
+    //    baked LUTs, under its mutex; each entry is built once and handed out through a
+    //    shared_future, and stays alive while a render holds it
+    //  - per instance, each under its own mutex: the LUT baker, the tile cache, the
+    //    parameter snapshot and the last scopes
+    // Everything else a render touches lives in its ImageProcessor. The host may render
+    // frames and instances concurrently; within a frame the plugin spreads rows over its
+    // own threads.
+    p_Desc.setRenderThreadSafety(eRenderFullySafe);
     p_Desc.setHostFrameThreading(false);
     p_Desc.setSupportsMultiResolution(kSupportsMultiResolution);
     p_Desc.setSupportsTiles(kSupportsTiles);
@@ -1460,8 +2025,8 @@ void OpenDRTFactory::describe(OFX::ImageEffectDescriptor& p_Desc)
     p_Desc.setRenderTwiceAlways(false);
     p_Desc.setSupportsMultipleClipPARs(kSupportsMultipleClipPARs);
 
-    // GPU support flags
-#ifndef __APPLE__
+    // GPU support flags (a CPU-only build advertises none and always takes multiThreadProcessImages)
+#if !defined(__APPLE__) && !defined(OPENDRT_CPU_ONLY)
     p_Desc.setSupportsOpenCLRender(true);
     p_Desc.setSupportsCudaRender(true);
     p_Desc.setSupportsCudaStream(true);
@@ -1741,6 +2306,33 @@ tonescalePresetParam->setAnimates(true);
 tonescalePresetParam->setParent(*presetGroup);
 page->addChild(*tonescalePresetParam);
 
+    // LUT export: bakes the current settings for hardware that cannot run the plugin
+    StringParamDescriptor* lutExportPathParam = p_Desc.defineStringParam("_lut_export_path");
+    lutExportPathParam->setLabels("LUT Export File", "LUT Export File", "LUT Export File");
+    lutExportPathParam->setHint("Where Export LUT writes. Both a .cube (1D shaper + 3D) and a .clf are written next to each other, named after this file");
+    lutExportPathParam->setStringType(eStringTypeFilePath);
+    lutExportPathParam->setFilePathExists(false);
+    lutExportPathParam->setAnimates(false);
+    lutExportPathParam->setParent(*presetGroup);
+    page->addChild(*lutExportPathParam);
+
+    ChoiceParamDescriptor* lutExportSizeParam = p_Desc.defineChoiceParam("_lut_export_size");
+    lutExportSizeParam->setLabel("LUT Export Size");
+    lutExportSizeParam->setHint("3D LUT points per axis. The input shaper follows Input Transfer Function: Intermediate for linear input, none for log inputs");
+    lutExportSizeParam->appendOption("17");
+    lutExportSizeParam->appendOption("33");
+    lutExportSizeParam->appendOption("65");
+    lutExportSizeParam->setDefault(1); // 33
+    lutExportSizeParam->setAnimates(false);
+    lutExportSizeParam->setParent(*presetGroup);
+    page->addChild(*lutExportSizeParam);
+
+    PushButtonParamDescriptor* lutExportButton = p_Desc.definePushButtonParam("_lut_export");
+    lutExportButton->setLabel("Export LUT");
+    lutExportButton->setHint("Write the current transform as .cube and CLF LUTs. Not available with the diagnostics patterns or tonescale curve");
+    lutExportButton->setParent(*presetGroup);
+    page->addChild(*lutExportButton);
+
     // Lock parameter
     OFX::BooleanParamDescriptor* lockStickshiftParam = p_Desc.defineBooleanParam("lockStickshift");
     lockStickshiftParam->setDefault(false);
@@ -2172,23 +2764,29 @@ page->addChild(*tonescalePresetParam);
     rgbChipsModeParam->setLabels("RGB Chips", "RGB Chips", "RGB Chips");
     rgbChipsModeParam->setParent(*diagnosticsGroup);
     page->addChild(*rgbChipsModeParam);
-    
-    // FILMIC DYNAMIC RANGE GROUP PARAMETERS
-    // Filmic Dynamic Range Parameter (in Filmic Dynamic Range group)
-   
-    
-    // Original Camera Range Parameter
-    param = defineDoubleParam(p_Desc, "_filmic_source_stops", "Original Camera Range", "Number of stops captured by the original camera or scene", 
-                             filmicDynamicRangeGroup, 14.0, 1.0, 20.0, 1.0);
-    page->addChild(*diagnosticsModeParam);
-    
-    // RGB Chips Parameter (in Diagnostics group)
-    BooleanParamDescriptor* rgbChipsModeParam = p_Desc.defineBooleanParam("_rgbchips");
-    rgbChipsModeParam->setDefault(false); // Deactivated by default
-    rgbChipsModeParam->setHint("Enable RGB Chips");
-    rgbChipsModeParam->setLabels("RGB Chips", "RGB Chips", "RGB Chips");
-    rgbChipsModeParam->setParent(*diagnosticsGroup);
-    page->addChild(*rgbChipsModeParam);
+
+    // Output scopes (in Diagnostics group)
+    BooleanParamDescriptor* scopesParam = p_Desc.defineBooleanParam("_scopes");
+    scopesParam->setDefault(false);
+    scopesParam->setHint("Gather a luma histogram and waveform, per-channel clip counts and the pixels out of the display gamut before the clamp, in the render pass. CPU renders only; turns off the baked LUT");
+    scopesParam->setLabels("Output Scopes", "Output Scopes", "Output Scopes");
+    scopesParam->setParent(*diagnosticsGroup);
+    page->addChild(*scopesParam);
+
+    PushButtonParamDescriptor* scopesReadButton = p_Desc.definePushButtonParam("_scopes_read");
+    scopesReadButton->setLabel("Read Scopes");
+    scopesReadButton->setHint("Show the scopes of the last render below; debug builds also write the histogram and waveform to the OFX log");
+    scopesReadButton->setParent(*diagnosticsGroup);
+    page->addChild(*scopesReadButton);
+
+    StringParamDescriptor* scopesSummaryParam = p_Desc.defineStringParam("_scopes_summary");
+    scopesSummaryParam->setLabels("Scopes", "Scopes", "Scopes");
+    scopesSummaryParam->setHint("Clipped and crushed pixels per channel, pixels below 0 or out of the display gamut before the clamp, and the 1st/50th/99th luma percentiles");
+    scopesSummaryParam->setStringType(eStringTypeLabel);
+    scopesSummaryParam->setEvaluateOnChange(false);
+    scopesSummaryParam->setIsPersistant(false);
+    scopesSummaryParam->setParent(*diagnosticsGroup);
+    page->addChild(*scopesSummaryParam);
     
     // FILMIC DYNAMIC RANGE GROUP PARAMETERS
     // Filmic Dynamic Range Parameter (in Filmic Dynamic Range group)
@@ -2257,6 +2855,89 @@ page->addChild(*tonescalePresetParam);
     eotfParam->setAnimates(true);
     eotfParam->setParent(*inputGroup);
     page->addChild(*eotfParam);
+
+    // Baked LUT render mode
+    BooleanParamDescriptor* bakedLutParam = p_Desc.defineBooleanParam("_baked_lut");
+    bakedLutParam->setDefault(false);
+    bakedLutParam->setHint("CPU render through a 3D LUT baked from the current settings (33-129 points, sized to stay within two 10-bit code values of the full transform for 99% of colours; if no size does, as with PQ and HLG, the full transform renders and a warning says so). Rebaked when a parameter changes; ignored with the diagnostics patterns or tonescale curve");
+    bakedLutParam->setLabels("Baked LUT (CPU)", "Baked LUT (CPU)", "Baked LUT (CPU)");
+    bakedLutParam->setParent(*inputGroup);
+    page->addChild(*bakedLutParam);
+
+    // Tonescale table resolution
+    ChoiceParamDescriptor* tsTableParam = p_Desc.defineChoiceParam("_ts_table");
+    tsTableParam->setLabels("Tonescale Table (CPU)", "Tonescale Table (CPU)", "Tonescale Table (CPU)");
+    tsTableParam->setHint("CPU render looks the tonescale curve up in a table rebuilt each frame instead of evaluating it per pixel. Each table is checked against the exact curve and not used if it is off by more than 1/2048; 16 points per stop may not pass with high contrast settings. With 256 per stop, the default, Fast precision stays within 5e-5 of Exact on the output, 64 per stop within 3e-4 (1e-3 with PQ)");
+    tsTableParam->appendOption("Analytic");
+    tsTableParam->appendOption("16 per stop");
+    tsTableParam->appendOption("64 per stop");
+    tsTableParam->appendOption("256 per stop");
+    tsTableParam->setDefault(3);
+    tsTableParam->setParent(*inputGroup);
+    page->addChild(*tsTableParam);
+
+    // Render precision
+    ChoiceParamDescriptor* precisionParam = p_Desc.defineChoiceParam("_precision");
+    precisionParam->setLabels("Precision", "Precision", "Precision");
+    precisionParam->setHint("Fast renders with approximated pow/log/exp/atan (relative error around 1e-6) and the tonescale and hue tables, within 1e-4 of Exact on the output with the default 256 per stop tonescale table (see Tonescale Table), and compiles the Metal kernel with fast math. Exact, the default, runs the DCTL math as written, several times slower on the CPU; Fast is for interactive grading and review renders, and draft frames use it anyway (see Draft Renders)");
+    precisionParam->appendOption("Fast");
+    precisionParam->appendOption("Exact (DCTL)");
+    precisionParam->setDefault(kPrecisionExact);
+    precisionParam->setParent(*inputGroup);
+    page->addChild(*precisionParam);
+
+    // Draft renders
+    ChoiceParamDescriptor* draftParam = p_Desc.defineChoiceParam("_draft");
+    draftParam->setLabels("Draft Renders", "Draft Renders", "Draft Renders");
+    draftParam->setHint("What frames the host asks for at draft quality (e.g. while scrubbing) may give up. Fast renders them with Fast precision and the tonescale and hue tables whatever those are set to. Subsampled also evaluates only every other row and column of float images on the CPU and fills between them, about four times faster; not with the diagnostics patterns, tonescale curve or scopes. Final renders always use the settings above");
+    draftParam->appendOption("Full Quality");
+    draftParam->appendOption("Fast");
+    draftParam->appendOption("Fast, Subsampled");
+    draftParam->setDefault(kDraftFast);
+    draftParam->setParent(*inputGroup);
+    page->addChild(*draftParam);
+
+    // Tile cache
+    ChoiceParamDescriptor* tileCacheParam = p_Desc.defineChoiceParam("_tile_cache");
+    tileCacheParam->setLabels("Tile Cache (CPU)", "Tile Cache (CPU)", "Tile Cache (CPU)");
+    tileCacheParam->setHint("Memory for output tiles of recent CPU renders of this instance. A tile whose source pixels and settings are the same as when it was kept (held frames, freeze frames, locked-off shots) is copied instead of rendered. Not used while the scopes are on; the render log reports the tiles copied");
+    tileCacheParam->appendOption("Off");
+    tileCacheParam->appendOption("256 MB");
+    tileCacheParam->appendOption("1 GB");
+    tileCacheParam->appendOption("4 GB");
+    tileCacheParam->setDefault(1);
+    tileCacheParam->setParent(*inputGroup);
+    page->addChild(*tileCacheParam);
+
+    // Integer output
+    ChoiceParamDescriptor* intBitsParam = p_Desc.defineChoiceParam("_int_bits");
+    intBitsParam->setLabels("Integer Output Bits", "Integer Output Bits", "Integer Output Bits");
+    intBitsParam->setHint("With 16-bit integer output, quantize to 10 or 12 bit code values (bit-replicated into 16 bits). Float and half output are not quantized");
+    intBitsParam->appendOption("Clip Depth");
+    intBitsParam->appendOption("10 bit");
+    intBitsParam->appendOption("12 bit");
+    intBitsParam->setDefault(0);
+    intBitsParam->setParent(*inputGroup);
+    page->addChild(*intBitsParam);
+
+    ChoiceParamDescriptor* intRangeParam = p_Desc.defineChoiceParam("_int_range");
+    intRangeParam->setLabels("Integer Output Range", "Integer Output Range", "Integer Output Range");
+    intRangeParam->setHint("Code range of integer output: full, or legal/video levels (16-235 scaled to the bit depth). Integer input is always read as full range");
+    intRangeParam->appendOption("Full");
+    intRangeParam->appendOption("Legal");
+    intRangeParam->setDefault(0);
+    intRangeParam->setParent(*inputGroup);
+    page->addChild(*intRangeParam);
+
+    ChoiceParamDescriptor* ditherParam = p_Desc.defineChoiceParam("_dither");
+    ditherParam->setLabels("Dither", "Dither", "Dither");
+    ditherParam->setHint("Dither applied when quantizing to integer output, in place of rounding: an 8x8 ordered pattern or 64x64 blue noise, one code value in amplitude");
+    ditherParam->appendOption("None");
+    ditherParam->appendOption("Ordered");
+    ditherParam->appendOption("Blue Noise");
+    ditherParam->setDefault(kDitherNone);
+    ditherParam->setParent(*inputGroup);
+    page->addChild(*ditherParam);
 // Add this at the very end of describeInContext, just before the closing brace:
 
 
@@ -2276,37 +2957,20 @@ ImageEffect* OpenDRTFactory::createInstance(OfxImageEffectHandle p_Handle, Conte
 // PLUGIN REGISTRATION - TELLS OFX SYSTEM ABOUT OUR PLUGIN
 ////////////////////////////////////////////////////////////////////////////////
 // BOILERPLATE: Keep plugin registration
+// Logs the CPU kernel to the OFX log (DEBUG builds); runs once per process. The color
+// matrices are compiled in (ColorMatrices.h), so loading the plugin reads no files.
+static bool initializePlugin()
+{
+    OFX::Log::print("OpenDRT: CPU kernel using %s\n", getSIMDKernelISA());
+    return true;
+}
+
 void OFX::Plugin::getPluginIDs(PluginFactoryArray& p_FactoryArray)
 {
-    // Initialize matrix manager on plugin load
-    static bool matricesInitialized = false;
-    if (!matricesInitialized) {
-        std::string configPath = "./ColorMatrices.json"; // Default path
-        
-        // Try different possible paths
-        const char* possiblePaths[] = {
-            "./ColorMatrices.json",
-            "../ColorMatrices.json", 
-            "../../ColorMatrices.json",
-            "./Open DRT/ColorMatrices.json",
-            "../Open DRT/ColorMatrices.json"
-        };
-        
-        bool loaded = false;
-        for (const char* path : possiblePaths) {
-            if (MatrixManager::loadMatrices(path)) {
-                printf("OpenDRT: Loaded color matrices from %s\n", path);
-                loaded = true;
-                break;
-            }
-        }
-        
-        if (!loaded) {
-            printf("OpenDRT Warning: Could not load color matrices, using fallback matrices\n");
-        }
-        
-        matricesInitialized = true;
-    }
+    // Log once on plugin load. Function-local static: runs once, and a second caller
+    // waits for it, under C++11
+    static const bool initialized = initializePlugin();
+    (void)initialized;
     
     static OpenDRTFactory OpenDRT;
     p_FactoryArray.push_back(&OpenDRT);
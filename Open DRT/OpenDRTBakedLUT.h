@@ -0,0 +1,20 @@
+#pragma once
+
+// A 3D LUT of the full OpenDRT transform for one set of parameters, baked by
+// OpenDRTLUTBaker and applied by RunSIMDLUTRow(). Plain data only, like
+// OpenDRTRenderPlan.h: SimdKernel.cpp includes it from every instruction set build.
+
+enum OpenDRTLUTShaper
+{
+    kLUTShaperNone = 0,             // log input: code values index the LUT directly
+    kLUTShaperIntermediate = 1      // linear input: DaVinci Intermediate encoded first
+};
+
+struct OpenDRTBakedLUT
+{
+    int size;                       // grid points per axis
+    int shaper;                     // OpenDRTLUTShaper
+    float domainMin;                // shaper value at the first grid point
+    float domainScale;              // (size - 1)/(domainMax - domainMin)
+    const float* table;             // size^3 RGB triplets, red fastest
+};
@@ -0,0 +1,211 @@
+// OpenDRTBench.cpp
+// Accuracy and speed of the vectorized CPU kernel (make bench). Fast precision, with the
+// analytic tonescale and with the tables (hue tables and 64 or, the default, 256 nodes
+// per stop), is compared with Exact over a fixed input sweep for every look preset, input
+// curve, display gamut and encoding, and each is timed on one thread. It runs the instruction set the
+// dispatcher picks; make bench runs it once per set with OPENDRT_SIMD_ISA. Not part of the
+// bundle.
+//
+//   OpenDRTBench
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "OpenDRTParams.h"
+#include "OpenDRTRenderPlan.h"
+#include "OpenDRTSharedTables.h"
+#include "SimdKernel.h"
+#include "ofxsSupportPrivate.h"
+
+// The OFX support code takes these from the host; without one its thread helpers run
+// single threaded
+namespace OFX {
+namespace Private {
+OfxMultiThreadSuiteV1* gThreadSuite = 0;
+OfxMemorySuiteV1* gMemorySuite = 0;
+}
+}
+
+#define kSweepSteps 33              // lattice points per channel
+#define kSweepRamp 256              // neutral ramp after the lattice
+#define kTimedWidth 1920
+#define kTimedRows 270
+#define kTimedPasses 3
+#define kModes 3
+
+// Fast variants measured: tonescale table bits (0 analytic) and hue tables
+static const char* const kModeNames[kModes] = { "Fast, analytic tonescale", "Fast, 64 per stop", "Fast, 256 per stop" };
+static const int kModeTsTableBits[kModes] = { 0, 6, 8 };
+
+static const char* const kEotfNames[] = { "Linear", "Gamma 2.2", "Gamma 2.4", "Gamma 2.6", "PQ", "HLG" };
+static const char* const kOetfNames[] = { "Linear", "DaVinci Intermediate", "ACEScct" };
+static const int kOetfs[] = { 0, 1, 3 };
+
+/***************************************************
+ Input sweep
+--------------------------------------------------*/
+// Code value c in [-0.1, 1.2] per channel, on a lattice, then a neutral ramp. Log curves
+// take the code values as they are; linear input takes 2^(16c - 10) above 0 (2^-10 to 2^6
+// at c = 1, past 1.2 to 2^9) and c itself below, so both cover shadows to speculars.
+static float sweepValue(float c, bool linear)
+{
+    if (!linear || c <= 0.0f) return c;
+    return exp2f(16.0f*c - 10.0f);
+}
+
+static std::vector<float> makeSweep(bool linear)
+{
+    std::vector<float> rgba;
+    for (int r = 0; r < kSweepSteps; ++r) {
+        for (int g = 0; g < kSweepSteps; ++g) {
+            for (int b = 0; b < kSweepSteps; ++b) {
+                const float step = 1.3f/(kSweepSteps - 1);
+                rgba.push_back(sweepValue(-0.1f + r*step, linear));
+                rgba.push_back(sweepValue(-0.1f + g*step, linear));
+                rgba.push_back(sweepValue(-0.1f + b*step, linear));
+                rgba.push_back(1.0f);
+            }
+        }
+    }
+    for (int i = 0; i < kSweepRamp; ++i) {
+        const float v = sweepValue(-0.1f + 1.3f*i/(kSweepRamp - 1), linear);
+        rgba.insert(rgba.end(), { v, v, v, 1.0f });
+    }
+    return rgba;
+}
+
+/***************************************************
+ Accuracy
+--------------------------------------------------*/
+struct ErrorStats
+{
+    double maxError;
+    int nanMismatches;      // NaN on one side only: the scalar HLG encode of black and below
+    int look, oetf, gamut;  // where maxError was found
+};
+
+static void compare(const std::vector<float>& p_Exact, const std::vector<float>& p_Fast, int p_Look, int p_Oetf,
+                    int p_Gamut, ErrorStats& p_Stats)
+{
+    for (size_t i = 0; i < p_Exact.size(); ++i) {
+        if (i % 4 == 3) continue;
+        if (std::isnan(p_Exact[i]) || std::isnan(p_Fast[i])) {
+            if (std::isnan(p_Exact[i]) != std::isnan(p_Fast[i])) ++p_Stats.nanMismatches;
+            continue;
+        }
+        const double error = fabs((double)p_Exact[i] - (double)p_Fast[i]);
+        if (error > p_Stats.maxError) {
+            p_Stats.maxError = error;
+            p_Stats.look = p_Look;
+            p_Stats.oetf = p_Oetf;
+            p_Stats.gamut = p_Gamut;
+        }
+    }
+}
+
+static float displayPeak(int p_Eotf)
+{
+    return p_Eotf >= 4 ? 1000.0f : 100.0f;
+}
+
+static void runAccuracy()
+{
+    printf("Fast against Exact, max abs error in display-encoded output (%d^3 lattice + %d ramp):\n",
+           kSweepSteps, kSweepRamp);
+    ErrorStats overall[kModes] = {};
+    for (int eotf = 0; eotf < 6; ++eotf) {
+        ErrorStats stats[kModes] = {};
+        for (int o = 0; o < 3; ++o) {
+            const std::vector<float> input = makeSweep(kOetfs[o] == 0);
+            const int width = (int)input.size()/4;
+            std::vector<float> exact(input.size()), fast(input.size());
+            for (int look = 0; look < 4; ++look) {
+                for (int gamut = 0; gamut < 3; ++gamut) {
+                    OpenDRTParams p = presetParams(look, 0, 15, kOetfs[o], gamut, eotf, displayPeak(eotf));
+                    p.precision = kPrecisionExact;
+                    OpenDRTRenderPlan plan;
+                    buildRenderPlan(p, plan);
+                    RunSIMDKernelRow(width, 1, 0, width, 0, input.data(), exact.data(), plan);
+
+                    p.precision = kPrecisionFast;
+                    for (int mode = 0; mode < kModes; ++mode) {
+                        const int bits = kModeTsTableBits[mode];
+                        std::shared_ptr<const OpenDRTDerivedTables> tables =
+                            OpenDRTSharedTables::instance().getTables(p, bits, bits > 0, false);
+                        RunSIMDKernelRow(width, 1, 0, width, 0, input.data(), fast.data(), tables->plan);
+                        compare(exact, fast, look, o, gamut, stats[mode]);
+                    }
+                }
+            }
+        }
+        for (int mode = 0; mode < kModes; ++mode) {
+            printf("  %-10s %-26s %.2g (look %d, %s, display gamut %d)", kEotfNames[eotf], kModeNames[mode],
+                   stats[mode].maxError, stats[mode].look, kOetfNames[stats[mode].oetf], stats[mode].gamut);
+            if (stats[mode].nanMismatches) printf(", %d NaN mismatches", stats[mode].nanMismatches);
+            printf("\n");
+            if (stats[mode].maxError > overall[mode].maxError) overall[mode] = stats[mode];
+        }
+    }
+    for (int mode = 0; mode < kModes; ++mode) printf("  all        %-26s %.2g\n", kModeNames[mode], overall[mode].maxError);
+}
+
+/***************************************************
+ Speed
+--------------------------------------------------*/
+static double megapixelsPerSecond(const std::vector<float>& p_Input, const OpenDRTRenderPlan& p_Plan)
+{
+    // Best of kTimedPasses, as other processes can only slow a pass down
+    std::vector<float> output(p_Input.size());
+    RunSIMDKernelRow(kTimedWidth, 1, 0, kTimedWidth, 0, p_Input.data(), output.data(), p_Plan);
+    double best = 0.0;
+    for (int pass = 0; pass < kTimedPasses; ++pass) {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int y = 0; y < kTimedRows; ++y) {
+            RunSIMDKernelRow(kTimedWidth, kTimedRows, 0, kTimedWidth, y, p_Input.data(), output.data(), p_Plan);
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const double rate = (double)kTimedWidth*kTimedRows/seconds*1e-6;
+        if (rate > best) best = rate;
+    }
+    return best;
+}
+
+static void runSpeed()
+{
+    // A row of the lattice in a scattered order, so neighbouring pixels differ
+    const std::vector<float> sweep = makeSweep(false);
+    const int sweepPixels = (int)sweep.size()/4;
+    std::vector<float> input(4*kTimedWidth);
+    for (int x = 0; x < kTimedWidth; ++x) {
+        const int source = (int)(((long long)x*7919) % sweepPixels);
+        for (int c = 0; c < 4; ++c) input[4*x + c] = sweep[4*source + c];
+    }
+
+    printf("One thread, %dx%d, best of %d, DaVinci Wide Gamut Intermediate to Rec.709 gamma 2.4, Mpix/s:\n",
+           kTimedWidth, kTimedRows, kTimedPasses);
+    static const char* const kLooks[4] = { "Default", "Colorful", "Umbra", "Base" };
+    for (int look = 0; look < 4; ++look) {
+        OpenDRTParams p = presetParams(look, 0, 15, 1, 0, 2, 100.0f);
+        p.precision = kPrecisionExact;
+        OpenDRTRenderPlan exact;
+        buildRenderPlan(p, exact);
+        p.precision = kPrecisionFast;
+        printf("  %-9s Exact %5.1f", kLooks[look], megapixelsPerSecond(input, exact));
+        for (int mode = 0; mode < kModes; ++mode) {
+            const int bits = kModeTsTableBits[mode];
+            std::shared_ptr<const OpenDRTDerivedTables> tables =
+                OpenDRTSharedTables::instance().getTables(p, bits, bits > 0, false);
+            printf("   %s %5.1f", kModeNames[mode], megapixelsPerSecond(input, tables->plan));
+        }
+        printf("\n");
+    }
+}
+
+int main()
+{
+    printf("OpenDRTBench: CPU kernel using %s\n", getSIMDKernelISA());
+    runAccuracy();
+    runSpeed();
+    return 0;
+}
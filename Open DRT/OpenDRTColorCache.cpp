@@ -0,0 +1,18 @@
+// OpenDRTColorCache.cpp
+#include <cstring>
+#include "OpenDRTColorCache.h"
+
+void resetColorCache(OpenDRTColorCache& p_Cache)
+{
+    // No transfer function is 0xFFFFFFFF, so no key matches an empty slot
+    memset(p_Cache.keys, 0xFF, sizeof(p_Cache.keys));
+    p_Cache.backoff = 0;
+    memset(&p_Cache.stats, 0, sizeof(p_Cache.stats));
+}
+
+void mergeMemoStats(OpenDRTMemoStats& p_Stats, const OpenDRTMemoStats& p_Band)
+{
+    p_Stats.pixels += p_Band.pixels;
+    p_Stats.runHits += p_Band.runHits;
+    p_Stats.cacheHits += p_Band.cacheHits;
+}
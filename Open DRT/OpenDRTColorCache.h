@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+
+// Memoization for the CPU kernels. The transform is per pixel, its output a function of
+// the input RGB alone (alpha passes through; the patterns, overlay and dither are applied
+// around the kernel), so repeated colours need not be transformed again:
+// - a pixel bit-identical in RGB to the one before it takes that pixel's result: the runs
+//   of letterbox bars, slates, graphics and flat CG
+// - other pixels are looked up in a small direct-mapped cache of recent input RGB ->
+//   output RGB, keyed on the exact bits
+// Only the pixels left over are transformed, compacted into one kernel call per tile; a
+// pixel's lane then changes, so results match the uncached kernel to a few ULP.
+// Each render thread owns one cache for its band of rows, so entries never outlive the
+// render plan they were computed with.
+
+#define kColorCacheBits 10
+#define kColorCacheSize (1 << kColorCacheBits)
+
+// Tiles the cache sits out after a tile that found nothing in it
+#define kColorCacheBackoff 8
+
+// Reuse counters, for the render log
+struct OpenDRTMemoStats
+{
+    uint64_t pixels;
+    uint64_t runHits;      // pixels that repeated the pixel before
+    uint64_t cacheHits;    // pixels found in the cache
+};
+
+struct OpenDRTColorCache
+{
+    uint32_t keys[kColorCacheSize][4];  // input R, G, B bits and the input transfer function
+    float values[kColorCacheSize][3];   // display-encoded output RGB
+    int backoff;                        // tiles left before the cache is looked at again
+    OpenDRTMemoStats stats;
+};
+
+// Empties the cache and zeroes its counters
+void resetColorCache(OpenDRTColorCache& p_Cache);
+
+void mergeMemoStats(OpenDRTMemoStats& p_Stats, const OpenDRTMemoStats& p_Band);
+
+// Cache slot of an input colour; the transfer function is part of the key because pattern
+// rows and 16-bit table rows feed the kernel differently encoded values
+static inline int colorCacheSlot(const uint32_t p_Key[4])
+{
+    uint32_t h = p_Key[0]*0x9E3779B1u ^ p_Key[1]*0x85EBCA77u ^ p_Key[2]*0xC2B2AE3Du ^ p_Key[3];
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    return (int)(h >> (32 - kColorCacheBits));
+}
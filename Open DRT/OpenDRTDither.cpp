@@ -0,0 +1,156 @@
+// OpenDRTDither.cpp
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "OpenDRTDither.h"
+
+static const int kDitherCells = kDitherSize * kDitherSize;
+
+// Bayer matrix of size 8, tiled to kDitherSize
+static std::vector<float> makeOrdered()
+{
+    int bayer[8][8] = { { 0 } };
+    for (int n = 1; n < 8; n *= 2) {
+        for (int y = 0; y < n; ++y) {
+            for (int x = 0; x < n; ++x) {
+                const int v = 4*bayer[y][x];
+                bayer[y][x] = v;
+                bayer[y][x + n] = v + 2;
+                bayer[y + n][x] = v + 3;
+                bayer[y + n][x + n] = v + 1;
+            }
+        }
+    }
+    std::vector<float> m(kDitherCells);
+    for (int y = 0; y < kDitherSize; ++y) {
+        for (int x = 0; x < kDitherSize; ++x) m[y*kDitherSize + x] = (bayer[y & 7][x & 7] + 0.5f)/64.0f;
+    }
+    return m;
+}
+
+/***************************************************
+ Void and cluster (Ulichney 1993)
+--------------------------------------------------*/
+// Gaussian energy of a toroidal binary pattern, updated as cells are set and cleared
+class VoidAndCluster
+{
+public:
+    VoidAndCluster()
+        : m_Kernel(kDitherCells), m_Energy(kDitherCells, 0.0f), m_Set(kDitherCells, 0)
+    {
+        const float sigma = 1.5f;
+        for (int dy = 0; dy < kDitherSize; ++dy) {
+            for (int dx = 0; dx < kDitherSize; ++dx) {
+                const int wx = std::min(dx, kDitherSize - dx), wy = std::min(dy, kDitherSize - dy);
+                m_Kernel[dy*kDitherSize + dx] = expf(-(float)(wx*wx + wy*wy)/(2.0f*sigma*sigma));
+            }
+        }
+    }
+
+    bool isSet(int p_Cell) const { return m_Set[p_Cell] != 0; }
+
+    void toggle(int p_Cell)
+    {
+        const float sign = m_Set[p_Cell] ? -1.0f : 1.0f;
+        m_Set[p_Cell] = !m_Set[p_Cell];
+        const int cx = p_Cell % kDitherSize, cy = p_Cell / kDitherSize;
+        for (int y = 0; y < kDitherSize; ++y) {
+            const float* k = &m_Kernel[((y - cy + kDitherSize) % kDitherSize)*kDitherSize];
+            float* e = &m_Energy[y*kDitherSize];
+            for (int x = 0; x < kDitherSize; ++x) e[x] += sign*k[(x - cx + kDitherSize) % kDitherSize];
+        }
+    }
+
+    // Set cell with the highest energy
+    int tightestCluster() const
+    {
+        int best = -1;
+        for (int i = 0; i < kDitherCells; ++i) {
+            if (m_Set[i] && (best < 0 || m_Energy[i] > m_Energy[best])) best = i;
+        }
+        return best;
+    }
+
+    // Clear cell with the lowest energy
+    int largestVoid() const
+    {
+        int best = -1;
+        for (int i = 0; i < kDitherCells; ++i) {
+            if (!m_Set[i] && (best < 0 || m_Energy[i] < m_Energy[best])) best = i;
+        }
+        return best;
+    }
+
+private:
+    std::vector<float> m_Kernel;
+    std::vector<float> m_Energy;
+    std::vector<char> m_Set;
+};
+
+static std::vector<float> makeBlueNoise()
+{
+    // Initial pattern: a tenth of the cells at random, then moved from the tightest cluster
+    // to the largest void until that no longer changes anything
+    VoidAndCluster pattern;
+    uint32_t seed = 12345;
+    int ones = 0;
+    while (ones < kDitherCells/10) {
+        seed = seed*1664525u + 1013904223u;
+        const int cell = (int)(seed >> 20) % kDitherCells;
+        if (!pattern.isSet(cell)) {
+            pattern.toggle(cell);
+            ++ones;
+        }
+    }
+    for (;;) {
+        const int cluster = pattern.tightestCluster();
+        pattern.toggle(cluster);
+        const int gap = pattern.largestVoid();
+        if (gap == cluster) {
+            pattern.toggle(cluster);
+            break;
+        }
+        pattern.toggle(gap);
+    }
+
+    std::vector<int> rank(kDitherCells, 0);
+
+    // Ranks below the initial pattern: remove the tightest cluster
+    VoidAndCluster phase1 = pattern;
+    for (int r = ones - 1; r >= 0; --r) {
+        const int cell = phase1.tightestCluster();
+        phase1.toggle(cell);
+        rank[cell] = r;
+    }
+
+    // Ranks above it: fill the largest void. Past half the cells this is the tightest cluster
+    // of the inverted pattern, as the toroidal energies of a pattern and its inverse sum to a
+    // constant.
+    for (int r = ones; r < kDitherCells; ++r) {
+        const int cell = pattern.largestVoid();
+        pattern.toggle(cell);
+        rank[cell] = r;
+    }
+
+    std::vector<float> m(kDitherCells);
+    for (int i = 0; i < kDitherCells; ++i) m[i] = (rank[i] + 0.5f)/kDitherCells;
+    return m;
+}
+
+const float* getDitherMatrix(int p_Dither)
+{
+    // Function-local statics: built once, thread-safe under C++11
+    switch (p_Dither) {
+        case kDitherOrdered: {
+            static const std::vector<float> ordered = makeOrdered();
+            return &ordered[0];
+        }
+        case kDitherBlueNoise: {
+            static const std::vector<float> blueNoise = makeBlueNoise();
+            return &blueNoise[0];
+        }
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+// Integer output: quantization settings and the dither threshold matrices. Plain data and
+// declarations only, like OpenDRTBakedLUT.h: SimdKernel.cpp includes it from every
+// instruction set build.
+
+#define kDitherSize 64
+
+enum OpenDRTDither
+{
+    kDitherNone = 0,                // round to nearest
+    kDitherOrdered = 1,             // 8x8 Bayer matrix
+    kDitherBlueNoise = 2            // 64x64 void-and-cluster blue noise
+};
+
+// How the CPU kernel stores integer RGBA (OFX eBitDepthUShort, eBitDepthUByte). RGB is
+// quantized to codeBits after the display encode and dithered; alpha is rounded to the
+// container. Integer input is always read as full range.
+struct OpenDRTIntEncode
+{
+    int containerBits;              // 8 (UByte) or 16 (UShort)
+    int codeBits;                   // containerBits, or 10/12 bit-replicated into 16
+    int legalRange;                 // 1: video levels, black 16 and white 235 scaled to codeBits
+    const float* dither;            // kDitherSize^2 thresholds in (0, 1), row major; 0 rounds
+};
+
+// Thresholds for an OpenDRTDither mode, built on first use and kept for the process;
+// 0 for kDitherNone
+const float* getDitherMatrix(int p_Dither);
@@ -0,0 +1,169 @@
+// OpenDRTExportLUT.cpp
+// Command-line LUT export: the same .cube/CLF pair as the plugin's Export LUT button, for
+// a look preset and display setup given on the command line. Parameters not covered by
+// the options are at the plugin's defaults after the presets are applied. Several display
+// targets (--target) are baked in one pass that shares the scene side of the transform.
+//
+//   OpenDRTExportLUT [options] <output>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "OpenDRTParams.h"
+#include "OpenDRTPresets.h"
+#include "OpenDRTRenderPlan.h"
+#include "OpenDRTLUTExport.h"
+#include "ofxsSupportPrivate.h"
+
+using namespace OpenDRTPresets;
+
+// The OFX support code takes these from the host; without one its thread helpers run
+// single threaded
+namespace OFX {
+namespace Private {
+OfxMultiThreadSuiteV1* gThreadSuite = 0;
+OfxMemorySuiteV1* gMemorySuite = 0;
+}
+}
+
+struct ExportOptions
+{
+    int look, tonescale;
+    int inGamut, inOetf;
+    int displayGamut, eotf;
+    float peak;
+    int size;
+};
+
+struct ExportTarget
+{
+    int displayGamut, eotf;
+    float peak;
+};
+
+static const char* const kGamutNames[] = { "Rec709", "P3D65", "Rec2020" };
+static const char* const kEotfNames[] = { "Linear", "Gamma22", "Gamma24", "Gamma26", "PQ", "HLG" };
+
+static void usage()
+{
+    printf("usage: OpenDRTExportLUT [options] <output>\n"
+           "Writes <output>.cube and <output>.clf, with an Intermediate shaper for linear input\n"
+           "  --look N        look preset: 0 Default, 1 Colorful, 2 Umbra, 3 Base (0)\n"
+           "  --tonescale N   tonescale preset: 0 use look preset, 1-9 as in the plugin (0)\n"
+           "  --in-gamut N    input gamut, plugin menu index (15 DaVinci Wide Gamut)\n"
+           "  --in-oetf N     input transfer function: 0 Linear, 1 DaVinci Intermediate, ... (1)\n"
+           "  --gamut N       display gamut: 0 Rec.709, 1 P3-D65, 2 Rec.2020 (P3 limited) (0)\n"
+           "  --eotf N        display EOTF: 0 Linear, 1 2.2, 2 2.4, 3 2.6, 4 PQ, 5 HLG (2)\n"
+           "  --peak NITS     display peak luminance (100)\n"
+           "  --target G,E,NITS  display gamut, EOTF and peak of one of several deliverables,\n"
+           "                  written to <output>_<gamut>_<eotf>_<nits>; repeat for each one.\n"
+           "                  Replaces --gamut, --eotf and --peak\n"
+           "  --size N        3D LUT points per axis, 2-129 (33)\n");
+}
+
+static OpenDRTParams presetParams(const ExportOptions& p_Options)
+{
+    return presetParams(p_Options.look, p_Options.tonescale, p_Options.inGamut, p_Options.inOetf,
+                        p_Options.displayGamut, p_Options.eotf, p_Options.peak);
+}
+
+static bool parseInt(const char* p_Arg, int p_Min, int p_Max, int& p_Value)
+{
+    char* end;
+    const long v = strtol(p_Arg, &end, 10);
+    if (*end != '\0' || v < p_Min || v > p_Max) return false;
+    p_Value = (int)v;
+    return true;
+}
+
+static bool parsePeak(const char* p_Arg, float& p_Value)
+{
+    p_Value = (float)atof(p_Arg);
+    return p_Value >= 100.0f && p_Value <= 1000.0f;
+}
+
+// GAMUT,EOTF,NITS
+static bool parseTarget(const char* p_Arg, ExportTarget& p_Target)
+{
+    char gamut[16], eotf[16], peak[32];
+    if (sscanf(p_Arg, "%15[^,],%15[^,],%31s", gamut, eotf, peak) != 3) return false;
+    return parseInt(gamut, 0, 2, p_Target.displayGamut) && parseInt(eotf, 0, 5, p_Target.eotf) &&
+           parsePeak(peak, p_Target.peak);
+}
+
+int main(int argc, char** argv)
+{
+    ExportOptions options = { 0, 0, 15, 1, 0, 2, 100.0f, 33 };
+    std::vector<ExportTarget> targets;
+    const char* output = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : "";
+        bool ok = true;
+        if (strcmp(arg, "--look") == 0) ok = parseInt(value, 0, 3, options.look), ++i;
+        else if (strcmp(arg, "--tonescale") == 0) ok = parseInt(value, 0, 9, options.tonescale), ++i;
+        else if (strcmp(arg, "--in-gamut") == 0) ok = parseInt(value, 0, 15, options.inGamut), ++i;
+        else if (strcmp(arg, "--in-oetf") == 0) ok = parseInt(value, 0, 8, options.inOetf), ++i;
+        else if (strcmp(arg, "--gamut") == 0) ok = parseInt(value, 0, 2, options.displayGamut), ++i;
+        else if (strcmp(arg, "--eotf") == 0) ok = parseInt(value, 0, 5, options.eotf), ++i;
+        else if (strcmp(arg, "--size") == 0) ok = parseInt(value, 2, 129, options.size), ++i;
+        else if (strcmp(arg, "--peak") == 0) ok = parsePeak(value, options.peak), ++i;
+        else if (strcmp(arg, "--target") == 0) {
+            ExportTarget target;
+            ok = parseTarget(value, target);
+            targets.push_back(target);
+            ++i;
+        }
+        else if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            usage();
+            return 0;
+        }
+        else if (arg[0] != '-' && !output) output = arg;
+        else ok = false;
+
+        if (!ok) {
+            fprintf(stderr, "OpenDRTExportLUT: bad argument %s\n", arg);
+            usage();
+            return 2;
+        }
+    }
+    if (!output) {
+        usage();
+        return 2;
+    }
+
+    // Without --target, the one display setup of --gamut, --eotf and --peak to <output>
+    std::vector<std::string> paths;
+    if (targets.empty()) {
+        const ExportTarget target = { options.displayGamut, options.eotf, options.peak };
+        targets.push_back(target);
+        paths.push_back(output);
+    }
+    else {
+        for (const ExportTarget& target : targets) {
+            char suffix[64];
+            snprintf(suffix, sizeof(suffix), "_%s_%s_%g", kGamutNames[target.displayGamut], kEotfNames[target.eotf],
+                     target.peak);
+            paths.push_back(output + std::string(suffix));
+        }
+    }
+
+    std::vector<OpenDRTRenderPlan> plans(targets.size());
+    for (size_t j = 0; j < targets.size(); ++j) {
+        ExportOptions display = options;
+        display.displayGamut = targets[j].displayGamut;
+        display.eotf = targets[j].eotf;
+        display.peak = targets[j].peak;
+        buildRenderPlan(presetParams(display), plans[j]);
+    }
+
+    std::string error;
+    if (!exportLUTs(plans, options.size, paths, error)) {
+        fprintf(stderr, "OpenDRTExportLUT: %s\n", error.c_str());
+        return 1;
+    }
+    for (const std::string& path : paths) printf("Wrote %d^3 LUT as .cube and .clf: %s\n", options.size, path.c_str());
+    return 0;
+}
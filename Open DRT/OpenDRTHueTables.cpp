@@ -0,0 +1,80 @@
+// OpenDRTHueTables.cpp
+#include <cmath>
+#include <string>
+#include "OpenDRTHueTables.h"
+#include "ofxsLog.h"
+
+static const double kPi = 3.14159265358979323846;
+
+// Hue windows, as OpenDRTPixel() in OpenCLKernel.cpp
+static void hueWindows(double hue, double w[6])
+{
+    static const double offset[6] = { 0.1, 4.3, 2.3, 3.3, 1.3, -1.2 };
+    static const double width[6] = { 0.9, 0.9, 0.9, 0.6, 0.6, 0.6 };
+    for (int i = 0; i < 6; ++i) {
+        const double d = (fmod(hue - offset[i] + kPi, 2.0*kPi) - kPi)/width[i];
+        w[i] = exp(-d*d);
+    }
+}
+
+// Hue at pseudo-angle q in [0, 4], the inverse of hueTableStage() in SimdKernel.cpp. The
+// pseudo-angle is taken in opponent axes turned so that q = 0 is hue 0, where the windows
+// jump (the hue offsets wrap with a truncating fmod): the seam falls between the last node,
+// hue 2*pi, and the first.
+static double pseudoAngleHue(double q)
+{
+    const double p = q < 1.0 ? q : (q < 3.0 ? 2.0 - q : q - 4.0);
+    const double u = (q < 1.0 || q >= 3.0) ? 1.0 - fabs(p) : fabs(p) - 1.0;
+    const double a = atan2(p, u);
+    return q <= 2.0 ? a : a + 2.0*kPi;
+}
+
+static void weightedSums(const OpenDRTRenderPlan& p_Plan, double q, double p_Out[kHueChannels])
+{
+    double w[6];
+    hueWindows(pseudoAngleHue(q), w);
+    for (int c = 0; c < kHueChannels; ++c) {
+        double sum = 0.0;
+        for (int i = 0; i < 6; ++i) sum += p_Plan.hueWeights[c][i]*w[i];
+        p_Out[c] = sum;
+    }
+}
+
+OpenDRTHueTables::OpenDRTHueTables()
+    : m_MaxError(0.0f)
+{
+}
+
+void OpenDRTHueTables::build(OpenDRTRenderPlan& p_Plan)
+{
+    const int size = kHueTableSize + 2;
+    const double step = 4.0/kHueTableSize;
+    p_Plan.hueTable = 0;
+    m_MaxError = 0.0f;
+
+    // Nodes 0 to kHueTableSize, and a copy of the last so that q = 4 needs no clamp
+    m_Storage.resize(size * kHueChannels);
+    for (int j = 0; j <= kHueTableSize; ++j) {
+        double v[kHueChannels];
+        weightedSums(p_Plan, j*step, v);
+        for (int c = 0; c < kHueChannels; ++c) m_Storage[c * size + j] = (float)v[c];
+    }
+    for (int c = 0; c < kHueChannels; ++c) m_Storage[c * size + kHueTableSize + 1] = m_Storage[c * size + kHueTableSize];
+
+    // Check halfway between nodes, where linear interpolation is furthest off
+    for (int j = 0; j < kHueTableSize; ++j) {
+        double v[kHueChannels];
+        weightedSums(p_Plan, (j + 0.5)*step, v);
+        for (int c = 0; c < kHueChannels; ++c) {
+            const float* table = &m_Storage[c * size];
+            const float e = (float)fabs(0.5*(table[j] + table[j + 1]) - v[c]);
+            m_MaxError = e > m_MaxError ? e : m_MaxError;
+        }
+    }
+    if (!(m_MaxError <= kHueTableTolerance)) {
+        OFX::Log::print("OpenDRT: hue table off by %.2g, using the analytic hue windows\n", m_MaxError);
+        return;
+    }
+
+    p_Plan.hueTable = &m_Storage[0];
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "OpenDRTRenderPlan.h"
+
+// Hue tables: the six hue windows (gauss_window() around the R, G, B, C, M, Y anchors) are
+// fixed functions of hue, and brilliance, hue contrast and the hue shifts only use them
+// weighted by frame constants. The tables hold those weighted sums per OpenDRTHueChannel
+// (the plan's hueWeights), so the CPU kernel does a lookup per channel instead of an
+// atan2f(), six expf() and the weighting per pixel. The AVX-512 kernel ignores them: its
+// 16-wide windows are faster than the scalar table loads (see SimdKernel.cpp).
+//
+// The index is not the hue angle but a pseudo-angle of the opponent vector: v/(|u| + |v|),
+// unfolded over the four quadrants to [0, 4], with (u, v) the vector (gm, cy) turned so
+// that hue 0 lies on u. It is monotonic in the angle and needs one division, no trig.
+// Nodes are placed at the true angles, so the only error is the linear interpolation
+// between them; the windows' jump at hue 0 falls between the last node and the first.
+//
+// Every build is checked against the analytic windows halfway between nodes; tables off by
+// more than kHueTableTolerance (absolute, on the weighted sums) are dropped and the frame
+// runs analytically. Measured worst case over the look and tonescale presets: 8.5e-6
+// (3.4e-5 with 1024 intervals, which left 1.7e-4 on the PQ output against Exact; 2048 keep
+// Fast within 5e-5, see OpenDRTBench).
+
+#define kHueTableTolerance (1.0f/4096.0f)
+
+class OpenDRTHueTables
+{
+public:
+    OpenDRTHueTables();
+
+    // Builds the tables for the plan's hue weights and points the plan at them. The plan
+    // must not outlive this object.
+    void build(OpenDRTRenderPlan& p_Plan);
+
+    // Largest absolute error against the analytic windows measured by the last build
+    float getMaxError() const { return m_MaxError; }
+
+    // Bytes of table storage, for the shared cache budget (OpenDRTSharedTables.h)
+    size_t getBytes() const { return m_Storage.size()*sizeof(float); }
+
+private:
+    std::vector<float> m_Storage;
+    float m_MaxError;
+};
@@ -0,0 +1,18 @@
+// OpenDRTInputTable.cpp
+#include "OpenDRTInputTable.h"
+
+// Input transfer functions of the scalar kernel (OpenCLKernel.cpp)
+extern float apply_oetf(float x, int type);
+
+void OpenDRTInputTable::build(OpenDRTRenderPlan& p_Plan)
+{
+    p_Plan.inputTable = 0;
+    const int tf = p_Plan.params.inOetf;
+    if (tf == 0) return;
+
+    m_Storage.resize(kInputTableSize);
+    for (int i = 0; i < kInputTableSize; ++i) {
+        m_Storage[i] = apply_oetf((float)i/(float)(kInputTableSize - 1), tf);
+    }
+    p_Plan.inputTable = &m_Storage[0];
+}
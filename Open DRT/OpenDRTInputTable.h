@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "OpenDRTRenderPlan.h"
+
+// Input table: 16-bit integer input has only kInputTableSize distinct code values, so the
+// input transfer function (inOetf) is decoded once per code and the CPU kernel looks the
+// linear value up instead of running an exp2f()/powf() per channel. The table holds the
+// scalar kernel's apply_oetf() of each code, so table lookups match OpenDRTPixel() on that
+// input exactly. Float input keeps the analytic curves.
+
+class OpenDRTInputTable
+{
+public:
+    // Builds the table for the plan's inOetf and points the plan at it; a linear inOetf
+    // needs no table. The plan must not outlive this object.
+    void build(OpenDRTRenderPlan& p_Plan);
+
+    // Bytes of table storage, for the shared cache budget (OpenDRTSharedTables.h)
+    size_t getBytes() const { return m_Storage.size()*sizeof(float); }
+
+private:
+    std::vector<float> m_Storage;
+};
@@ -0,0 +1,294 @@
+// OpenDRTLUTBaker.cpp
+#include <cmath>
+#include <cstring>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include "OpenDRTLUTBaker.h"
+#include "SimdKernel.h"
+#include "OpenDRTSharedTables.h"
+#include "OpenDRTTileCache.h"
+#include "ofxsLog.h"
+#include "ofxsMultiThread.h"
+
+// Every size is a subgrid of the largest, so the transform is sampled once
+static const int kLUTSizes[] = { 33, 65, 129 };
+static const int kLUTMaxSize = 129;
+static const int kValidationSamples = 8192;
+
+// LUT plus the storage its table points into
+struct BakedLUTData
+{
+    OpenDRTBakedLUT lut;
+    std::vector<float> table;
+};
+
+// DaVinci Intermediate decode: shaper value back to the linear input it stands for
+static float shaperDecode(float x)
+{
+    return x <= 0.02740668f ? x/10.44426855f : exp2f(x/0.07329248f - 7.0f) - 0.0075f;
+}
+
+/***************************************************
+ Baking
+--------------------------------------------------*/
+// Samples the transform on the grid, one blue plane at a time on the host's threads. With
+// the shaper the grid values are Intermediate code values, so the samples come from the
+// same transform with the input curve switched over. Several display targets are sampled
+// together, sharing the scene side where their plans allow (RunSIMDKernelRowTargets());
+// their LUTs all have the geometry of the first.
+class LUTSampler : public OFX::MultiThread::Processor
+{
+public:
+    LUTSampler(const std::vector<OpenDRTRenderPlan>& p_Plans, const std::vector<BakedLUTData*>& p_Data)
+        : _plans(p_Plans)
+        , _data(p_Data)
+    {
+        const size_t size = p_Data[0]->lut.size;
+        for (size_t j = 0; j < _plans.size(); ++j) {
+            if (p_Data[0]->lut.shaper == kLUTShaperIntermediate) {
+                OpenDRTParams params = p_Plans[j].params;
+                params.inOetf = 1;
+                buildRenderPlan(params, _plans[j]);
+            }
+            p_Data[j]->table.resize(size * size * size * 3);
+            p_Data[j]->lut.table = p_Data[j]->table.data();
+        }
+    }
+
+    virtual void multiThreadFunction(unsigned int p_ThreadID, unsigned int p_NThreads)
+    {
+        const OpenDRTBakedLUT& lut = _data[0]->lut;
+        const int size = lut.size, targets = (int)_plans.size();
+        const float step = 1.0f / lut.domainScale;
+        std::vector<float> in(size * 4), out(targets * size * 4);
+        std::vector<const OpenDRTRenderPlan*> plans(targets);
+        std::vector<float*> outputs(targets);
+        for (int j = 0; j < targets; ++j) {
+            plans[j] = &_plans[j];
+            outputs[j] = &out[j * size * 4];
+        }
+        for (int b = p_ThreadID; b < size; b += p_NThreads) {
+            for (int g = 0; g < size; ++g) {
+                for (int r = 0; r < size; ++r) {
+                    in[r * 4] = lut.domainMin + r * step;
+                    in[r * 4 + 1] = lut.domainMin + g * step;
+                    in[r * 4 + 2] = lut.domainMin + b * step;
+                    in[r * 4 + 3] = 1.0f;
+                }
+                RunSIMDKernelRowTargets(size, size, 0, size, 0, in.data(), targets, plans.data(), outputs.data());
+                for (int j = 0; j < targets; ++j) {
+                    float* dst = &_data[j]->table[((size_t)b * size + g) * size * 3];
+                    for (int r = 0; r < size; ++r) {
+                        dst[r * 3] = outputs[j][r * 4];
+                        dst[r * 3 + 1] = outputs[j][r * 4 + 1];
+                        dst[r * 3 + 2] = outputs[j][r * 4 + 2];
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    std::vector<OpenDRTRenderPlan> _plans;
+    std::vector<BakedLUTData*> _data;
+};
+
+// Every step-th grid point of p_Full along each axis
+static void subsampleLUT(const BakedLUTData& p_Full, int p_Size, BakedLUTData& p_Data)
+{
+    const int full = p_Full.lut.size, step = (full - 1) / (p_Size - 1);
+    p_Data.lut = p_Full.lut;
+    p_Data.lut.size = p_Size;
+    p_Data.lut.domainScale = p_Full.lut.domainScale / step;
+    p_Data.table.resize((size_t)p_Size * p_Size * p_Size * 3);
+    float* dst = p_Data.table.data();
+    for (int b = 0; b < p_Size; ++b) {
+        for (int g = 0; g < p_Size; ++g) {
+            for (int r = 0; r < p_Size; ++r) {
+                const float* src = &p_Full.table[(((size_t)b * step * full + g * step) * full + r * step) * 3];
+                *dst++ = src[0];
+                *dst++ = src[1];
+                *dst++ = src[2];
+            }
+        }
+    }
+    p_Data.lut.table = p_Data.table.data();
+}
+
+// Validation set in the plugin's input space: a neutral ramp plus pseudo-random colours
+// spread over the LUT domain
+static void validationInput(const OpenDRTBakedLUT& p_LUT, std::vector<float>& p_Input)
+{
+    const float domainMax = p_LUT.domainMin + (p_LUT.size - 1) / p_LUT.domainScale;
+    const float range = domainMax - p_LUT.domainMin;
+    p_Input.resize(kValidationSamples * 4);
+    uint32_t state = 0x9e3779b9u;
+    for (int i = 0; i < kValidationSamples; ++i) {
+        float v[3];
+        for (int c = 0; c < 3; ++c) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            v[c] = i < 256 ? (float)i / 255.0f : (float)(state >> 8) / 16777216.0f;
+            v[c] = p_LUT.domainMin + v[c] * range;
+            if (p_LUT.shaper == kLUTShaperIntermediate) v[c] = shaperDecode(v[c]);
+        }
+        p_Input[i * 4] = v[0];
+        p_Input[i * 4 + 1] = v[1];
+        p_Input[i * 4 + 2] = v[2];
+        p_Input[i * 4 + 3] = 1.0f;
+    }
+}
+
+// Channel errors against the analytic kernel, in display code values
+struct LUTError
+{
+    float max, p99, mean;
+};
+
+static LUTError measureError(const OpenDRTRenderPlan& p_Plan, const OpenDRTBakedLUT& p_LUT)
+{
+    std::vector<float> in, ref(kValidationSamples * 4), out(kValidationSamples * 4);
+    validationInput(p_LUT, in);
+    RunSIMDKernelRow(kValidationSamples, 1, 0, kValidationSamples, 0, in.data(), ref.data(), p_Plan);
+    RunSIMDLUTRow(0, kValidationSamples, in.data(), out.data(), p_LUT);
+
+    std::vector<float> errors;
+    errors.reserve(kValidationSamples * 3);
+    double sum = 0.0;
+    for (int i = 0; i < kValidationSamples * 4; ++i) {
+        if ((i & 3) == 3 || !std::isfinite(ref[i])) continue;
+        const float e = std::isfinite(out[i]) ? fabsf(ref[i] - out[i]) : 1.0f;
+        errors.push_back(e);
+        sum += e;
+    }
+
+    LUTError error = { 0.0f, 0.0f, 0.0f };
+    if (!errors.empty()) {
+        std::sort(errors.begin(), errors.end());
+        error.max = errors.back();
+        error.p99 = errors[errors.size() * 99 / 100];
+        error.mean = (float)(sum / errors.size());
+    }
+    return error;
+}
+
+// Shaper and domain follow the input curve: code values of a log input span [0, 1];
+// linear input is encoded to Intermediate, with headroom below 0 for negative values.
+// One LUT per plan; the plans share the first one's input curve.
+static std::vector<std::shared_ptr<BakedLUTData>> sampleLUTs(const std::vector<OpenDRTRenderPlan>& p_Plans, int p_Size)
+{
+    const bool shaper = p_Plans[0].params.inOetf == 0;
+    const float domainMin = shaper ? -0.0625f : 0.0f;
+
+    std::vector<std::shared_ptr<BakedLUTData>> data(p_Plans.size());
+    std::vector<BakedLUTData*> tables(p_Plans.size());
+    for (size_t j = 0; j < p_Plans.size(); ++j) {
+        data[j] = std::make_shared<BakedLUTData>();
+        data[j]->lut.size = p_Size;
+        data[j]->lut.shaper = shaper ? kLUTShaperIntermediate : kLUTShaperNone;
+        data[j]->lut.domainMin = domainMin;
+        data[j]->lut.domainScale = (float)(p_Size - 1) / (1.0f - domainMin);
+        tables[j] = data[j].get();
+    }
+    LUTSampler sampler(p_Plans, tables);
+    sampler.multiThread();
+    return data;
+}
+
+static std::shared_ptr<BakedLUTData> sampleLUT(const OpenDRTRenderPlan& p_Plan, int p_Size)
+{
+    return sampleLUTs(std::vector<OpenDRTRenderPlan>(1, p_Plan), p_Size)[0];
+}
+
+static std::shared_ptr<BakedLUTData> bakeLUT(const OpenDRTRenderPlan& p_Plan)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<BakedLUTData> full = sampleLUT(p_Plan, kLUTMaxSize);
+
+    std::shared_ptr<BakedLUTData> data;
+    LUTError error;
+    for (int size : kLUTSizes) {
+        if (size == kLUTMaxSize) {
+            data = full;
+        } else {
+            data = std::make_shared<BakedLUTData>();
+            subsampleLUT(*full, size, *data);
+        }
+        error = measureError(p_Plan, data->lut);
+        if (error.p99 <= kLUTTargetError) break;
+    }
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    OFX::Log::print("OpenDRT: baked %d^3 LUT (%s shaper, %.0f KB) in %.1f ms, error max %.2g p99 %.2g mean %.2g\n",
+                    data->lut.size, data->lut.shaper == kLUTShaperIntermediate ? "Intermediate" : "no",
+                    data->table.size() * sizeof(float) / 1024.0, ms, error.max, error.p99, error.mean);
+
+    // Even the largest grid misses the target: keep an empty entry, so that the parameters
+    // are not baked again, and render through the analytic kernel
+    if (error.p99 > kLUTTargetError) {
+        OFX::Log::print("OpenDRT: baked LUT outside the target error, rendering through the kernel\n");
+        data->table.clear();
+        data->table.shrink_to_fit();
+        data->lut.table = nullptr;
+    }
+    return data;
+}
+
+/***************************************************
+ OpenDRTLUTBaker
+--------------------------------------------------*/
+OpenDRTLUTBaker::OpenDRTLUTBaker()
+    : m_Hash(0)
+{
+}
+
+bool OpenDRTLUTBaker::canBake(const OpenDRTParams& p_Params)
+{
+    return p_Params.diagnosticsMode == 0 && p_Params.rgbChipsMode == 0 && p_Params.tonescaleMap == 0;
+}
+
+std::shared_ptr<const OpenDRTBakedLUT> OpenDRTLUTBaker::bake(const OpenDRTRenderPlan& p_Plan, int p_Size)
+{
+    if (!canBake(p_Plan.params)) return nullptr;
+
+    std::shared_ptr<BakedLUTData> data = sampleLUT(p_Plan, p_Size);
+    return std::shared_ptr<const OpenDRTBakedLUT>(data, &data->lut);
+}
+
+std::vector<std::shared_ptr<const OpenDRTBakedLUT>> OpenDRTLUTBaker::bake(const std::vector<OpenDRTRenderPlan>& p_Plans,
+                                                                         int p_Size)
+{
+    std::vector<std::shared_ptr<const OpenDRTBakedLUT>> luts;
+    if (p_Plans.empty()) return luts;
+    for (const OpenDRTRenderPlan& plan : p_Plans) {
+        if (!canBake(plan.params) || plan.params.inOetf != p_Plans[0].params.inOetf) return luts;
+    }
+
+    for (const std::shared_ptr<BakedLUTData>& data : sampleLUTs(p_Plans, p_Size)) {
+        luts.push_back(std::shared_ptr<const OpenDRTBakedLUT>(data, &data->lut));
+    }
+    return luts;
+}
+
+std::shared_ptr<const OpenDRTBakedLUT> OpenDRTLUTBaker::getLUT(const OpenDRTRenderPlan& p_Plan)
+{
+    if (!canBake(p_Plan.params)) return nullptr;
+
+    // The whole struct, which has no padding (see the static_asserts in OpenDRTParams.h)
+    const uint64_t hash = hashBytes(&p_Plan.params, sizeof(p_Plan.params), 0);
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!m_LUT || hash != m_Hash) {
+        // Other instances with the same parameters share the LUT
+        std::shared_ptr<const void> data = OpenDRTSharedTables::instance().get(kSharedBakedLUT, hash, [&](size_t& p_Bytes) {
+            std::shared_ptr<BakedLUTData> baked = bakeLUT(p_Plan);
+            p_Bytes = sizeof(BakedLUTData) + baked->table.size()*sizeof(float);
+            return std::shared_ptr<const void>(baked);
+        });
+        const BakedLUTData* baked = static_cast<const BakedLUTData*>(data.get());
+        m_LUT = baked->lut.table ? std::shared_ptr<const OpenDRTBakedLUT>(data, &baked->lut) : nullptr;
+        m_Hash = hash;
+    }
+    return m_LUT;
+}
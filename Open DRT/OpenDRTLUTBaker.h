@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "OpenDRTBakedLUT.h"
+#include "OpenDRTRenderPlan.h"
+
+// Baked render mode: samples the transform for the current parameters into a 3D LUT and
+// renders through the LUT instead of the analytic kernel. The grid is 33, 65 or 129
+// points per axis, the smallest whose 99th percentile error against the analytic kernel
+// on a fixed validation set is within kLUTTargetError, in display code values. If none is,
+// there is no LUT and the analytic kernel renders: the SDR encodings bake at 129 (p99 0.5
+// to 1.6 code values for the presets), PQ and HLG miss it at 1.8 to 2.7. The maximum is not
+// used: it sits on the gamut boundary clamp, which no grid size resolves. Log inputs index
+// the LUT by code value; linear input goes through a DaVinci Intermediate shaper.
+//
+// One baker lives in each effect instance and keeps the last LUT: it is looked up again
+// only when the hash of the parameters changes, in the process-wide OpenDRTSharedTables,
+// so instances with the same parameters bake it once between them. Frames using the diagnostics patterns or the
+// tonescale overlay depend on pixel position and cannot be baked.
+
+#define kLUTTargetError (2.0f/1023.0f)     // two 10-bit code values
+
+class OpenDRTLUTBaker
+{
+public:
+    OpenDRTLUTBaker();
+
+    static bool canBake(const OpenDRTParams& p_Params);
+
+    // Uncached LUT of exactly p_Size points per axis (LUT export), or null if the
+    // parameters cannot be baked
+    static std::shared_ptr<const OpenDRTBakedLUT> bake(const OpenDRTRenderPlan& p_Plan, int p_Size);
+
+    // The same for several display targets of one input curve, sampled in one pass that
+    // shares the scene side of plans with the same look (sameSceneSide()). Empty if any
+    // plan cannot be baked or the input curves differ.
+    static std::vector<std::shared_ptr<const OpenDRTBakedLUT>> bake(const std::vector<OpenDRTRenderPlan>& p_Plans,
+                                                                    int p_Size);
+
+    // LUT for the plan's parameters, or null if they cannot be baked or no grid size is
+    // within kLUTTargetError. Thread-safe; the LUT stays alive while the caller holds the
+    // pointer even if another render rebakes.
+    std::shared_ptr<const OpenDRTBakedLUT> getLUT(const OpenDRTRenderPlan& p_Plan);
+
+private:
+    std::mutex m_Mutex;
+    uint64_t m_Hash;
+    std::shared_ptr<const OpenDRTBakedLUT> m_LUT;
+};
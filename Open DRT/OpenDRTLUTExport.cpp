@@ -0,0 +1,171 @@
+// OpenDRTLUTExport.cpp
+#include <cmath>
+#include <cstdio>
+#include "OpenDRTLUTExport.h"
+#include "OpenDRTLUTBaker.h"
+
+// DaVinci Intermediate, in double so the shaper table is exact to the last float
+static double intermediateEncode(double x)
+{
+    return x <= 0.00262409 ? x*10.44426855 : (log2(x + 0.0075) + 7.0)*0.07329248;
+}
+
+static double intermediateDecode(double y)
+{
+    return y <= 0.02740668 ? y/10.44426855 : exp2(y/0.07329248 - 7.0) - 0.0075;
+}
+
+static float finiteOrZero(float x)
+{
+    return std::isfinite(x) ? x : 0.0f;
+}
+
+static double domainMax(const OpenDRTBakedLUT& p_LUT)
+{
+    return p_LUT.domainMin + (p_LUT.size - 1) / (double)p_LUT.domainScale;
+}
+
+/***************************************************
+ .cube
+--------------------------------------------------*/
+bool writeCubeLUT(const std::string& p_Path, const std::string& p_Title, const OpenDRTBakedLUT& p_LUT)
+{
+    FILE* file = fopen(p_Path.c_str(), "w");
+    if (!file) return false;
+
+    const bool shaper = p_LUT.shaper == kLUTShaperIntermediate;
+    const double lo = p_LUT.domainMin, hi = domainMax(p_LUT);
+
+    fprintf(file, "TITLE \"%s\"\n", p_Title.c_str());
+    fprintf(file, "# OpenDRT, %s input\n", shaper ? "scene-linear" : "log encoded");
+    if (shaper) {
+        fprintf(file, "LUT_1D_SIZE %d\n", kLUTExportShaperSize);
+        fprintf(file, "LUT_1D_INPUT_RANGE %.9g %.9g\n", intermediateDecode(lo), intermediateDecode(hi));
+    }
+    fprintf(file, "LUT_3D_SIZE %d\n", p_LUT.size);
+    fprintf(file, "LUT_3D_INPUT_RANGE 0 1\n");
+
+    // Shaper: linear input -> Intermediate -> grid domain scaled to [0, 1]
+    if (shaper) {
+        const double x0 = intermediateDecode(lo), x1 = intermediateDecode(hi);
+        for (int i = 0; i < kLUTExportShaperSize; ++i) {
+            const double x = x0 + (x1 - x0) * i / (kLUTExportShaperSize - 1);
+            const double v = (intermediateEncode(x) - lo) / (hi - lo);
+            fprintf(file, "%.6f %.6f %.6f\n", v, v, v);
+        }
+    }
+
+    // Red fastest, like the baked table
+    const size_t count = (size_t)p_LUT.size * p_LUT.size * p_LUT.size;
+    for (size_t i = 0; i < count; ++i) {
+        const float* rgb = &p_LUT.table[i * 3];
+        fprintf(file, "%.6f %.6f %.6f\n", finiteOrZero(rgb[0]), finiteOrZero(rgb[1]), finiteOrZero(rgb[2]));
+    }
+
+    return fclose(file) == 0;
+}
+
+/***************************************************
+ CLF
+--------------------------------------------------*/
+bool writeCLF(const std::string& p_Path, const std::string& p_Title, const OpenDRTBakedLUT& p_LUT)
+{
+    FILE* file = fopen(p_Path.c_str(), "w");
+    if (!file) return false;
+
+    const bool shaper = p_LUT.shaper == kLUTShaperIntermediate;
+    const int size = p_LUT.size;
+
+    fprintf(file, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    fprintf(file, "<ProcessList id=\"%s\" name=\"%s\" compCLFversion=\"3.0\">\n", p_Title.c_str(), p_Title.c_str());
+    fprintf(file, "    <Description>OpenDRT</Description>\n");
+    fprintf(file, "    <InputDescriptor>%s</InputDescriptor>\n", shaper ? "Scene-linear" : "Log encoded");
+    fprintf(file, "    <OutputDescriptor>Display encoded</OutputDescriptor>\n");
+
+    if (shaper) {
+        // Intermediate: 0.07329248*(log2(x + 0.0075) + 7), linear 10.44426855*x below the break
+        fprintf(file, "    <Log inBitDepth=\"32f\" outBitDepth=\"32f\" style=\"cameraLinToLog\">\n");
+        fprintf(file, "        <LogParams base=\"2\" logSideSlope=\"0.07329248\" logSideOffset=\"0.51304736\""
+                      " linSideSlope=\"1\" linSideOffset=\"0.0075\" linSideBreak=\"0.00262409\" linearSlope=\"10.44426855\"/>\n");
+        fprintf(file, "    </Log>\n");
+        fprintf(file, "    <Range inBitDepth=\"32f\" outBitDepth=\"32f\">\n");
+        fprintf(file, "        <minInValue>%.7g</minInValue>\n", (double)p_LUT.domainMin);
+        fprintf(file, "        <maxInValue>%.7g</maxInValue>\n", domainMax(p_LUT));
+        fprintf(file, "        <minOutValue>0</minOutValue>\n");
+        fprintf(file, "        <maxOutValue>1</maxOutValue>\n");
+        fprintf(file, "    </Range>\n");
+    }
+
+    // CLF orders the array with blue fastest
+    fprintf(file, "    <LUT3D inBitDepth=\"32f\" outBitDepth=\"32f\" interpolation=\"tetrahedral\">\n");
+    fprintf(file, "        <Array dim=\"%d %d %d 3\">\n", size, size, size);
+    for (int r = 0; r < size; ++r) {
+        for (int g = 0; g < size; ++g) {
+            for (int b = 0; b < size; ++b) {
+                const float* rgb = &p_LUT.table[(((size_t)b * size + g) * size + r) * 3];
+                fprintf(file, "%.6f %.6f %.6f\n", finiteOrZero(rgb[0]), finiteOrZero(rgb[1]), finiteOrZero(rgb[2]));
+            }
+        }
+    }
+    fprintf(file, "        </Array>\n");
+    fprintf(file, "    </LUT3D>\n");
+    fprintf(file, "</ProcessList>\n");
+
+    return fclose(file) == 0;
+}
+
+/***************************************************
+ Export
+--------------------------------------------------*/
+// Base path without a .cube or .clf extension, and the title: the file name without it
+static bool exportBase(const std::string& p_Path, std::string& p_Base, std::string& p_Title, std::string& p_Error)
+{
+    p_Base = p_Path;
+    const size_t dot = p_Base.find_last_of('.');
+    if (dot != std::string::npos && (p_Base.compare(dot, std::string::npos, ".cube") == 0 ||
+                                     p_Base.compare(dot, std::string::npos, ".clf") == 0)) {
+        p_Base.erase(dot);
+    }
+    const size_t slash = p_Base.find_last_of("/\\");
+    p_Title = slash == std::string::npos ? p_Base : p_Base.substr(slash + 1);
+    for (char& c : p_Title) {
+        if (c == '"' || c == '&' || c == '<' || c == '>') c = '_';     // quoted in .cube, XML in CLF
+    }
+    if (p_Title.empty()) {
+        p_Error = "No LUT file name given";
+        return false;
+    }
+    return true;
+}
+
+bool exportLUTs(const std::vector<OpenDRTRenderPlan>& p_Plans, int p_Size, const std::vector<std::string>& p_Paths,
+                std::string& p_Error)
+{
+    std::vector<std::string> bases(p_Paths.size()), titles(p_Paths.size());
+    for (size_t j = 0; j < p_Paths.size(); ++j) {
+        if (!exportBase(p_Paths[j], bases[j], titles[j], p_Error)) return false;
+    }
+
+    const std::vector<std::shared_ptr<const OpenDRTBakedLUT>> luts = OpenDRTLUTBaker::bake(p_Plans, p_Size);
+    if (luts.size() != p_Plans.size() || luts.size() != p_Paths.size()) {
+        p_Error = "The diagnostics patterns and tonescale curve cannot be exported as a LUT";
+        return false;
+    }
+
+    for (size_t j = 0; j < luts.size(); ++j) {
+        if (!writeCubeLUT(bases[j] + ".cube", titles[j], *luts[j])) {
+            p_Error = "Could not write " + bases[j] + ".cube";
+            return false;
+        }
+        if (!writeCLF(bases[j] + ".clf", titles[j], *luts[j])) {
+            p_Error = "Could not write " + bases[j] + ".clf";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool exportLUT(const OpenDRTRenderPlan& p_Plan, int p_Size, const std::string& p_Path, std::string& p_Error)
+{
+    return exportLUTs(std::vector<OpenDRTRenderPlan>(1, p_Plan), p_Size, std::vector<std::string>(1, p_Path), p_Error);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "OpenDRTBakedLUT.h"
+#include "OpenDRTRenderPlan.h"
+
+// LUT export, for playback hardware and applications that cannot run the plugin. The
+// transform is baked at the requested size (OpenDRTLUTBaker::bake) and written twice:
+//
+//   <base>.cube  1D shaper + 3D LUT in one file (Resolve layout). Linear input gets a
+//                65536-point DaVinci Intermediate shaper: a 1D table is indexed linearly,
+//                and fewer points leave more than one 10-bit code value of error near
+//                black. Log inputs index the 3D LUT by code value and have no 1D part.
+//   <base>.clf   Common LUT Format 3.0: the same shaper as an exact Log node and a Range
+//                onto the grid domain, then a tetrahedral LUT3D.
+//
+// p_Path may name either file or the base without extension. Returns false with a
+// message in p_Error if the parameters cannot be baked or a file cannot be written.
+
+#define kLUTExportShaperSize 65536
+
+bool exportLUT(const OpenDRTRenderPlan& p_Plan, int p_Size, const std::string& p_Path, std::string& p_Error);
+
+// One LUT pair per plan, to p_Paths[j], for several deliverables of the same look and input
+// curve (say Rec.709 100 nits and P3 PQ 1000 nits): the targets are sampled in one pass
+// that shares their scene side (OpenDRTLUTBaker::bake).
+bool exportLUTs(const std::vector<OpenDRTRenderPlan>& p_Plans, int p_Size, const std::vector<std::string>& p_Paths,
+                std::string& p_Error);
+
+bool writeCubeLUT(const std::string& p_Path, const std::string& p_Title, const OpenDRTBakedLUT& p_LUT);
+bool writeCLF(const std::string& p_Path, const std::string& p_Title, const OpenDRTBakedLUT& p_LUT);
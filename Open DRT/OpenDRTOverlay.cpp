@@ -0,0 +1,98 @@
+// OpenDRTOverlay.cpp
+#include <algorithm>
+#include <cmath>
+#include "OpenDRTOverlay.h"
+
+// Overlay curve of one column, from the scalar kernel (OpenCLKernel.cpp)
+extern void OpenDRTOverlayColumn(int p_X, int p_Width, const OpenDRTRenderPlan& plan, float p_Out[3]);
+
+/***************************************************
+ Test patterns
+--------------------------------------------------*/
+// Diagnostics ramp over the first 100 rows, or the RGB chips over the frame, as the GPU
+// kernels draw them
+void fillTestPattern(int p_Width, int p_Height, int p_X1, int p_X2, int p_Y,
+                     const float* p_Input, float* p_Output, const OpenDRTParams& p_Params)
+{
+    static const float bands[7][3] = {
+        {1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {0, 1, 1}, {0, 0, 1}, {1, 0, 1}, {1, 1, 1}
+    };
+    const float white[3] = { 1, 1, 1 };
+    const int band = p_Y*7/p_Height;
+    const float* w = p_Params.rgbChipsMode == 1 ? bands[band >= 0 && band < 7 ? band : 6] : white;
+
+    for (int x = p_X1; x < p_X2; ++x) {
+        const float ramp = (float)x/(float)(p_Width - 1);
+        p_Output[0] = ramp*w[0];
+        p_Output[1] = ramp*w[1];
+        p_Output[2] = ramp*w[2];
+        p_Output[3] = p_Input[3];
+        p_Input += 4;
+        p_Output += 4;
+    }
+}
+
+/***************************************************
+ Tonescale overlay
+--------------------------------------------------*/
+void compositeOverlay(const OpenDRTOverlayCurve& p_Curve, int p_X1, int p_X2, int p_Y, float* p_RGBA)
+{
+    const float y = (float)p_Y;
+    const float crv_lm = p_Curve.strength;
+    for (int band = p_X1/kOverlayBand; band*kOverlayBand < p_X2; ++band) {
+        if (p_Y < p_Curve.bandRows[2*band] || p_Y > p_Curve.bandRows[2*band + 1]) continue;
+
+        const int x1 = std::max(p_X1, band*kOverlayBand);
+        const int x2 = std::min(p_X2, (band + 1)*kOverlayBand);
+        for (int x = x1; x < x2; ++x) {
+            const float* crv = p_Curve.rows + 3*x;
+            float* rgb = p_RGBA + 4*(x - p_X1);
+            for (int c = 0; c < 3; ++c) {
+                const float d = y - crv[c];
+                const float w = fminf(fmaxf(expf(-d*d*0.05f), 0.0f), 1.0f);
+                rgb[c] = rgb[c]*(1.0f - w) + w*w*crv_lm;
+            }
+        }
+    }
+}
+
+OpenDRTOverlay::OpenDRTOverlay()
+    : m_Curve()
+{
+}
+
+void OpenDRTOverlay::build(OpenDRTRenderPlan& p_Plan, int p_Width, int p_Height)
+{
+    p_Plan.overlay = 0;
+    if (p_Plan.params.tonescaleMap != 1 || p_Width <= 0 || p_Height <= 0) return;
+
+    // Curve heights in rows, as the kernels measured them: pos.y - crv*res.y
+    m_Rows.resize(3*p_Width);
+    for (int x = 0; x < p_Width; ++x) {
+        float crv[3];
+        OpenDRTOverlayColumn(x, p_Width, p_Plan, crv);
+        for (int c = 0; c < 3; ++c) m_Rows[3*x + c] = crv[c]*(float)p_Height;
+    }
+
+    // Rows each band can touch. A curve that is not finite in a column draws nothing there.
+    const int bands = (p_Width + kOverlayBand - 1)/kOverlayBand;
+    m_BandRows.resize(2*bands);
+    for (int band = 0; band < bands; ++band) {
+        double lo = HUGE_VAL, hi = -HUGE_VAL;
+        const int end = std::min(p_Width, (band + 1)*kOverlayBand);
+        for (int i = 3*band*kOverlayBand; i < 3*end; ++i) {
+            if (!std::isfinite(m_Rows[i])) continue;
+            lo = std::min(lo, (double)m_Rows[i]);
+            hi = std::max(hi, (double)m_Rows[i]);
+        }
+        const bool empty = lo > hi;
+        m_BandRows[2*band] = empty ? 1 : (int)std::max(0.0, std::floor(lo - kOverlayReach));
+        m_BandRows[2*band + 1] = empty ? 0 : (int)std::min((double)(p_Height - 1), std::ceil(hi + kOverlayReach));
+    }
+
+    m_Curve.rows = &m_Rows[0];
+    m_Curve.bandRows = &m_BandRows[0];
+    m_Curve.width = p_Width;
+    m_Curve.strength = p_Plan.params.eotf < 4 ? 1.0f : 0.5f;
+    p_Plan.overlay = &m_Curve;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include "OpenDRTRenderPlan.h"
+
+// Frame patterns: the diagnostics ramps, the RGB chips and the tonescale overlay depend on
+// the pixel's place in the frame, not on its value, so they run as passes around the CPU
+// kernel rather than inside it. Pattern rows are generated as kernel input; the overlay
+// curve is computed once per column and composited over the kernel output, and only near
+// the curve. The kernels themselves carry no per-pixel pattern branches.
+
+// Overlay pixels further than this many rows from the curve in every channel are left as
+// the kernel wrote them: their weight, expf(-0.05*d*d), is exactly 0 in float.
+#define kOverlayReach 46
+
+// Columns per band of the overlay's row bounds
+#define kOverlayBand 16
+
+// The tonescale overlay for one frame, as the kernels composite it
+struct OpenDRTOverlayCurve
+{
+    const float* rows;          // per column, R G B: curve height in frame rows
+    const int* bandRows;        // per kOverlayBand columns: first and last row it touches
+    int width;
+    float strength;             // brightness of the curve (crv_lm)
+};
+
+// True if row p_Y of the frame shows a test pattern. Static, as SimdKernel.cpp includes
+// this once per ISA and the copies must not be merged
+static inline bool hasTestPattern(const OpenDRTParams& p_Params, int p_Y)
+{
+    return p_Params.rgbChipsMode == 1 || (p_Params.diagnosticsMode == 1 && p_Y < 100);
+}
+
+// Writes the test pattern for columns [p_X1, p_X2) of row p_Y as RGBA, in the input
+// encoding; alpha comes from p_Input
+void fillTestPattern(int p_Width, int p_Height, int p_X1, int p_X2, int p_Y,
+                     const float* p_Input, float* p_Output, const OpenDRTParams& p_Params);
+
+// Draws the overlay over columns [p_X1, p_X2) of row p_Y of display-encoded RGBA
+void compositeOverlay(const OpenDRTOverlayCurve& p_Curve, int p_X1, int p_X2, int p_Y, float* p_RGBA);
+
+class OpenDRTOverlay
+{
+public:
+    OpenDRTOverlay();
+
+    // Builds the overlay curve for a p_Width by p_Height frame and points the plan at it if
+    // the tonescale overlay is on. The plan must not outlive this object.
+    void build(OpenDRTRenderPlan& p_Plan, int p_Width, int p_Height);
+
+private:
+    std::vector<float> m_Rows;
+    std::vector<int> m_BandRows;
+    OpenDRTOverlayCurve m_Curve;
+};
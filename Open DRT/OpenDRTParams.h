@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stddef.h>
+
 // Forward declaration for float3 structure
 struct float3 {
     float x, y, z;
@@ -23,6 +25,23 @@ struct HueCompressionParams {
     float globalStrength;            // Multiplier on all anchor strengths
 };
 
+// Render precision (OpenDRTParams::precision). Fast runs the vectorized CPU kernel, whose
+// powf/log2f/exp2f/atan2f/expf are the polynomial approximations in SimdMath.h, with the
+// tonescale and hue tables, and compiles the Metal kernel with fast math. Exact runs the
+// scalar libm port of the DCTL and compiles the Metal kernel without fast math.
+#define kPrecisionFast 0
+#define kPrecisionExact 1
+
+// Pixels a GPU render covers, in frame coordinates: relative to the output clip's region
+// of definition at the render scale, so the diagnostics ramps and tonescale overlay land in
+// the same place whichever tile is rendered. Strides are in floats, bounds origins are the
+// first pixel of each buffer.
+struct OpenDRTImageLayout {
+    int windowX1, windowY1, windowX2, windowY2;     // render window
+    int srcX1, srcY1, srcX2, srcY2, srcStride;      // source bounds and row stride
+    int dstX1, dstY1, dstStride;                    // destination origin and row stride
+};
+
 // OpenDRT Parameters Structure - shared between C++ and Metal
 struct OpenDRTParams {
     // Input/Output Settings
@@ -185,4 +204,21 @@ struct OpenDRTParams {
     
     // Hue Compression Parameters (NEW)
     HueCompressionParams hueCompression;
-};
\ No newline at end of file
+
+    // Render precision: kPrecisionFast or kPrecisionExact
+    int precision;
+};
+
+// The CPU caches key on a hash of the struct's bytes (OpenDRTSharedTables, the baked LUT,
+// the tile cache), so it must have no padding, whose bytes are undefined. Every field is a
+// 4-byte int or float except the four bools of HueCompressionParams, which fill one 4-byte
+// slot together; a field added that is not 4 bytes wide needs checking here.
+static_assert(offsetof(HueCompressionParams, globalRotation) ==
+              offsetof(HueCompressionParams, useSingleAnchorSettings) + 4*sizeof(bool),
+              "HueCompressionParams has padding after its bools");
+static_assert(sizeof(HueCompressionParams) == offsetof(HueCompressionParams, globalStrength) + sizeof(float),
+              "HueCompressionParams has trailing padding");
+static_assert(offsetof(OpenDRTParams, hueCompression) == offsetof(OpenDRTParams, hcPresetEnable) + sizeof(int) &&
+              offsetof(OpenDRTParams, precision) == offsetof(OpenDRTParams, hueCompression) + sizeof(HueCompressionParams) &&
+              sizeof(OpenDRTParams) == offsetof(OpenDRTParams, precision) + sizeof(int),
+              "OpenDRTParams has padding");
\ No newline at end of file
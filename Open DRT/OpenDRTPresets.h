@@ -138,87 +138,6 @@ static const ColorMatrix3x3 INPUT_GAMUT_MATRICES[] = {
                    -0.098962903023f, -0.137895315886f, 1.325916051865f)
 };
 
-// Fix your OUTPUT_GAMUT_MATRICES to match UI order:
-static const ColorMatrix3x3 OUTPUT_GAMUT_MATRICES[] = {
-    // Index 0: P3 to Rec.709 (for "Rec.709" selection)
-    ColorMatrix3x3(1.224940181f, -0.2249402404f, 0.0f,
-                   -0.04205697775f, 1.042057037f, -1.4901e-08f,
-                   -0.01963755488f, -0.07863604277f, 1.098273635f),
-    
-    // Index 1: P3 to P3-D65 (identity - for "P3-D65" selection)
-    ColorMatrix3x3(1.0f, 0.0f, 0.0f,
-                   0.0f, 1.0f, 0.0f,
-                   0.0f, 0.0f, 1.0f),
-    
-    // Index 2: P3 to Rec.2020 (for "Rec.2020 (P3 Limited)" selection)
-    ColorMatrix3x3(0.7538330344f, 0.1985973691f, 0.04756959659f,
-                   0.04574384897f, 0.9417772198f, 0.01247893122f,
-                   -0.001210340355f, 0.0176017173f, 0.9836086231f)
-};
-
-
-
-    // CREATIVE WHITEPOINT MATRICES (P3 to P3-DXX)
-    static const ColorMatrix3x3 CREATIVE_WHITEPOINT_MATRICES[][4] = {
-        // P3 Display matrices
-    {
-        // None (Identity)
-        ColorMatrix3x3(1.0f, 0.0f, 0.0f,
-                       0.0f, 1.0f, 0.0f,
-                       0.0f, 0.0f, 1.0f),
-        // D60 - CORRECTED
-        ColorMatrix3x3(0.979832881f, 0.01836378979f, 0.001803284786f,
-                       -0.000805359793f, 0.9618000331f, 1.8876121e-05f,
-                       -0.000338382322f, -0.003671835795f, 0.894139105f),
-        // D55 - CORRECTED  
-        ColorMatrix3x3(0.9559790976f, 0.0403850003f, 0.003639287409f,
-                       -0.001771929896f, 0.9163058305f, 3.3300759e-05f,
-                       -0.000674760809f, -0.0072466358f, 0.7831189153f),
-        // D50 - CORRECTED
-        ColorMatrix3x3(0.9287127388f, 0.06578032793f, 0.005506708345f,
-                       -0.002887159176f, 0.8640709228f, 4.3593718e-05f,
-                       -0.001009551548f, -0.01073503317f, 0.6672692039f)
-        },
-        // Rec.2020 Display matrices (same as P3 for now)
-    {
-        // None (Identity)
-        ColorMatrix3x3(1.0f, 0.0f, 0.0f,
-                       0.0f, 1.0f, 0.0f,
-                       0.0f, 0.0f, 1.0f),
-        // D60 - CORRECTED
-        ColorMatrix3x3(0.979832881f, 0.01836378979f, 0.001803284786f,
-                       -0.000805359793f, 0.9618000331f, 1.8876121e-05f,
-                       -0.000338382322f, -0.003671835795f, 0.894139105f),
-        // D55 - CORRECTED  
-        ColorMatrix3x3(0.9559790976f, 0.0403850003f, 0.003639287409f,
-                       -0.001771929896f, 0.9163058305f, 3.3300759e-05f,
-                       -0.000674760809f, -0.0072466358f, 0.7831189153f),
-        // D50 - CORRECTED
-        ColorMatrix3x3(0.9287127388f, 0.06578032793f, 0.005506708345f,
-                       -0.002887159176f, 0.8640709228f, 4.3593718e-05f,
-                       -0.001009551548f, -0.01073503317f, 0.6672692039f)
-        },
-        // Rec.709 Display matrices (identity for now - can be expanded)
-       {
-        // None (Identity)
-        ColorMatrix3x3(1.0f, 0.0f, 0.0f,
-                       0.0f, 1.0f, 0.0f,
-                       0.0f, 0.0f, 1.0f),
-        // D60 - CORRECTED
-        ColorMatrix3x3(1.189986856f, -0.192168414f, 0.002185496045f,
-                       -0.04168263635f, 0.9927757018f, -5.5660878e-05f,
-                       -0.01937995127f, -0.07933006919f, 0.9734397041f),
-        // D55 - CORRECTED
-        ColorMatrix3x3(1.149327514f, -0.1536910745f, 0.004366526746f,
-                       -0.0412590771f, 0.9351717477f, -0.000116126221f,
-                       -0.01900949528f, -0.07928282823f, 0.8437884317f),
-        // D50 - CORRECTED  
-        ColorMatrix3x3(1.103807322f, -0.1103425121f, 0.006531676079f,
-                       -0.04079386701f, 0.8704694227f, -0.000180522628f,
-                       -0.01854055914f, -0.07857582481f, 0.7105498861f)
-    }
-    };
-
     // Helper functions to get matrices
     inline const ColorMatrix3x3& getInputMatrix(int gamutIndex) {
         if (gamutIndex >= 0 && gamutIndex < sizeof(INPUT_GAMUT_MATRICES)/sizeof(INPUT_GAMUT_MATRICES[0])) {
@@ -227,34 +146,6 @@ static const ColorMatrix3x3 OUTPUT_GAMUT_MATRICES[] = {
         return INPUT_GAMUT_MATRICES[0]; // Default to XYZ identity
     }
 
-    inline const ColorMatrix3x3& getOutputMatrix(int displayGamut) {
-        if (displayGamut >= 0 && displayGamut < sizeof(OUTPUT_GAMUT_MATRICES)/sizeof(OUTPUT_GAMUT_MATRICES[0])) {
-            return OUTPUT_GAMUT_MATRICES[displayGamut];
-        }
-        return OUTPUT_GAMUT_MATRICES[0]; // Default to P3-D65
-    }
-
-    inline const ColorMatrix3x3& getCreativeWhitepointMatrix(int displayGamut, int cwp) {
-        int matrixIndex;
-        
-        // Map display gamut to matrix array index
-        if (displayGamut == 0) {        // Rec.709
-            matrixIndex = 2;            // Use index [2] 
-        } else if (displayGamut == 1) { // P3-D65
-            matrixIndex = 0;            // Use index [0]
-        } else if (displayGamut == 2) { // Rec.2020
-            matrixIndex = 1;            // Use index [1]
-        } else {
-            matrixIndex = 0;            // Default to P3-D65
-        }
-        
-        // Map CWP parameter to array index
-        int cwpIndex = (cwp >= 0 && cwp <= 3) ? cwp : 0; // Default to D65
-        
-        return CREATIVE_WHITEPOINT_MATRICES[matrixIndex][cwpIndex];
-    }
-
-
     // OpenDRT Look Preset Structure
     struct OpenDRTLookPreset {
         // Tonescale parameters
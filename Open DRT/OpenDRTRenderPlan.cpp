@@ -0,0 +1,229 @@
+// OpenDRTRenderPlan.cpp
+#include <cmath>
+#include <cstring>
+#include <cfloat>
+#include "OpenDRTRenderPlan.h"
+#include "OpenDRTPresets.h"
+#include "MatrixManager.h"
+
+static const float kXyzToP3[9] = {
+     2.49349691194f, -0.931383617919f, -0.402710784451f,
+    -0.829488694668f, 1.76266097069f, 0.0236246771724f,
+     0.0358458302915f, -0.0761723891287f, 0.956884503364f
+};
+
+static const float kP3ToRec709D65[9] = {
+    1.224940181f, -0.2249402404f, 0.0f,
+    -0.04205697775f, 1.042057037f, -1.4901e-08f,
+    -0.01963755488f, -0.07863604277f, 1.098273635f
+};
+
+static const float kP3ToRec2020[9] = {
+    0.7538330344f, 0.1985973691f, 0.04756959659f,
+    0.04574384897f, 0.9417772198f, 0.01247893122f,
+    -0.001210340355f, 0.0176017173f, 0.9836086231f
+};
+
+static const float kIdentity[9] = { 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+
+static void multiplyMatrices(const float* a, const float* b, float* out)
+{
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            out[i * 3 + j] = a[i * 3] * b[j] + a[i * 3 + 1] * b[3 + j] + a[i * 3 + 2] * b[6 + j];
+}
+
+static void softplusConstants(float s, float x0, float y0, float& thr, float& m)
+{
+    thr = s < 1e-3f ? -FLT_MAX : 10.0f * s + y0;
+    m = fabsf(y0) > 1e-6f ? expf(y0 / s) : 1.0f;
+    m -= expf(x0 / s);
+}
+
+void buildRenderPlan(const OpenDRTParams& p_Params, OpenDRTRenderPlan& p_Plan)
+{
+    const OpenDRTParams& p = p_Params;
+    OpenDRTRenderPlan& k = p_Plan;
+    k.params = p;
+
+    /***************************************************
+     Matrices
+    --------------------------------------------------*/
+    multiplyMatrices(kXyzToP3, OpenDRTPresets::getInputMatrix(p.inGamut).m, k.inputMatrix);
+    memcpy(k.displayMatrix, p.displayGamut == 0 ? kP3ToRec709D65 : kIdentity, sizeof(k.displayMatrix));
+    if (p.displayGamut == 0 && p.cwp == 0)
+        memcpy(k.cwpMatrix, kP3ToRec709D65, sizeof(k.cwpMatrix));
+    else
+        memcpy(k.cwpMatrix, MatrixManager::getCreativeWhitepointMatrix(p.displayGamut, p.cwp).m, sizeof(k.cwpMatrix));
+    memcpy(k.rec2020Matrix, kP3ToRec2020, sizeof(k.rec2020Matrix));
+    k.rec2020 = p.displayGamut == 2 ? 1 : 0;
+
+    k.rsW[0] = p.rsRw;
+    k.rsW[1] = 1.0f - p.rsRw - p.rsBw;
+    k.rsW[2] = p.rsBw;
+
+    /***************************************************
+     Module constants
+    --------------------------------------------------*/
+    unsigned modules = 0;
+
+    // Contrast low, including the inverse cubic toe used for the ts_x0 constraint
+    k.mconM = powf(2.0f, -p.tnLcon);
+    k.mconW = p.tnLconW / 4.0f;
+    k.mconW *= k.mconW;
+    k.mconCnstSc = 1.0f;
+    k.lconPcMix = p.tnLconPc > 0.0f ? 1.0f : 0.0f;
+    if ((p.tnLconPresetEnable || p.tnLconUIEnable) && k.mconM != 1.0f) {
+        const float x = p.ts_x0, x2 = x * x, m = k.mconM, w = k.mconW;
+        const float p0 = x2 - 3.0f * m * w;
+        const float p1 = 2.0f * x2 + 27.0f * w - 9.0f * m * w;
+        const float p2 = powf(sqrtf(x2 * p1 * p1 - 4 * p0 * p0 * p0) / 2.0f + x * p1 / 2.0f, 1.0f / 3.0f);
+        k.mconCnstSc = (p0 / (3.0f * p2) + p2 / 3.0f + x / 3.0f) / p.ts_x0;
+        modules |= kModuleLcon;
+    }
+
+    // Filmic
+    k.filmicInvMaxIn = 1.0f / powf(2.0f, p.filmicSourceStops);
+    k.filmicS = 0.05f + (p.filmicDynamicRange / 10.0f);
+    k.filmicP = 0.8f + (p.filmicDynamicRange / 25.0f);
+    k.filmicMaxOut = powf(2.0f, p.filmicTargetStops);
+    if (p.filmicMode == 1 && p.betaFeaturesEnable == 1) modules |= kModuleFilmic;
+
+    // Contrast high
+    k.hconP = powf(2.0f, p.tnHcon);
+    k.hconX0 = 0.18f * powf(2.0f, p.tnHconPv);
+    k.hconO = k.hconX0 - k.hconX0 / k.hconP;
+    k.hconS0 = powf(k.hconX0, 1.0f - k.hconP) / k.hconP;
+    k.hconX1 = k.hconX0 * powf(2.0f, p.tnHconSt);
+    k.hconK1 = k.hconP * k.hconS0 * powf(k.hconX1, k.hconP) / k.hconX1;
+    k.hconY1 = k.hconS0 * powf(k.hconX1, k.hconP) + k.hconO;
+    if ((p.tnHconPresetEnable || p.tnHconUIEnable) && k.hconP != 1.0f) modules |= kModuleHcon;
+
+    if (p.brlPresetEnable || p.brlUIEnable) modules |= kModuleBrl;
+    if (p.ptmPresetEnable || p.ptmUIEnable) modules |= kModulePtm;
+    if (p.hcPresetEnable || p.hcUIEnable) modules |= kModuleHc;
+    if (p.hsRgbPresetEnable || p.hsRgbUIEnable) modules |= kModuleHsRgb;
+    if (p.hsCmyPresetEnable || p.hsCmyUIEnable) modules |= kModuleHsCmy;
+    if (p.ptlPresetEnable || p.ptlUIEnable) modules |= kModulePtl;
+
+    softplusConstants(0.25f, -100.0f, 0.0f, k.brlThr, k.brlM);
+    softplusConstants(0.2f, -100.0f, -0.3f, k.ptlThr[0], k.ptlM[0]);
+    softplusConstants(0.04f, -0.3f, 0.0f, k.ptlThr[1], k.ptlM[1]);
+    softplusConstants(0.06f, -0.3f, 0.0f, k.ptlThr[2], k.ptlM[2]);
+    softplusConstants(0.01f, -0.05f, 0.0f, k.ptlThr[3], k.ptlM[3]);
+
+    /***************************************************
+     Hue window weights
+    --------------------------------------------------*/
+    // Brilliance sums all six windows. Hue shift RGB moves red by fb - fg and green by
+    // fr - fb with fr = hsR*R, fg = -hsG*G, fb = -hsB*B; CMY the same with fc = -hsC*C,
+    // fm = hsM*M, fy = hsY*Y. Blue takes minus the other two.
+    const bool hc = (modules & kModuleHc) != 0;
+    const bool hsRgb = (modules & kModuleHsRgb) != 0, hsCmy = (modules & kModuleHsCmy) != 0;
+    const float w[kHueChannels][6] = {
+        { -p.brlR, -p.brlG, -p.brlB, -p.brlC, -p.brlM, -p.brlY },
+        { hc ? p.hcR : 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f },
+        { 0.0f, hsRgb ? p.hsG : 0.0f, hsRgb ? -p.hsB : 0.0f, 0.0f, 0.0f, 0.0f },
+        { hsRgb ? p.hsR : 0.0f, 0.0f, hsRgb ? p.hsB : 0.0f, 0.0f, 0.0f, 0.0f },
+        { 0.0f, 0.0f, 0.0f, 0.0f, hsCmy ? -p.hsM : 0.0f, hsCmy ? p.hsY : 0.0f },
+        { 0.0f, 0.0f, 0.0f, hsCmy ? -p.hsC : 0.0f, 0.0f, hsCmy ? -p.hsY : 0.0f }
+    };
+    memcpy(k.hueWeights, w, sizeof(w));
+
+    k.tsTable = 0;
+    k.ptTable = 0;
+    k.tsTableBits = 0;
+    k.tsTableSlope[0] = k.tsTableSlope[1] = 0.0f;
+    k.hueTable = 0;
+    k.inputTable = 0;
+    k.overlay = 0;
+
+    /***************************************************
+     Kernel selection
+    --------------------------------------------------*/
+    k.modules = modules;
+    k.kernelModules = kModulesDynamic;
+#define OPENDRT_MATCH_MODULES(M) if (modules == (unsigned)(M)) k.kernelModules = (M);
+    OPENDRT_SPECIALIZED_MODULES(OPENDRT_MATCH_MODULES)
+#undef OPENDRT_MATCH_MODULES
+}
+
+bool sameSceneSide(const OpenDRTRenderPlan& p_A, const OpenDRTRenderPlan& p_B)
+{
+    const OpenDRTParams& a = p_A.params;
+    const OpenDRTParams& b = p_B.params;
+    return a.inOetf == b.inOetf && a.precision == b.precision && p_A.modules == p_B.modules &&
+           memcmp(p_A.inputMatrix, p_B.inputMatrix, sizeof(p_A.inputMatrix)) == 0 &&
+           memcmp(p_A.rsW, p_B.rsW, sizeof(p_A.rsW)) == 0 && a.rsSa == b.rsSa && a.tnOff == b.tnOff &&
+           p_A.mconM == p_B.mconM && p_A.mconW == p_B.mconW && p_A.mconCnstSc == p_B.mconCnstSc &&
+           p_A.lconPcMix == p_B.lconPcMix && a.tnLconPc == b.tnLconPc &&
+           p_A.filmicInvMaxIn == p_B.filmicInvMaxIn && p_A.filmicS == p_B.filmicS &&
+           p_A.filmicP == p_B.filmicP && p_A.filmicMaxOut == p_B.filmicMaxOut && a.filmicStrength == b.filmicStrength &&
+           a.ptR == b.ptR && a.ptG == b.ptG && a.ptB == b.ptB &&
+           memcmp(p_A.hueWeights, p_B.hueWeights, sizeof(p_A.hueWeights)) == 0 &&
+           (p_A.hueTable != 0) == (p_B.hueTable != 0);
+}
+
+OpenDRTParams presetParams(int p_Look, int p_Tonescale, int p_InGamut, int p_InOetf, int p_DisplayGamut, int p_Eotf,
+                           float p_Peak)
+{
+    using namespace OpenDRTPresets;
+    const OpenDRTLookPreset& look = LOOK_PRESETS[p_Look];
+
+    OpenDRTParams p = {};
+    p.inGamut = p_InGamut;
+    p.inOetf = p_InOetf;
+    p.displayGamut = p_DisplayGamut;
+    p.eotf = p_Eotf;
+    p.tnLp = p_Peak;
+    p.tnGb = 0.13f;
+    p.ptHdr = 0.5f;
+    p.clamp = 1;
+
+    p.tnLg = look.tn_Lg; p.tnCon = look.tn_con; p.tnSh = look.tn_sh; p.tnToe = look.tn_toe; p.tnOff = look.tn_off;
+    p.tnHcon = look.tn_hcon; p.tnHconPv = look.tn_hcon_pv; p.tnHconSt = look.tn_hcon_st;
+    p.tnLcon = look.tn_lcon; p.tnLconW = look.tn_lcon_w; p.tnLconPc = look.tn_lcon_pc;
+    if (p_Tonescale > 0) {
+        const OpenDRTTonescalePreset& ts = TONESCALE_PRESETS[p_Tonescale - 1];
+        p.tnLg = ts.tn_Lg; p.tnCon = ts.tn_con; p.tnSh = ts.tn_sh; p.tnToe = ts.tn_toe; p.tnOff = ts.tn_off;
+        p.tnHcon = ts.tn_hcon; p.tnHconPv = ts.tn_hcon_pv; p.tnHconSt = ts.tn_hcon_st;
+        p.tnLcon = ts.tn_lcon; p.tnLconW = ts.tn_lcon_w; p.tnLconPc = ts.tn_lcon_pc;
+    }
+
+    p.cwp = look.cwp; p.cwpRng = look.cwp_rng;
+    p.rsSa = look.rs_sa; p.rsRw = look.rs_rw; p.rsBw = look.rs_bw;
+    p.ptR = look.pt_r; p.ptG = look.pt_g; p.ptB = look.pt_b; p.ptRngLow = look.pt_rng_low; p.ptRngHigh = look.pt_rng_high;
+    p.ptmLow = look.ptm_low; p.ptmLowSt = look.ptm_low_st; p.ptmHigh = look.ptm_high; p.ptmHighSt = look.ptm_high_st;
+    p.brlR = look.brl_r; p.brlG = look.brl_g; p.brlB = look.brl_b;
+    p.brlC = look.brl_c; p.brlM = look.brl_m; p.brlY = look.brl_y; p.brlRng = look.brl_rng;
+    p.hsR = look.hs_r; p.hsG = look.hs_g; p.hsB = look.hs_b; p.hsRgbRng = look.hs_rgb_rng;
+    p.hsC = look.hs_c; p.hsM = look.hs_m; p.hsY = look.hs_y;
+    p.hcR = look.hc_r;
+
+    // Module checkboxes default off: the look preset's enables decide
+    p.tnHconPresetEnable = look.tn_hcon_enable ? 1 : 0;
+    p.tnLconPresetEnable = look.tn_lcon_enable ? 1 : 0;
+    p.ptlPresetEnable = look.ptl_enable ? 1 : 0;
+    p.ptmPresetEnable = look.ptm_enable ? 1 : 0;
+    p.brlPresetEnable = look.brl_enable ? 1 : 0;
+    p.hsRgbPresetEnable = look.hs_rgb_enable ? 1 : 0;
+    p.hsCmyPresetEnable = look.hs_cmy_enable ? 1 : 0;
+    p.hcPresetEnable = look.hc_enable ? 1 : 0;
+
+    const TonescaleConstants tc = calculateTonescaleConstants(
+        p.tnLp, p.tnGb, p.ptHdr, p.tnLg, p.tnCon, p.tnSh, p.tnToe, p.tnOff, p.eotf);
+    p.ts_x1 = tc.ts_x1;
+    p.ts_y1 = tc.ts_y1;
+    p.ts_x0 = tc.ts_x0;
+    p.ts_y0 = tc.ts_y0;
+    p.ts_s0 = tc.ts_s0;
+    p.ts_s10 = tc.ts_s10;
+    p.ts_m1 = tc.ts_m1;
+    p.ts_m2 = tc.ts_m2;
+    p.ts_s = tc.ts_s;
+    p.ts_dsc = tc.ts_dsc;
+    p.pt_cmp_Lf = tc.pt_cmp_Lf;
+    p.s_Lp100 = tc.s_Lp100;
+    p.ts_s1 = tc.ts_s1;
+    return p;
+}
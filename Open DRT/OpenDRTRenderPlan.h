@@ -0,0 +1,141 @@
+#pragma once
+
+#include "OpenDRTParams.h"
+
+// Render plan: everything the CPU kernels derive from OpenDRTParams that is constant for a
+// frame, built once per render by buildRenderPlan() instead of once per pixel or row.
+// The plan fuses the input -> XYZ -> P3 matrices, resolves the display gamut and creative
+// white matrices, precomputes the module constants and records which modules are enabled.
+//
+// The kernels are instantiated per module mask so that disabled stages compile out and the
+// pixel loop carries no enable tests. Only the masks in OPENDRT_SPECIALIZED_MODULES get
+// their own instantiation; any other combination runs the kModulesDynamic kernel, which
+// reads the mask from the plan.
+//
+// Everything here is plain data and macros: SimdKernel.cpp includes it from builds with
+// different -m flags and must not share inline code with the rest of the plugin.
+
+enum OpenDRTModule
+{
+    kModuleLcon   = 1 << 0,     // Contrast low
+    kModuleHcon   = 1 << 1,     // Contrast high
+    kModuleFilmic = 1 << 2,     // Filmic dynamic range compression (beta)
+    kModuleBrl    = 1 << 3,     // Brilliance
+    kModulePtm    = 1 << 4,     // Mid-range purity
+    kModuleHc     = 1 << 5,     // Hue contrast R
+    kModuleHsRgb  = 1 << 6,     // Hue shift RGB
+    kModuleHsCmy  = 1 << 7,     // Hue shift CMY
+    kModulePtl    = 1 << 8      // Purity compress low
+};
+
+#define kModulesDynamic 0x80000000u
+
+// Compile-time test when M is a specialized mask, runtime test of the plan otherwise
+#define OPENDRT_MODULE_ON(M, plan, bit) \
+    ((M) == kModulesDynamic ? ((plan).modules & (bit)) != 0 : ((M) & (bit)) != 0)
+
+// Masks with a dedicated kernel instantiation: the two chroma module sets used by the look
+// presets (everything, or purity compress low only) with each low/high contrast
+// combination of the tonescale presets.
+#define OPENDRT_CHROMA_ALL (kModuleBrl | kModulePtm | kModuleHc | kModuleHsRgb | kModuleHsCmy | kModulePtl)
+#define OPENDRT_SPECIALIZED_MODULES(X) \
+    X(OPENDRT_CHROMA_ALL) \
+    X(OPENDRT_CHROMA_ALL | kModuleLcon) \
+    X(OPENDRT_CHROMA_ALL | kModuleHcon) \
+    X(OPENDRT_CHROMA_ALL | kModuleLcon | kModuleHcon) \
+    X(kModulePtl) \
+    X(kModulePtl | kModuleLcon) \
+    X(kModulePtl | kModuleHcon) \
+    X(kModulePtl | kModuleLcon | kModuleHcon)
+
+// Tonescale tables (OpenDRTTonescaleTables.h) span [2^kTonescaleTableMinStop,
+// 2^kTonescaleTableMaxStop) with 2^tsTableBits nodes per stop
+#define kTonescaleTableMinStop (-24)
+#define kTonescaleTableMaxStop 12
+
+// Hue tables (OpenDRTHueTables.h): kHueTableSize intervals over the opponent-space
+// pseudo-angle [0, 4], one array of kHueTableSize + 2 nodes per channel (the last node
+// repeated)
+#define kHueTableSize 2048
+
+// Input tables (OpenDRTInputTable.h): the linear value of every 16-bit input code
+#define kInputTableSize 65536
+
+enum OpenDRTHueChannel
+{
+    kHueBrl,                    // brilliance factor before the achromatic mix
+    kHueHc,                     // hue contrast R, hcR*window
+    kHueRgbR, kHueRgbG,         // hue shift RGB on red and green; blue is -(red + green)
+    kHueCmyR, kHueCmyG,         // hue shift CMY, likewise
+    kHueChannels
+};
+
+struct OpenDRTOverlayCurve;
+
+struct OpenDRTRenderPlan
+{
+    OpenDRTParams params;
+
+    unsigned modules;           // OpenDRTModule bits enabled for this frame
+    unsigned kernelModules;     // modules if specialized, kModulesDynamic otherwise
+
+    // Matrices (row-major)
+    float inputMatrix[9];       // input gamut -> XYZ -> P3-D65, fused
+    float displayMatrix[9];     // P3 -> Rec.709 D65 for display gamut 0, identity otherwise
+    float cwpMatrix[9];         // creative white; equals displayMatrix when cwp is D65
+    float rec2020Matrix[9];     // P3 -> Rec.2020, applied after the clamp when rec2020 is set
+    int rec2020;
+
+    float rsW[3];               // rendering space weights
+
+    // Contrast low
+    float mconM, mconW, mconCnstSc;
+    float lconPcMix;            // 1 when the per-channel blend is active
+
+    // Filmic
+    float filmicInvMaxIn, filmicS, filmicP, filmicMaxOut;
+
+    // Contrast high
+    float hconP, hconX0, hconO, hconS0, hconX1, hconK1, hconY1;
+
+    // Hue window weights: row OpenDRTHueChannel, column window R, G, B, C, M, Y. Rows of
+    // disabled modules are zero.
+    float hueWeights[kHueChannels][6];
+
+    // softplus() thresholds (10*s + y0) and offsets (exp(y0/s) - exp(x0/s))
+    float brlThr, brlM;
+    float ptlThr[4], ptlM[4];
+
+    // Tonescale curve (contrast high and the hyperbolic compression) as 1D tables of the
+    // norm; null when it is evaluated analytically. buildRenderPlan() leaves them null.
+    const float* tsTable;       // tonescale norm, compressed with ts_s
+    const float* ptTable;       // purity norm, compressed with ts_s1
+    int tsTableBits;
+    float tsTableSlope[2];      // tsTable[0] and ptTable[0] over 2^kTonescaleTableMinStop
+
+    // Hue windows summed with the module weights per OpenDRTHueChannel; null when they
+    // are evaluated per pixel. buildRenderPlan() leaves it null.
+    const float* hueTable;
+
+    // inOetf decoded for each 16-bit integer input code; null for a linear inOetf and for
+    // float input, which keep the analytic curves. buildRenderPlan() leaves it null.
+    const float* inputTable;
+
+    // Tonescale overlay curve (OpenDRTOverlay.h), composited after the kernel; null when
+    // the overlay is off. buildRenderPlan() leaves it null.
+    const OpenDRTOverlayCurve* overlay;
+};
+
+void buildRenderPlan(const OpenDRTParams& p_Params, OpenDRTRenderPlan& p_Plan);
+
+// Parameters as the plugin has them after choosing a look and tonescale preset (0 for the
+// look's own) and the input and display setup, everything else left at its default; for
+// the command-line tools
+OpenDRTParams presetParams(int p_Look, int p_Tonescale, int p_InGamut, int p_InOetf, int p_DisplayGamut, int p_Eotf,
+                           float p_Peak);
+
+// True if the two plans agree on everything the kernels compute before the tonescale (the
+// input curve and matrices, contrast low, filmic, the norms and the hue windows), so that
+// they differ only in the display side: peak luminance, display gamut, encoding and the
+// creative white. See RunSIMDKernelRowTargets().
+bool sameSceneSide(const OpenDRTRenderPlan& p_A, const OpenDRTRenderPlan& p_B);
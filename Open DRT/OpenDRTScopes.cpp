@@ -0,0 +1,104 @@
+// OpenDRTScopes.cpp
+#include <cstdio>
+#include <cstring>
+#include "OpenDRTScopes.h"
+
+void resetScopes(OpenDRTScopes& p_Scopes)
+{
+    memset(&p_Scopes, 0, sizeof(p_Scopes));
+}
+
+void mergeScopes(OpenDRTScopes& p_Scopes, const OpenDRTScopes& p_Band)
+{
+    p_Scopes.pixels += p_Band.pixels;
+    for (int i = 0; i < kScopesHistogramBins; ++i) p_Scopes.histogram[i] += p_Band.histogram[i];
+    for (int c = 0; c < 3; ++c) {
+        p_Scopes.clippedLow[c] += p_Band.clippedLow[c];
+        p_Scopes.clippedHigh[c] += p_Band.clippedHigh[c];
+    }
+    p_Scopes.negative += p_Band.negative;
+    p_Scopes.outOfGamut += p_Band.outOfGamut;
+    for (int l = 0; l < kScopesWaveformLevels; ++l) {
+        for (int i = 0; i < kScopesWaveformColumns; ++i) p_Scopes.waveform[l][i] += p_Band.waveform[l][i];
+    }
+}
+
+// Index of v over [0, 1] in n bins; below the range and NaN go to the first bin
+static int binOf(float v, int n)
+{
+    if (!(v > 0.0f)) return 0;
+    const int i = (int)(v*(float)n);
+    return i < n ? i : n - 1;
+}
+
+void accumulateScopes(OpenDRTScopes& p_Scopes, const float* p_RGBA, int p_X1, int p_X2, int p_Width)
+{
+    for (int x = p_X1; x < p_X2; ++x, p_RGBA += 4) {
+        for (int c = 0; c < 3; ++c) {
+            p_Scopes.clippedLow[c] += p_RGBA[c] <= 0.0f;
+            p_Scopes.clippedHigh[c] += p_RGBA[c] >= 1.0f;
+        }
+        const float luma = 0.2126f*p_RGBA[0] + 0.7152f*p_RGBA[1] + 0.0722f*p_RGBA[2];
+        p_Scopes.histogram[binOf(luma, kScopesHistogramBins)]++;
+        p_Scopes.waveform[binOf(luma, kScopesWaveformLevels)][x*kScopesWaveformColumns/p_Width]++;
+    }
+    p_Scopes.pixels += p_X2 - p_X1;
+}
+
+// Luma below which the fraction p_Fraction of the pixels lie, at the bin centre
+static float lumaPercentile(const OpenDRTScopes& p_Scopes, double p_Fraction)
+{
+    const double target = p_Fraction*(double)p_Scopes.pixels;
+    uint64_t count = 0;
+    for (int i = 0; i < kScopesHistogramBins; ++i) {
+        count += p_Scopes.histogram[i];
+        if ((double)count >= target) return ((float)i + 0.5f)/(float)kScopesHistogramBins;
+    }
+    return 1.0f;
+}
+
+std::string formatScopesSummary(const OpenDRTScopes& p_Scopes)
+{
+    if (p_Scopes.pixels == 0) return "No CPU render yet";
+
+    const double pct = 100.0/(double)p_Scopes.pixels;
+    char line[256];
+    snprintf(line, sizeof(line),
+             "Clipped R %.2f%% G %.2f%% B %.2f%% | Crushed R %.2f%% G %.2f%% B %.2f%% | "
+             "Negative %.2f%% | Out of gamut %.2f%% | Luma 1%% %.3f 50%% %.3f 99%% %.3f",
+             p_Scopes.clippedHigh[0]*pct, p_Scopes.clippedHigh[1]*pct, p_Scopes.clippedHigh[2]*pct,
+             p_Scopes.clippedLow[0]*pct, p_Scopes.clippedLow[1]*pct, p_Scopes.clippedLow[2]*pct,
+             p_Scopes.negative*pct, p_Scopes.outOfGamut*pct,
+             lumaPercentile(p_Scopes, 0.01), lumaPercentile(p_Scopes, 0.5), lumaPercentile(p_Scopes, 0.99));
+    return line;
+}
+
+std::string formatScopesDetail(const OpenDRTScopes& p_Scopes)
+{
+    std::string text = "Histogram:";
+    char number[32];
+    for (int i = 0; i < kScopesHistogramBins; ++i) {
+        snprintf(number, sizeof(number), " %llu", (unsigned long long)p_Scopes.histogram[i]);
+        text += number;
+    }
+
+    // Any pixel in a cell shows; the density steps are relative to the fullest cell
+    static const char kDensity[] = " .:-=+*#%@";
+    const int steps = (int)sizeof(kDensity) - 2;
+    uint32_t most = 1;
+    for (int l = 0; l < kScopesWaveformLevels; ++l) {
+        for (int i = 0; i < kScopesWaveformColumns; ++i) {
+            if (p_Scopes.waveform[l][i] > most) most = p_Scopes.waveform[l][i];
+        }
+    }
+    text += "\nWaveform:";
+    for (int l = kScopesWaveformLevels - 1; l >= 0; --l) {
+        text += "\n|";
+        for (int i = 0; i < kScopesWaveformColumns; ++i) {
+            const uint64_t n = p_Scopes.waveform[l][i];
+            text += kDensity[n ? 1 + (int)(n*(steps - 1)/most) : 0];
+        }
+        text += "|";
+    }
+    return text;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+// Output scopes, gathered by the CPU kernels in the render pass itself rather than by a
+// second read of the frame: each render thread fills its own OpenDRTScopes over its band
+// of rows, and the bands are merged when the threads are done.
+// The histogram, clip counts and waveform are of the display-encoded output before it is
+// quantized; the gamut counts are of display-linear RGB before the Clamp option.
+
+#define kScopesHistogramBins 256
+#define kScopesWaveformColumns 64
+#define kScopesWaveformLevels 32
+
+struct OpenDRTScopes
+{
+    uint64_t pixels;
+    uint64_t histogram[kScopesHistogramBins];   // Rec.709 luma of the output over [0, 1]
+    uint64_t clippedLow[3];                     // per channel, output at or below 0
+    uint64_t clippedHigh[3];                    // per channel, output at or above 1
+    uint64_t negative;                          // pixels with a channel below 0 before the clamp
+    uint64_t outOfGamut;                        // pixels with a channel outside [0, 1] before the clamp
+    // Luma by frame column: kScopesWaveformColumns across the frame, kScopesWaveformLevels
+    // levels over [0, 1], level 0 at the bottom
+    uint32_t waveform[kScopesWaveformLevels][kScopesWaveformColumns];
+};
+
+void resetScopes(OpenDRTScopes& p_Scopes);
+void mergeScopes(OpenDRTScopes& p_Scopes, const OpenDRTScopes& p_Band);
+
+// Adds display-encoded RGBA columns [p_X1, p_X2) of a p_Width wide frame
+void accumulateScopes(OpenDRTScopes& p_Scopes, const float* p_RGBA, int p_X1, int p_X2, int p_Width);
+
+// Adds one pixel's display-linear RGB, before the clamp, to the gamut counts
+static inline void countGamut(OpenDRTScopes& p_Scopes, float p_R, float p_G, float p_B)
+{
+    const bool negative = p_R < 0.0f || p_G < 0.0f || p_B < 0.0f;
+    p_Scopes.negative += negative;
+    p_Scopes.outOfGamut += negative || p_R > 1.0f || p_G > 1.0f || p_B > 1.0f;
+}
+
+// One line: clip and gamut percentages, and the luma percentiles
+std::string formatScopesSummary(const OpenDRTScopes& p_Scopes);
+
+// The histogram as kScopesHistogramBins counts, and the waveform drawn in text, one line
+// per level from the top
+std::string formatScopesDetail(const OpenDRTScopes& p_Scopes);
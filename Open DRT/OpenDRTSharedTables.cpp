@@ -0,0 +1,107 @@
+// OpenDRTSharedTables.cpp
+#include "OpenDRTSharedTables.h"
+#include "OpenDRTTileCache.h"
+#include "ofxsLog.h"
+
+OpenDRTSharedTables& OpenDRTSharedTables::instance()
+{
+    static OpenDRTSharedTables tables;
+    return tables;
+}
+
+OpenDRTSharedTables::OpenDRTSharedTables()
+    : m_Bytes(0)
+    , m_Lookups(0)
+    , m_Builds(0)
+{
+}
+
+std::shared_ptr<const OpenDRTDerivedTables> OpenDRTSharedTables::getTables(const OpenDRTParams& p_Params, int p_TsTableBits,
+                                                                          bool p_HueTables, bool p_InputTable)
+{
+    const int request[3] = { p_TsTableBits, p_HueTables ? 1 : 0, p_InputTable ? 1 : 0 };
+    const uint64_t hash = hashBytes(&p_Params, sizeof(p_Params), hashBytes(request, sizeof(request), 0));
+
+    return std::static_pointer_cast<const OpenDRTDerivedTables>(get(kSharedRenderTables, hash, [&](size_t& p_Bytes) {
+        std::shared_ptr<OpenDRTDerivedTables> tables = std::make_shared<OpenDRTDerivedTables>();
+        buildRenderPlan(p_Params, tables->plan);
+        tables->tsTables.build(tables->plan, p_TsTableBits);
+        if (p_HueTables) tables->hueTables.build(tables->plan);
+        if (p_InputTable) tables->inputTable.build(tables->plan);
+        p_Bytes = sizeof(OpenDRTDerivedTables) + tables->tsTables.getBytes() +
+                  tables->hueTables.getBytes() + tables->inputTable.getBytes();
+        return std::shared_ptr<const void>(tables);
+    }));
+}
+
+std::shared_ptr<const void> OpenDRTSharedTables::get(OpenDRTSharedKind p_Kind, uint64_t p_Hash, const Builder& p_Build)
+{
+    const int kind = p_Kind;
+    const uint64_t key = hashBytes(&kind, sizeof(kind), p_Hash);
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    ++m_Lookups;
+    std::unordered_map<uint64_t, Entry>::iterator it = m_Entries.find(key);
+    if (it != m_Entries.end()) {
+        m_Use.splice(m_Use.begin(), m_Use, it->second.use);
+        std::shared_future<std::shared_ptr<const void>> value = it->second.value;
+        lock.unlock();
+        return value.get();
+    }
+
+    // Entered before it is built, so that other renders of the same key wait for it
+    std::promise<std::shared_ptr<const void>> promise;
+    ++m_Builds;
+    m_Use.push_front(key);
+    Entry& entry = m_Entries[key];
+    entry.value = promise.get_future().share();
+    entry.bytes = 0;
+    entry.use = m_Use.begin();
+    lock.unlock();
+
+    size_t bytes = 0;
+    std::shared_ptr<const void> value;
+    try {
+        value = p_Build(bytes);
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+        lock.lock();
+        it = m_Entries.find(key);
+        if (it != m_Entries.end() && it->second.bytes == 0) {
+            m_Use.erase(it->second.use);
+            m_Entries.erase(it);
+        }
+        throw;
+    }
+    promise.set_value(value);
+
+    lock.lock();
+    it = m_Entries.find(key);
+    if (it != m_Entries.end() && it->second.bytes == 0) {
+        it->second.bytes = bytes;
+        m_Bytes += bytes;
+        evict();
+    }
+    OFX::Log::print("OpenDRT: derived shared render data (kind %d, %zu bytes); %zu entries, %.1f MB, %.1f%% of lookups shared\n",
+                    kind, bytes, m_Entries.size(), m_Bytes/1048576.0, 100.0*(m_Lookups - m_Builds)/m_Lookups);
+    return value;
+}
+
+// Drops the least recently used entries until the cache is within its budget. Entries
+// still being built hold no bytes yet and are only dropped from the index.
+void OpenDRTSharedTables::evict()
+{
+    while (m_Bytes > kSharedTablesBudget && !m_Use.empty()) {
+        std::unordered_map<uint64_t, Entry>::iterator it = m_Entries.find(m_Use.back());
+        m_Bytes -= it->second.bytes;
+        m_Entries.erase(it);
+        m_Use.pop_back();
+    }
+}
+
+OpenDRTSharedStats OpenDRTSharedTables::stats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    OpenDRTSharedStats stats = { m_Lookups, m_Builds, m_Entries.size(), m_Bytes };
+    return stats;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "OpenDRTParams.h"
+#include "OpenDRTRenderPlan.h"
+#include "OpenDRTTonescaleTables.h"
+#include "OpenDRTHueTables.h"
+#include "OpenDRTInputTable.h"
+
+// Derived render data shared by every instance in the process. A timeline can hold many
+// OpenDRT instances with the same look, and the render plan, its tables and the baked LUT
+// depend on the parameters alone: the first render of a set of parameters derives them and
+// every other instance takes a reference. Entries are keyed by a hash of the whole
+// OpenDRTParams (the parameters as fetched, with the tonescale constants and matrices
+// derived from them) and what was asked for. Once the cache holds more than
+// kSharedTablesBudget the least recently used entries are dropped; a render still holding
+// one keeps it alive. A render asking for an entry that another is deriving waits for it
+// rather than deriving it again.
+
+#define kSharedTablesBudget ((size_t)512 << 20)
+
+// Kinds of entry, part of the key
+enum OpenDRTSharedKind
+{
+    kSharedRenderTables = 1,        // OpenDRTDerivedTables
+    kSharedBakedLUT = 2             // baked LUT (OpenDRTLUTBaker)
+};
+
+// Render plan and the tables it points at, for one set of parameters
+struct OpenDRTDerivedTables
+{
+    OpenDRTRenderPlan plan;
+    OpenDRTTonescaleTables tsTables;
+    OpenDRTHueTables hueTables;
+    OpenDRTInputTable inputTable;
+};
+
+// Counters since the process started, for the render log
+struct OpenDRTSharedStats
+{
+    uint64_t lookups;
+    uint64_t builds;            // lookups that derived the entry
+    size_t entries;
+    size_t bytes;
+};
+
+class OpenDRTSharedTables
+{
+public:
+    static OpenDRTSharedTables& instance();
+
+    // Plan for p_Params with tonescale tables of 2^p_TsTableBits nodes per stop (0 keeps
+    // the analytic curve), and the hue and 16-bit input tables if asked for
+    std::shared_ptr<const OpenDRTDerivedTables> getTables(const OpenDRTParams& p_Params, int p_TsTableBits,
+                                                         bool p_HueTables, bool p_InputTable);
+
+    // Entry of another kind for p_Hash, made by p_Build (which also gives its size in
+    // bytes) if the cache does not hold it
+    typedef std::function<std::shared_ptr<const void>(size_t& p_Bytes)> Builder;
+    std::shared_ptr<const void> get(OpenDRTSharedKind p_Kind, uint64_t p_Hash, const Builder& p_Build);
+
+    OpenDRTSharedStats stats();
+
+private:
+    OpenDRTSharedTables();
+
+    struct Entry
+    {
+        std::shared_future<std::shared_ptr<const void>> value;
+        size_t bytes;                   // 0 until built
+        std::list<uint64_t>::iterator use;
+    };
+
+    void evict();
+
+    std::mutex m_Mutex;
+    std::unordered_map<uint64_t, Entry> m_Entries;
+    std::list<uint64_t> m_Use;          // keys, most recently used first
+    size_t m_Bytes;
+    uint64_t m_Lookups;
+    uint64_t m_Builds;
+};
@@ -0,0 +1,161 @@
+// OpenDRTTileCache.cpp
+#include <cstring>
+#include "OpenDRTTileCache.h"
+
+void mergeTileStats(OpenDRTTileStats& p_Stats, const OpenDRTTileStats& p_Band)
+{
+    p_Stats.tiles += p_Band.tiles;
+    p_Stats.hits += p_Band.hits;
+}
+
+/***************************************************
+ Hash
+--------------------------------------------------*/
+static const uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+static const uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t rotl64(uint64_t p_X, int p_R)
+{
+    return (p_X << p_R) | (p_X >> (64 - p_R));
+}
+
+static inline uint64_t round64(uint64_t p_Acc, uint64_t p_Lane)
+{
+    p_Acc += p_Lane*kPrime2;
+    return rotl64(p_Acc, 31)*kPrime1;
+}
+
+static inline uint64_t merge64(uint64_t p_Acc, uint64_t p_Lane)
+{
+    p_Acc ^= round64(0, p_Lane);
+    return p_Acc*kPrime1 + kPrime4;
+}
+
+static inline uint64_t read64(const unsigned char* p_Bytes)
+{
+    uint64_t v;
+    memcpy(&v, p_Bytes, 8);
+    return v;
+}
+
+uint64_t hashBytes(const void* p_Data, size_t p_Size, uint64_t p_Seed)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(p_Data);
+    const unsigned char* end = bytes + p_Size;
+    uint64_t h;
+
+    // Four independent lanes over 32-byte stripes, so the multiplies overlap
+    if (p_Size >= 32) {
+        uint64_t v[4] = { p_Seed + kPrime1 + kPrime2, p_Seed + kPrime2, p_Seed, p_Seed - kPrime1 };
+        for (; bytes + 32 <= end; bytes += 32) {
+            for (int i = 0; i < 4; ++i) v[i] = round64(v[i], read64(bytes + 8*i));
+        }
+        h = rotl64(v[0], 1) + rotl64(v[1], 7) + rotl64(v[2], 12) + rotl64(v[3], 18);
+        for (int i = 0; i < 4; ++i) h = merge64(h, v[i]);
+    } else {
+        h = p_Seed + kPrime5;
+    }
+    h += (uint64_t)p_Size;
+
+    for (; bytes + 8 <= end; bytes += 8) {
+        h ^= round64(0, read64(bytes));
+        h = rotl64(h, 27)*kPrime1 + kPrime4;
+    }
+    for (; bytes < end; ++bytes) {
+        h ^= (uint64_t)*bytes*kPrime5;
+        h = rotl64(h, 11)*kPrime1;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+/***************************************************
+ Tile cache
+--------------------------------------------------*/
+OpenDRTTileCache::OpenDRTTileCache()
+    : m_Budget(0)
+    , m_Bytes(0)
+    , m_Totals()
+{
+}
+
+void OpenDRTTileCache::setBudget(size_t p_Bytes)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Budget = p_Bytes;
+    evict();
+}
+
+bool OpenDRTTileCache::enabled()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Budget > 0;
+}
+
+std::shared_ptr<const std::vector<char>> OpenDRTTileCache::find(uint64_t p_Key, uint64_t p_Source)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    std::unordered_map<uint64_t, Entry>::iterator it = m_Tiles.find(p_Key);
+    if (it == m_Tiles.end() || it->second.source != p_Source) return nullptr;
+
+    m_Use.splice(m_Use.begin(), m_Use, it->second.use);
+    return it->second.pixels;
+}
+
+void OpenDRTTileCache::store(uint64_t p_Key, uint64_t p_Source, std::vector<char>&& p_Pixels)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (p_Pixels.size() > m_Budget) return;
+
+    std::unordered_map<uint64_t, Entry>::iterator it = m_Tiles.find(p_Key);
+    if (it == m_Tiles.end()) {
+        m_Use.push_front(p_Key);
+        it = m_Tiles.insert(std::make_pair(p_Key, Entry())).first;
+        it->second.use = m_Use.begin();
+    } else {
+        m_Bytes -= it->second.pixels->size();
+        m_Use.splice(m_Use.begin(), m_Use, it->second.use);
+    }
+    m_Bytes += p_Pixels.size();
+    it->second.source = p_Source;
+    it->second.pixels = std::make_shared<const std::vector<char>>(std::move(p_Pixels));
+    evict();
+}
+
+// Drops the least recently used tiles until the cache is within its budget; a tile being
+// copied out stays alive until the copy is done
+void OpenDRTTileCache::evict()
+{
+    while (m_Bytes > m_Budget && !m_Use.empty()) {
+        std::unordered_map<uint64_t, Entry>::iterator it = m_Tiles.find(m_Use.back());
+        m_Bytes -= it->second.pixels->size();
+        m_Tiles.erase(it);
+        m_Use.pop_back();
+    }
+}
+
+OpenDRTTileStats OpenDRTTileCache::totals()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Totals;
+}
+
+void OpenDRTTileCache::addStats(const OpenDRTTileStats& p_Frame)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    mergeTileStats(m_Totals, p_Frame);
+}
+
+size_t OpenDRTTileCache::bytesHeld()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Bytes;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Output tiles of an instance's recent CPU renders, for held frames, freeze frames and
+// locked-off shots that the host renders again unchanged. A tile is found by its place in
+// the frame and the render settings (a hash of everything but the pixels: parameters,
+// tables, pixel format, frame), and is only reused if the hash of its source pixels matches
+// too; it then is copied instead of rendered. The least recently used tiles go first once
+// the cache is over its budget.
+
+// Tile size in pixels, on a grid from the frame's origin
+#define kTileCacheColumns 256
+#define kTileCacheRows 32
+
+// Tile counters, for the render log
+struct OpenDRTTileStats
+{
+    uint64_t tiles;
+    uint64_t hits;          // tiles copied from the cache
+};
+
+void mergeTileStats(OpenDRTTileStats& p_Stats, const OpenDRTTileStats& p_Band);
+
+// 64-bit hash of p_Size bytes, continuing from p_Seed (the xxHash64 rounds over 8-byte
+// lanes); rows are hashed one after another by passing the hash of the rows before
+uint64_t hashBytes(const void* p_Data, size_t p_Size, uint64_t p_Seed);
+
+class OpenDRTTileCache
+{
+public:
+    OpenDRTTileCache();
+
+    // Budget in bytes; 0 turns the cache off and empties it
+    void setBudget(size_t p_Bytes);
+    bool enabled();
+
+    // Output bytes of the tile at p_Key if its source hashed to p_Source, else null
+    std::shared_ptr<const std::vector<char>> find(uint64_t p_Key, uint64_t p_Source);
+
+    // Keeps a rendered tile in place of the one before at p_Key
+    void store(uint64_t p_Key, uint64_t p_Source, std::vector<char>&& p_Pixels);
+
+    // Counters since the cache was created, and the bytes held
+    OpenDRTTileStats totals();
+    void addStats(const OpenDRTTileStats& p_Frame);
+    size_t bytesHeld();
+
+private:
+    struct Entry
+    {
+        uint64_t source;
+        std::shared_ptr<const std::vector<char>> pixels;
+        std::list<uint64_t>::iterator use;
+    };
+
+    void evict();
+
+    std::mutex m_Mutex;
+    size_t m_Budget;
+    size_t m_Bytes;
+    std::unordered_map<uint64_t, Entry> m_Tiles;
+    std::list<uint64_t> m_Use;      // keys, most recently used first
+    OpenDRTTileStats m_Totals;
+};
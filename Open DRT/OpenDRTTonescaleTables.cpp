@@ -0,0 +1,81 @@
+// OpenDRTTonescaleTables.cpp
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include "OpenDRTTonescaleTables.h"
+#include "ofxsLog.h"
+
+static float asFloat(int32_t i) { float f; memcpy(&f, &i, sizeof(f)); return f; }
+static int32_t asInt(float f) { int32_t i; memcpy(&i, &f, sizeof(i)); return i; }
+
+// Analytic curve, as hconStage() and tonescaleStage() in SimdKernel.cpp
+static float tonescaleCurve(const OpenDRTRenderPlan& p_Plan, float x, float s)
+{
+    if (p_Plan.modules & kModuleHcon) {
+        const float rx = x > p_Plan.hconX1 ? p_Plan.hconK1*(x - p_Plan.hconX1) + p_Plan.hconY1
+                                           : p_Plan.hconS0*powf(x, p_Plan.hconP) + p_Plan.hconO;
+        x = x < p_Plan.hconX0 ? x : rx;
+    }
+    return x <= 0.0f ? x : powf(x/(x + s), p_Plan.params.tnCon);
+}
+
+// Table lookup, as tonescaleTableStage() in SimdKernel.cpp
+static float lookup(const float* p_Table, float p_Slope, int p_Bits, float x)
+{
+    const int shift = 23 - p_Bits;
+    const int32_t rel = asInt(x) - asInt(ldexpf(1.0f, kTonescaleTableMinStop));
+    if (rel < 0) return x*p_Slope;
+    const int32_t i = rel >> shift;
+    const float f = (float)(rel & ((1 << shift) - 1))*ldexpf(1.0f, -shift);
+    return p_Table[i] + (p_Table[i + 1] - p_Table[i])*f;
+}
+
+OpenDRTTonescaleTables::OpenDRTTonescaleTables()
+    : m_MaxError(0.0f)
+{
+}
+
+void OpenDRTTonescaleTables::build(OpenDRTRenderPlan& p_Plan, int p_Bits)
+{
+    p_Plan.tsTable = 0;
+    p_Plan.ptTable = 0;
+    p_Plan.tsTableBits = 0;
+    m_MaxError = 0.0f;
+    if (p_Bits <= 0) return;
+
+    const int intervals = (kTonescaleTableMaxStop - kTonescaleTableMinStop) << p_Bits;
+    const int size = intervals + 1;
+    const int shift = 23 - p_Bits;
+    const int32_t base = asInt(ldexpf(1.0f, kTonescaleTableMinStop));
+    const float s[2] = { p_Plan.params.ts_s, p_Plan.params.ts_s1 };
+
+    m_Storage.resize(size * 2);
+    for (int c = 0; c < 2; ++c) {
+        float* table = &m_Storage[c * size];
+        for (int j = 0; j < size; ++j) {
+            table[j] = tonescaleCurve(p_Plan, asFloat(base + (j << shift)), s[c]);
+        }
+        p_Plan.tsTableSlope[c] = table[0]/ldexpf(1.0f, kTonescaleTableMinStop);
+    }
+
+    // Check halfway between nodes, where linear interpolation is furthest off
+    for (int c = 0; c < 2; ++c) {
+        const float* table = &m_Storage[c * size];
+        for (int j = 0; j < intervals; ++j) {
+            const float x = asFloat(base + (j << shift) + (1 << (shift - 1)));
+            const float exact = tonescaleCurve(p_Plan, x, s[c]);
+            const float e = fabsf(lookup(table, p_Plan.tsTableSlope[c], p_Bits, x) - exact)/fmaxf(exact, 1e-6f);
+            m_MaxError = e > m_MaxError ? e : m_MaxError;
+        }
+    }
+    if (!(m_MaxError <= kTonescaleTableTolerance)) {
+        OFX::Log::print("OpenDRT: %d-node/stop tonescale table off by %.2g, using the analytic curve\n",
+                        1 << p_Bits, m_MaxError);
+        return;
+    }
+
+    p_Plan.tsTable = &m_Storage[0];
+    p_Plan.ptTable = &m_Storage[size];
+    p_Plan.tsTableBits = p_Bits;
+}
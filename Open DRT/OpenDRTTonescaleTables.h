@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "OpenDRTRenderPlan.h"
+
+// Tonescale tables: contrast high and the hyperbolic compression are a 1D function of the
+// tonescale norm (and, with ts_s1, of the purity norm), so the CPU kernel can look them up
+// instead of running two powf() per value. Built once per frame from the plan's ts_*
+// constants.
+//
+// Nodes are spaced evenly in log2, 2^bits per stop over [2^-24, 2^12), and indexed
+// straight from the float bits: exponent and top mantissa bits give the node, the rest the
+// interpolation weight. Below the range the curve is a linear ramp to 0 (error < 1e-9);
+// tiles with a norm above it, or a NaN, run the analytic curve.
+//
+// Every build is checked against the analytic curve halfway between nodes. Tables whose
+// relative error exceeds kTonescaleTableTolerance are dropped and the frame runs
+// analytically. Measured worst case over the look and tonescale presets: 6.6e-4 at 16
+// nodes per stop (some high contrast presets fall back), 4.3e-5 at 64, 2.8e-6 at 256.
+// The display encode magnifies it: against Exact, Fast output with 64 per stop is within
+// 2.6e-4 for gamma and HLG and 9.3e-4 for PQ, with 256 within 4.4e-5 (OpenDRTBench), so
+// 256 is the plugin's default.
+// The gain is with contrast high on, which takes a third powf(); without it the table
+// and two powf() run at about the same speed.
+
+#define kTonescaleTableTolerance (1.0f/2048.0f)
+
+class OpenDRTTonescaleTables
+{
+public:
+    OpenDRTTonescaleTables();
+
+    // Builds the tables for the plan with 2^p_Bits nodes per stop and points the plan at
+    // them; p_Bits 0 keeps the analytic curve. The plan must not outlive this object.
+    void build(OpenDRTRenderPlan& p_Plan, int p_Bits);
+
+    // Largest relative error against the analytic curve measured by the last build
+    float getMaxError() const { return m_MaxError; }
+
+    // Bytes of table storage, for the shared cache budget (OpenDRTSharedTables.h)
+    size_t getBytes() const { return m_Storage.size()*sizeof(float); }
+
+private:
+    std::vector<float> m_Storage;
+    float m_MaxError;
+};
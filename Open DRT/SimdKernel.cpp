@@ -0,0 +1,1281 @@
+// SimdKernel.cpp
+// Structure-of-arrays OpenDRT CPU kernel, see SimdKernel.h.
+// Built once per instruction set; SIMD_KERNEL_ISA names the namespace of each build and
+// the build with SIMD_KERNEL_DISPATCH also carries the runtime dispatcher.
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cfloat>
+#include "SimdKernel.h"
+#include "SimdMath.h"
+#include "OpenDRTOverlay.h"
+#include "OpenDRTScopes.h"
+
+using namespace SimdMath;
+
+// Scalar kernel (OpenCLKernel.cpp). Only out-of-line functions are used from other files:
+// this file is built with different -m flags and must not emit shared inline code.
+extern void RunCPUKernelRow(int p_X1, int p_X2, const float* p_Input, float* p_Output, const OpenDRTRenderPlan& p_Plan,
+                            OpenDRTScopes* p_Scopes);
+
+#ifndef SIMD_KERNEL_ISA
+#define SIMD_KERNEL_ISA baseline
+#endif
+#define SIMD_KERNEL_CONCAT2(a, b) a##_##b
+#define SIMD_KERNEL_CONCAT(a, b) SIMD_KERNEL_CONCAT2(a, b)
+#define SIMD_KERNEL_NAMESPACE SIMD_KERNEL_CONCAT(SimdKernel, SIMD_KERNEL_ISA)
+
+// Each stage is one loop over a tile. Stages stay out of line: once they are all inlined into
+// processRow() GCC's jump threading merges their loops and most of them stop vectorizing.
+#define SIMD_STAGE static __attribute__((noinline))
+
+// Rows the vectorized kernel leaves to the scalar one: Exact precision asks for the libm math
+static bool runsScalar(const OpenDRTRenderPlan& p_Plan)
+{
+    return p_Plan.params.precision == kPrecisionExact;
+}
+
+namespace SIMD_KERNEL_NAMESPACE {
+
+static const float kSqrt3 = 1.73205080756887729353f;
+
+inline float maxf(float a, float b) { return simd_maxf(a, b); }
+inline float minf(float a, float b) { return simd_minf(a, b); }
+inline float clamp01(float a) { return minf(maxf(a, 0.0f), 1.0f); }
+inline float sdivf(float a, float b) { return b == 0.0f ? 0.0f : a / b; }
+
+// softplus() with the frame-constant parts hoisted: thr = 10*s + y0, m = exp(y0/s) - exp(x0/s)
+inline float softplus(float x, float s, float thr, float m)
+{
+    const float r = s * simd_logf(maxf(0.0f, m + simd_expf(x / s)));
+    return x > thr ? x : r;
+}
+
+inline float gauss_hue(float hue, float o, float w)
+{
+    const float d = (simd_fmodf(hue - o + kPi, 2.0f * kPi) - kPi) / w;
+    return simd_expf(-d * d);
+}
+
+inline float lerpTable(const float* T, int j, float f)
+{
+    return T[j] + (T[j + 1] - T[j])*f;
+}
+
+inline float sigmoid_cubic(float x, float s)
+{
+    const float r = 1.0f + s * (1.0f - 3.0f * x * x + 2.0f * x * x * x);
+    return (x < 0.0f || x > 1.0f) ? 1.0f : r;
+}
+
+inline void mul3x3(const float* m, float& r, float& g, float& b)
+{
+    const float x = m[0] * r + m[1] * g + m[2] * b;
+    const float y = m[3] * r + m[4] * g + m[5] * b;
+    const float z = m[6] * r + m[7] * g + m[8] * b;
+    r = x; g = y; b = z;
+}
+
+/***************************************************
+ Tile storage
+--------------------------------------------------*/
+struct Tile
+{
+    alignas(64) float r[kSimdTileSize];
+    alignas(64) float g[kSimdTileSize];
+    alignas(64) float b[kSimdTileSize];
+    alignas(64) float a[kSimdTileSize];
+    alignas(64) float tsn[kSimdTileSize];
+    alignas(64) float pt[kSimdTileSize];
+    alignas(64) float achD[kSimdTileSize];
+    alignas(64) float ptCmp[kSimdTileSize];
+    alignas(64) float hue[kHueChannels][kSimdTileSize];     // weighted hue windows
+    alignas(64) float brl[kSimdTileSize];
+    alignas(64) float hs[kSimdTileSize];
+};
+
+/***************************************************
+ Linearize (input transfer functions)
+--------------------------------------------------*/
+template <int TF>
+inline float oetf(float x)
+{
+    switch (TF) {
+        case 1: return x <= 0.02740668f ? x/10.44426855f : simd_exp2f(x/0.07329248f - 7.0f) - 0.0075f;
+        case 2: return x < 0.075f ? (x-0.075f)/16.184376489665897f : simd_expf((x - 0.5520126568606655f)/0.09232902596577353f) - 0.0057048244042473785f;
+        case 3: return x <= 0.155251141552511f ? (x - 0.0729055341958355f)/10.5402377416545f : simd_exp2f(x*17.52f - 9.72f);
+        case 4: return x < 5.367655f*0.010591f + 0.092809f ? (x - 0.092809f)/5.367655f : (simd_pow10f((x - 0.385537f)/0.247190f) - 0.052272f)/5.555556f;
+        case 5: return x < -0.7774983977293537f ? x*0.3033266726886969f - 0.7774983977293537f : (simd_exp2f(14.0f*(x - 0.09286412512218964f)/0.9071358748778103f + 6.0f) - 64.0f)/2231.8263090676883f;
+        case 6: return x < 0.0f ? (x/15.1927f) - 0.01f : (simd_pow10f(x/0.224282f) - 1.0f)/155.975327f - 0.01f;
+        case 7: return x < 0.181f ? (x - 0.125f)/5.6f : simd_pow10f((x - 0.598206f)/0.241514f) - 0.00873f;
+        case 8: return x < 171.2102946929f/1023.0f ? (x*1023.0f - 95.0f)*0.01125f/(171.2102946929f - 95.0f) : (simd_pow10f(((x*1023.0f - 420.0f)/261.5f))*(0.18f + 0.01f) - 0.01f);
+        case 9: return x < 0.100686685370811f ? (x - 0.092864f)/8.799461f : (simd_pow10f(((x - 0.384316f)/0.245281f))/5.555556f - 0.064829f/5.555556f);
+        default: return x;
+    }
+}
+
+template <int TF>
+SIMD_STAGE void linearizeTile(Tile& t, int n)
+{
+    for (int i = 0; i < n; ++i) {
+        t.r[i] = oetf<TF>(t.r[i]);
+        t.g[i] = oetf<TF>(t.g[i]);
+        t.b[i] = oetf<TF>(t.b[i]);
+    }
+}
+
+static void linearize(Tile& t, int n, int tf)
+{
+    switch (tf) {
+        case 1: linearizeTile<1>(t, n); break;
+        case 2: linearizeTile<2>(t, n); break;
+        case 3: linearizeTile<3>(t, n); break;
+        case 4: linearizeTile<4>(t, n); break;
+        case 5: linearizeTile<5>(t, n); break;
+        case 6: linearizeTile<6>(t, n); break;
+        case 7: linearizeTile<7>(t, n); break;
+        case 8: linearizeTile<8>(t, n); break;
+        case 9: linearizeTile<9>(t, n); break;
+        default: break;
+    }
+}
+
+/***************************************************
+ Display encoding
+--------------------------------------------------*/
+SIMD_STAGE void encodeGamma(Tile& t, int n, float invGamma)
+{
+    for (int i = 0; i < n; ++i) {
+        t.r[i] = simd_powf(maxf(0.0f, t.r[i]), invGamma);
+        t.g[i] = simd_powf(maxf(0.0f, t.g[i]), invGamma);
+        t.b[i] = simd_powf(maxf(0.0f, t.b[i]), invGamma);
+    }
+}
+
+inline float pqInverse(float x)
+{
+    const float m1 = 2610.0f/16384.0f;
+    const float m2 = 2523.0f/32.0f;
+    const float c1 = 107.0f/128.0f;
+    const float c2 = 2413.0f/128.0f;
+    const float c3 = 2392.0f/128.0f;
+    x = simd_spowf(x, m1);
+    return simd_spowf((c1 + c2*x)/(1.0f + c3*x), m2);
+}
+
+SIMD_STAGE void encodePQ(Tile& t, int n)
+{
+    for (int i = 0; i < n; ++i) {
+        t.r[i] = pqInverse(t.r[i]);
+        t.g[i] = pqInverse(t.g[i]);
+        t.b[i] = pqInverse(t.b[i]);
+    }
+}
+
+inline float hlgInverse(float x)
+{
+    const float l = 0.17883277f*simd_logf(12.0f*x - 0.28466892f) + 0.55991073f;
+    return x <= 1.0f/12.0f ? sqrtf(3.0f*x) : l;
+}
+
+SIMD_STAGE void encodeHLG(Tile& t, int n)
+{
+    for (int i = 0; i < n; ++i) {
+        const float yd = 0.2627f*t.r[i] + 0.6780f*t.g[i] + 0.0593f*t.b[i];
+        const float sc = simd_powf(yd, (1.0f - 1.2f)/1.2f);
+        t.r[i] = hlgInverse(t.r[i]*sc);
+        t.g[i] = hlgInverse(t.g[i]*sc);
+        t.b[i] = hlgInverse(t.b[i]*sc);
+    }
+}
+
+/***************************************************
+ Kernel stages
+--------------------------------------------------*/
+// Input matrices, rendering space desaturation and offset
+SIMD_STAGE void inputStage(Tile& t, int n, const OpenDRTRenderPlan& k)
+{
+    const OpenDRTParams& p = k.params;
+    float m[9];
+    memcpy(m, k.inputMatrix, sizeof(m));
+    const float rw = k.rsW[0], gw = k.rsW[1], bw = k.rsW[2];
+    const float sa = p.rsSa, off = p.tnOff;
+    for (int i = 0; i < n; ++i) {
+        float r = t.r[i], g = t.g[i], b = t.b[i];
+        mul3x3(m, r, g, b);
+        const float satL = (r*rw + g*gw + b*bw)*sa;
+        t.r[i] = satL + r*(1.0f - sa) + off;
+        t.g[i] = satL + g*(1.0f - sa) + off;
+        t.b[i] = satL + b*(1.0f - sa) + off;
+    }
+}
+
+inline float toeCubic(float x, float m, float w)
+{
+    const float x2 = x*x;
+    return x*(x2 + m*w)/(x2 + w);
+}
+
+// Contrast low
+SIMD_STAGE void lconStage(Tile& t, int n, const OpenDRTRenderPlan& k)
+{
+    const float m = k.mconM, w = k.mconW, sc = k.mconCnstSc, e = 4.0f*k.params.tnLconPc;
+    // Without the per-channel blend the scale is purely ratio-preserving (ch == 1)
+    const float pcMix = k.lconPcMix;
+    for (int i = 0; i < n; ++i) {
+        const float r = t.r[i]*sc, g = t.g[i]*sc, b = t.b[i]*sc;
+        const float cr = maxf(r, 0.0f), cg = maxf(g, 0.0f), cb = maxf(b, 0.0f);
+        const float nm2 = (cr*cr + cg*cg + cb*cb)/3.0f;
+        const float msc = (nm2 + m*w)/(nm2 + w);
+        const float chb = clamp01(1.0f - sdivf(minf(r, minf(g, b)), maxf(r, maxf(g, b))));
+        const float ch = 1.0f + pcMix*(simd_powf(chb, e) - 1.0f);
+        t.r[i] = r*msc*ch + toeCubic(r, m, w)*(1.0f - ch);
+        t.g[i] = g*msc*ch + toeCubic(g, m, w)*(1.0f - ch);
+        t.b[i] = b*msc*ch + toeCubic(b, m, w)*(1.0f - ch);
+    }
+}
+
+// Filmic dynamic range compression (beta)
+SIMD_STAGE void filmicStage(Tile& t, int n, const OpenDRTRenderPlan& k)
+{
+    const float inv = k.filmicInvMaxIn, s = k.filmicS, e = k.filmicP, mo = k.filmicMaxOut;
+    const float st = k.params.filmicStrength;
+    for (int i = 0; i < n; ++i) {
+        const float r = t.r[i]*inv, g = t.g[i]*inv, b = t.b[i]*inv;
+        t.r[i] = t.r[i]*(1.0f - st) + simd_spowf(r/(r + s), e)*mo*st;
+        t.g[i] = t.g[i]*(1.0f - st) + simd_spowf(g/(g + s), e)*mo*st;
+        t.b[i] = t.b[i]*(1.0f - st) + simd_spowf(b/(b + s), e)*mo*st;
+    }
+}
+
+// Tonescale norm, purity norm and RGB ratios
+SIMD_STAGE void normStage(Tile& t, int n, const OpenDRTRenderPlan& k)
+{
+    const float wr = k.params.ptR, wg = k.params.ptG, wb = k.params.ptB;
+    for (int i = 0; i < n; ++i) {
+        const float r = t.r[i], g = t.g[i], b = t.b[i];
+        const float cr = maxf(r, 0.0f), cg = maxf(g, 0.0f), cb = maxf(b, 0.0f);
+        const float tsn = sqrtf(cr*cr + cg*cg + cb*cb)/kSqrt3;
+        t.pt[i] = sqrtf(maxf(0.0f, r*r*wr + g*g*wg + b*b*wb));
+        t.tsn[i] = tsn;
+        // One shared reciprocal: three sdivf() selects on the same test get jump-threaded
+        const float inv = sdivf(1.0f, tsn);
+        t.r[i] = maxf(r, -2.0f)*inv;
+        t.g[i] = maxf(g, -2.0f)*inv;
+        t.b[i] = maxf(b, -2.0f)*inv;
+    }
+}
+
+// Contrast high
+SIMD_STAGE void hconStage(Tile& t, int n, const OpenDRTRenderPlan& k)
+{
+    const float hp = k.hconP, x0 = k.hconX0, o = k.hconO, s0 = k.hconS0;
+    const float x1 = k.hconX1, k1 = k.hconK1, y1 = k.hconY1;
+    for (int i = 0; i < n; ++i) {
+        const float tsn = t.tsn[i], pt = t.pt[i];
+        const float rt = tsn > x1 ? k1*(tsn - x1) + y1 : s0*simd_powf(tsn, hp) + o;
+        const float rp = pt > x1 ? k1*(pt - x1) + y1 : s0*simd_powf(pt, hp) + o;
+        t.tsn[i] = tsn < x0 ? tsn : rt;
+        t.pt[i] = pt < x0 ? pt : rp;
+    }
+}
+
+// Tonescale
+SIMD_STAGE void tonescaleStage(Tile& t, int n, const OpenDRTRenderPlan& k)
+{
+    const float s = k.params.ts_s, s1 = k.params.ts_s1, con = k.params.tnCon;
+    for (int i = 0; i < n; ++i) {
+        const float tsn = t.tsn[i], pt = t.pt[i];
+        t.tsn[i] = simd_spowf(tsn/(tsn + s), con);
+        t.pt[i] = simd_spowf(pt/(pt + s1), con);
+    }
+}
+
+// Contrast high and tonescale through the frame's tables (OpenDRTTonescaleTables.h).
+// Returns false, leaving the tile untouched, if a norm is above the table range or NaN.
+SIMD_STAGE bool tonescaleTableStage(Tile& t, int n, const OpenDRTRenderPlan& k)
+{
+    const uint32_t top = (uint32_t)asint((float)(1 << kTonescaleTableMaxStop));
+    uint32_t over = 0;
+    for (int i = 0; i < n; ++i) {
+        over |= (uint32_t)asint(t.tsn[i]) >= top ? 1u : 0u;
+        over |= (uint32_t)asint(t.pt[i]) >= top ? 1u : 0u;
+    }
+    if (over) return false;
+
+    const float* tsTable = k.tsTable;
+    const float* ptTable = k.ptTable;
+    const int shift = 23 - k.tsTableBits;
+    const int32_t base = asint(1.0f/(1 << -kTonescaleTableMinStop)), mask = (1 << shift) - 1;
+    const float fracScale = 1.0f/(1 << shift);
+    const float tsSlope = k.tsTableSlope[0], ptSlope = k.tsTableSlope[1];
+    for (int i = 0; i < n; ++i) {
+        const float tsn = t.tsn[i], pt = t.pt[i];
+        const int32_t tr = asint(tsn) - base, pr = asint(pt) - base;
+        const int32_t ti = (tr < 0 ? 0 : tr) >> shift, pi = (pr < 0 ? 0 : pr) >> shift;
+        const float tf = (float)(tr & mask)*fracScale, pf = (float)(pr & mask)*fracScale;
+        const float tv = tsTable[ti] + (tsTable[ti + 1] - tsTable[ti])*tf;
+        const float pv = ptTable[pi] + (ptTable[pi + 1] - ptTable[pi])*pf;
+        t.tsn[i] = tr < 0 ? tsn*tsSlope : tv;
+        t.pt[i] = pr < 0 ? pt*ptSlope : pv;
+    }
+    return true;
+}
+
+// Opponent space and purity compression range
+SIMD_STAGE void hueStage(Tile& t, int n, const OpenDRTRenderPlan& k)
+{
+    const float invRngLow = 1.0f/k.params.ptRngLow, rngHigh = k.params.ptRngHigh;
+    const bool rngHighLow = rngHigh < 1.0f;
+    for (int i = 0; i < n; ++i) {
+        const float r = t.r[i], g = t.g[i], b = t.b[i];
+        const float cy = r - b;
+        const float gm = g - (r + b)/2.0f;
+        float achD = sqrtf(maxf(0.0f, cy*cy + gm*gm))/kSqrt3;
+        achD = 1.25f*(achD*achD/(achD + 0.25f));
+        t.achD[i] = achD;
+
+        // Purity compression range
+        const float cmp = 1.0f - simd_powf(t.pt[i], invRngLow);
+        float hf = minf(1.0f, achD/1.2f);
+        hf *= hf;
+        hf = rngHighLow ? 1.0f - hf : hf;
+        t.ptCmp[i] = simd_powf(cmp, rngHigh)*(1.0f - hf) + cmp*hf;
+    }
+}
+
+// Hue angle windows, weighted per OpenDRTHueChannel
+SIMD_STAGE void hueWindowStage(Tile& t, int n, const OpenDRTRenderPlan& k)
+{
+    float w[kHueChannels][6];
+    memcpy(w, k.hueWeights, sizeof(w));
+    for (int i = 0; i < n; ++i) {
+        const float r = t.r[i], g = t.g[i], b = t.b[i];
+
+        // Hue angle, rotated so that red = 0.0
+        const float h = simd_atan2f(r - b, g - (r + b)/2.0f) + kPi + 1.10714931f;
+        const float hue = h >= 2.0f*kPi ? h - 2.0f*kPi : h;
+        const float ha[6] = {
+            gauss_hue(hue, 0.1f, 0.9f), gauss_hue(hue, 4.3f, 0.9f), gauss_hue(hue, 2.3f, 0.9f),
+            gauss_hue(hue, 3.3f, 0.6f), gauss_hue(hue, 1.3f, 0.6f), gauss_hue(hue, -1.2f, 0.6f)
+        };
+        for (int c = 0; c < kHueChannels; ++c) {
+            t.hue[c][i] = w[c][0]*ha[0] + w[c][1]*ha[1] + w[c][2]*ha[2] + w[c][3]*ha[3] + w[c][4]*ha[4] + w[c][5]*ha[5];
+        }
+    }
+}
+
+// The lookups below are scalar loads (GCC's generic tuning emits no gather instructions):
+// 3x faster than the windows without AVX and 1.4x with AVX2, but slower than the 16-wide
+// windows with AVX-512, so that build keeps the windows.
+#ifdef __AVX512F__
+static const bool kHueTableLookup = false;
+#else
+static const bool kHueTableLookup = true;
+#endif
+
+// The same through the frame's table (OpenDRTHueTables.h), indexed by the pseudo-angle
+// v/(|u| + |v|) unfolded to [0, 4] instead of the hue angle. (u, v) is the opponent
+// vector turned so that u points along hue 0, at atan2 = pi - 1.10714931 exactly: red
+// clipped onto the primary sits 6e-7 past it, and must stay on that side of the jump.
+SIMD_STAGE void hueTableStage(Tile& t, int n, const OpenDRTRenderPlan& k)
+{
+    const float* table = k.hueTable;
+    const int size = kHueTableSize + 2;
+    const float scale = kHueTableSize/4.0f;
+    for (int i = 0; i < n; ++i) {
+        const float r = t.r[i], g = t.g[i], b = t.b[i];
+        const float cy = r - b;
+        const float gm = g - (r + b)/2.0f;
+        const float u = 0.894427456f*cy - 0.447213066f*gm;
+        const float v = -0.894427456f*gm - 0.447213066f*cy;
+        const float p = sdivf(v, fabsf(u) + fabsf(v));
+        const float q = u < 0.0f ? 2.0f - p : (v < 0.0f ? 4.0f + p : p);
+        const float x = minf(maxf(q*scale, 0.0f), (float)kHueTableSize);   // NaN -> 0
+        const int j = (int)x;
+        const float f = x - (float)j;
+        t.hue[kHueBrl][i] = lerpTable(table, kHueBrl*size + j, f);
+        t.hue[kHueHc][i] = lerpTable(table, kHueHc*size + j, f);
+        t.hue[kHueRgbR][i] = lerpTable(table, kHueRgbR*size + j, f);
+        t.hue[kHueRgbG][i] = lerpTable(table, kHueRgbG*size + j, f);
+        t.hue[kHueCmyR][i] = lerpTable(table, kHueCmyR*size + j, f);
+        t.hue[kHueCmyG][i] = lerpTable(table, kHueCmyG*size + j, f);
+    }
+}
+
+// Brilliance
+SIMD_STAGE void brillianceStage(Tile& t, int n, const OpenDRTRenderPlan& k)
+{
+    const float thr = k.brlThr, sm = k.brlM, rng = 1.0f - k.params.brlRng;
+    for (int i = 0; i < n; ++i) {
+        float f = t.hue[kHueBrl][i];
+        f = (1.0f - t.achD[i])*f + 1.0f - f;
+        f = softplus(f, 0.25f, thr, sm);
+        const float ts = f > 1.0f ? 1.0f - t.pt[i] : t.pt[i];
+        const float lim = simd_spowf(ts, rng);
+        t.brl[i] = maxf(0.0f, minf(2.0f, f*lim + 1.0f - lim));
+    }
+}
+
+// Mid-range purity, folded straight into ptCmp
+SIMD_STAGE void midPurityStage(Tile& t, int n, const OpenDRTRenderPlan& k)
+{
+    const OpenDRTParams& p = k.params;
+    const float lowE = 1.0f/p.ptmLowSt, highE = 1.0f/p.ptmHighSt;
+    const float low = p.ptmLow, high = p.ptmHigh;
+    for (int i = 0; i < n; ++i) {
+        const float achD = t.achD[i], pt = t.pt[i];
+        float sc = sigmoid_cubic(1.0f - simd_spowf(1.0f - achD, lowE), low*(1.0f - pt));
+        const float d = (1.0f - simd_spowf(1.0f - achD, highE))*(1.0f - pt) + achD*achD*pt;
+        sc *= sigmoid_cubic(d, high*pt);
+        t.ptCmp[i] *= maxf(0.0f, sc);
+    }
+}
+
+static void fillTile(float* a, int n, float v)
+{
+    for (int i = 0; i < n; ++i) a[i] = v;
+}
+
+// Hue contrast, hue shifts, module application and inverse rendering space.
+// Disabled modules have zero hue weights so the loop stays branch-free
+// (hue shift RGB is also disabled by a zero t.hs, see hueShiftRangeStage()).
+SIMD_STAGE void hueShiftRangeStage(Tile& t, int n, const OpenDRTRenderPlan& k)
+{
+    const float e = 1.0f/k.params.hsRgbRng;
+    for (int i = 0; i < n; ++i) t.hs[i] = simd_powf(t.pt[i], e);
+}
+
+SIMD_STAGE void chromaStage(Tile& t, int n, const OpenDRTRenderPlan& k)
+{
+    const float rw = k.rsW[0], gw = k.rsW[1], bw = k.rsW[2];
+    const float sa = k.params.rsSa;
+    for (int i = 0; i < n; ++i) {
+        const float achD = t.achD[i], pt = t.pt[i];
+        float r = t.r[i], g = t.g[i], b = t.b[i];
+
+        // Hue angle premultiplication
+        const float cmySc = 1.5f*(achD*achD/(achD + 0.5f));
+
+        // Hue contrast R
+        float hcTs = 1.0f - pt;
+        const float hcC = ((1.0f - achD)*hcTs + achD*(1.0f - hcTs))*t.hue[kHueHc][i]*achD;
+        hcTs *= hcTs;
+        const float hcF = hcC - 2.0f*hcC*hcTs + 1.0f;
+        g *= hcF;
+        b *= hcF;
+
+        // Hue shift RGB
+        const float hs = t.hs[i]*achD;
+        const float rgbR = t.hue[kHueRgbR][i]*hs, rgbG = t.hue[kHueRgbG][i]*hs;
+        r += rgbR;
+        g += rgbG;
+        b -= rgbR + rgbG;
+
+        // Hue shift CMY
+        const float cs = cmySc*(1.0f - pt);
+        const float cmyR = t.hue[kHueCmyR][i]*cs, cmyG = t.hue[kHueCmyG][i]*cs;
+        r += cmyR;
+        g += cmyG;
+        b -= cmyR + cmyG;
+
+        // Brilliance, purity compression and mid purity
+        const float brl = t.brl[i], cmp = t.ptCmp[i];
+        r = r*brl*cmp + 1.0f - cmp;
+        g = g*brl*cmp + 1.0f - cmp;
+        b = b*brl*cmp + 1.0f - cmp;
+
+        // Inverse rendering space
+        const float satL = (r*rw + g*gw + b*bw)*sa;
+        t.r[i] = (satL - r)/(sa - 1.0f);
+        t.g[i] = (satL - g)/(sa - 1.0f);
+        t.b[i] = (satL - b)/(sa - 1.0f);
+    }
+}
+
+// Creative white point mix
+SIMD_STAGE void whitepointStage(Tile& t, int n, const OpenDRTRenderPlan& k)
+{
+    float cm[9], bm[9];
+    memcpy(cm, k.cwpMatrix, sizeof(cm));
+    memcpy(bm, k.displayMatrix, sizeof(bm));
+    const float e = 1.0f - k.params.cwpRng;
+    for (int i = 0; i < n; ++i) {
+        float r = t.r[i], g = t.g[i], b = t.b[i];
+        float cr = r, cg = g, cb = b;
+        mul3x3(cm, cr, cg, cb);
+        mul3x3(bm, r, g, b);
+        const float f = simd_powf(t.tsn[i], e);
+        t.r[i] = cr*f + r*(1.0f - f);
+        t.g[i] = cg*f + g*(1.0f - f);
+        t.b[i] = cb*f + b*(1.0f - f);
+    }
+}
+
+// Purity compress low. With Above the tile is known to lie above the thresholds of the
+// per-channel softplus() calls (purityLowAbove()), which then return their input: their
+// log and exp are skipped for the same result.
+template <bool Above>
+SIMD_STAGE void purityLowStage(Tile& t, int n, const OpenDRTRenderPlan& k)
+{
+    const float t0 = k.ptlThr[0], t1 = k.ptlThr[1], t2 = k.ptlThr[2], t3 = k.ptlThr[3];
+    const float m0 = k.ptlM[0], m1 = k.ptlM[1], m2 = k.ptlM[2], m3 = k.ptlM[3];
+    for (int i = 0; i < n; ++i) {
+        const float r = t.r[i], g = t.g[i], b = t.b[i];
+        const float sum0 = softplus(r, 0.2f, t0, m0) + g + softplus(b, 0.2f, t0, m0);
+        const float sr = Above ? r : softplus(r, 0.04f, t1, m1);
+        const float sg = Above ? g : softplus(g, 0.06f, t2, m2);
+        const float sb = Above ? b : softplus(b, 0.01f, t3, m3);
+        const float nrm = minf(1.0f, sdivf(sum0, sr + sg + sb));
+        t.r[i] = sr*nrm;
+        t.g[i] = sg*nrm;
+        t.b[i] = sb*nrm;
+    }
+}
+
+// Tile class for purityLowStage(): every channel of every pixel above its per-channel
+// softplus() threshold, which holds for most tiles of ordinary footage. NaN is not above.
+SIMD_STAGE bool purityLowAbove(const Tile& t, int n, const OpenDRTRenderPlan& k)
+{
+    const float t1 = k.ptlThr[1], t2 = k.ptlThr[2], t3 = k.ptlThr[3];
+    int below = 0;
+    for (int i = 0; i < n; ++i) below |= !(t.r[i] > t1) | !(t.g[i] > t2) | !(t.b[i] > t3);
+    return below == 0;
+}
+
+// Final tonescale, clamp and Rec.2020 conversion (encoding follows in processTile). The
+// gamut counts for the scopes are taken on the way, before the clamp.
+SIMD_STAGE void outputStage(Tile& t, int n, const OpenDRTRenderPlan& k, OpenDRTScopes* p_Scopes)
+{
+    const OpenDRTParams& p = k.params;
+    const float m2 = p.ts_m2, toe = p.tnToe, dsc = p.ts_dsc;
+    const bool hasToe = toe != 0.0f, clamp = p.clamp != 0;
+    int negative = 0, outOfGamut = 0;
+    for (int i = 0; i < n; ++i) {
+        float tsn = t.tsn[i]*m2;
+        tsn = hasToe ? tsn*tsn/(tsn + toe) : tsn;
+        tsn *= dsc;
+        float r = t.r[i]*tsn, g = t.g[i]*tsn, b = t.b[i]*tsn;
+        const float lo = minf(r, minf(g, b)), hi = maxf(r, maxf(g, b));
+        negative += lo < 0.0f;
+        outOfGamut += (lo < 0.0f) | (hi > 1.0f);
+        r = clamp ? clamp01(r) : r;
+        g = clamp ? clamp01(g) : g;
+        b = clamp ? clamp01(b) : b;
+        t.r[i] = r;
+        t.g[i] = g;
+        t.b[i] = b;
+    }
+
+    if (k.rec2020) {
+        float m[9];
+        memcpy(m, k.rec2020Matrix, sizeof(m));
+        for (int i = 0; i < n; ++i) {
+            float r = maxf(t.r[i], 0.0f), g = maxf(t.g[i], 0.0f), b = maxf(t.b[i], 0.0f);
+            mul3x3(m, r, g, b);
+            t.r[i] = r;
+            t.g[i] = g;
+            t.b[i] = b;
+        }
+    }
+
+    if (p_Scopes) {
+        p_Scopes->negative += negative;
+        p_Scopes->outOfGamut += outOfGamut;
+    }
+}
+
+/***************************************************
+ Tile driver
+--------------------------------------------------*/
+// The scene side: everything up to the RGB ratios, norms and hue windows, none of which
+// depends on the display peak, gamut or encoding (see sameSceneSide())
+template <unsigned M>
+static void processSceneTile(Tile& t, int n, const OpenDRTRenderPlan& k, int p_InOetf)
+{
+    linearize(t, n, p_InOetf);
+    inputStage(t, n, k);
+    if (OPENDRT_MODULE_ON(M, k, kModuleLcon)) lconStage(t, n, k);
+    if (OPENDRT_MODULE_ON(M, k, kModuleFilmic)) filmicStage(t, n, k);
+    normStage(t, n, k);
+    if (OPENDRT_MODULE_ON(M, k, kModuleBrl | kModuleHc | kModuleHsRgb | kModuleHsCmy)) {
+        if (kHueTableLookup && k.hueTable) hueTableStage(t, n, k);
+        else hueWindowStage(t, n, k);
+    }
+    else {
+        for (int c = 0; c < kHueChannels; ++c) fillTile(t.hue[c], n, 0.0f);
+    }
+}
+
+// The display side, from the tonescale on
+template <unsigned M>
+static void processDisplayTile(Tile& t, int n, const OpenDRTRenderPlan& k, OpenDRTScopes* p_Scopes)
+{
+    if (!k.tsTable || !tonescaleTableStage(t, n, k)) {
+        if (OPENDRT_MODULE_ON(M, k, kModuleHcon)) hconStage(t, n, k);
+        tonescaleStage(t, n, k);
+    }
+    hueStage(t, n, k);
+    if (OPENDRT_MODULE_ON(M, k, kModuleBrl)) brillianceStage(t, n, k);
+    else fillTile(t.brl, n, 1.0f);
+    if (OPENDRT_MODULE_ON(M, k, kModulePtm)) midPurityStage(t, n, k);
+    if (OPENDRT_MODULE_ON(M, k, kModuleHsRgb)) hueShiftRangeStage(t, n, k);
+    else fillTile(t.hs, n, 0.0f);
+    chromaStage(t, n, k);
+    whitepointStage(t, n, k);
+    if (OPENDRT_MODULE_ON(M, k, kModulePtl)) {
+        if (purityLowAbove(t, n, k)) purityLowStage<true>(t, n, k);
+        else purityLowStage<false>(t, n, k);
+    }
+    outputStage(t, n, k, p_Scopes);
+
+    switch (k.params.eotf) {
+        case 1: encodeGamma(t, n, 1.0f/2.2f); break;
+        case 2: encodeGamma(t, n, 1.0f/2.4f); break;
+        case 3: encodeGamma(t, n, 1.0f/2.6f); break;
+        case 4: encodePQ(t, n); break;
+        case 5: encodeHLG(t, n); break;
+        default: break;
+    }
+}
+
+template <unsigned M>
+static void processTile(Tile& t, int n, const OpenDRTRenderPlan& k, int p_InOetf, OpenDRTScopes* p_Scopes)
+{
+    processSceneTile<M>(t, n, k, p_InOetf);
+    processDisplayTile<M>(t, n, k, p_Scopes);
+}
+
+// Deinterleave RGBA into the tile
+static void loadTile(Tile& t, int n, const float* p_Input)
+{
+    for (int i = 0; i < n; ++i) {
+        t.r[i] = p_Input[4*i];
+        t.g[i] = p_Input[4*i + 1];
+        t.b[i] = p_Input[4*i + 2];
+        t.a[i] = p_Input[4*i + 3];
+    }
+}
+
+// Interleave back into RGBA
+static void storeTile(const Tile& t, int n, float* p_Output)
+{
+    for (int i = 0; i < n; ++i) {
+        p_Output[4*i] = t.r[i];
+        p_Output[4*i + 1] = t.g[i];
+        p_Output[4*i + 2] = t.b[i];
+        p_Output[4*i + 3] = t.a[i];
+    }
+}
+
+template <unsigned M>
+static void processTiles(int p_X1, int p_X2, const float* p_Input, float* p_Output, const OpenDRTRenderPlan& p_Plan,
+                         int p_InOetf, OpenDRTScopes* p_Scopes)
+{
+    Tile t;
+    for (int x = p_X1; x < p_X2; x += kSimdTileSize) {
+        const int n = p_X2 - x < kSimdTileSize ? p_X2 - x : kSimdTileSize;
+        loadTile(t, n, p_Input);
+        processTile<M>(t, n, p_Plan, p_InOetf, p_Scopes);
+        storeTile(t, n, p_Output);
+        p_Input += 4*n;
+        p_Output += 4*n;
+    }
+}
+
+// p_InOetf is the plan's input transfer function, or 0 for input already linearized
+static void processRow(int p_X1, int p_X2, const float* p_Input, float* p_Output, const OpenDRTRenderPlan& p_Plan,
+                       int p_InOetf, OpenDRTScopes* p_Scopes)
+{
+#define OPENDRT_PROCESS_TILES(MASK) \
+    case (MASK): processTiles<(MASK)>(p_X1, p_X2, p_Input, p_Output, p_Plan, p_InOetf, p_Scopes); break;
+
+    switch (p_Plan.kernelModules) {
+        OPENDRT_SPECIALIZED_MODULES(OPENDRT_PROCESS_TILES)
+        default: processTiles<kModulesDynamic>(p_X1, p_X2, p_Input, p_Output, p_Plan, p_InOetf, p_Scopes); break;
+    }
+#undef OPENDRT_PROCESS_TILES
+}
+
+// Either kernel over up to a tile of pixels
+static void processKernelSpan(int p_X1, int p_X2, const float* p_Input, float* p_Output, const OpenDRTRenderPlan& p_Plan,
+                              int p_InOetf, OpenDRTScopes* p_Scopes)
+{
+    if (runsScalar(p_Plan)) RunCPUKernelRow(p_X1, p_X2, p_Input, p_Output, p_Plan, p_Scopes);
+    else processRow(p_X1, p_X2, p_Input, p_Output, p_Plan, p_InOetf, p_Scopes);
+}
+
+/***************************************************
+ Tile classes
+--------------------------------------------------*/
+// Tiles are classified by cheap bounds checks and go through the least kernel their class
+// needs. The classes are bounds under which the skipped work leaves the math unchanged,
+// so the output does not depend on which tile a pixel fell in beyond a few ULP:
+// - uniform: every pixel has the RGB of the first (black bars, flat fills), so the first
+//   is transformed and copied. It goes through the stages' one-lane remainder rather
+//   than a full vector, which the compiler may contract into FMAs differently, so the
+//   copies can differ from a full-kernel pass in the last few bits.
+// - above the purity low knees: purityLowStage() without its per-channel softplus() calls,
+//   see purityLowAbove()
+// - everything else: the full kernel
+// A neutral-only class is not among them: neutral input is not exactly neutral after the
+// input matrix, so every pixel still needs its hue terms.
+
+// True if every pixel of the span has the RGB bits of the first; alpha may differ
+static bool uniformSpan(const float* p_Input, int n)
+{
+    uint32_t first[3], rgb[3];
+    memcpy(first, p_Input, sizeof(first));
+    for (int i = 1; i < n; ++i) {
+        memcpy(rgb, p_Input + 4*i, sizeof(rgb));
+        if (rgb[0] != first[0] || rgb[1] != first[1] || rgb[2] != first[2]) return false;
+    }
+    return true;
+}
+
+static void processTileSpan(int p_X1, int p_X2, const float* p_Input, float* p_Output, const OpenDRTRenderPlan& p_Plan,
+                            int p_InOetf, OpenDRTScopes* p_Scopes)
+{
+    const int n = p_X2 - p_X1;
+    if (n < 2 || !uniformSpan(p_Input, n)) {
+        processKernelSpan(p_X1, p_X2, p_Input, p_Output, p_Plan, p_InOetf, p_Scopes);
+        return;
+    }
+
+    // The kernel's gamut counts for the one pixel stand for all of them
+    const uint64_t negative = p_Scopes ? p_Scopes->negative : 0;
+    const uint64_t outOfGamut = p_Scopes ? p_Scopes->outOfGamut : 0;
+    processKernelSpan(p_X1, p_X1 + 1, p_Input, p_Output, p_Plan, p_InOetf, p_Scopes);
+    if (p_Scopes) {
+        p_Scopes->negative += (p_Scopes->negative - negative)*(n - 1);
+        p_Scopes->outOfGamut += (p_Scopes->outOfGamut - outOfGamut)*(n - 1);
+    }
+    for (int i = 1; i < n; ++i) {
+        memcpy(p_Output + 4*i, p_Output, 3*sizeof(float));
+        p_Output[4*i + 3] = p_Input[4*i + 3];
+    }
+}
+
+/***************************************************
+ Memoization
+--------------------------------------------------*/
+// Up to a tile of pixels through the kernel, reusing results for repeated colours
+// (OpenDRTColorCache.h). Pixels that neither repeat the pixel before nor hit the cache are
+// compacted and transformed together; the cache learns them only after every pixel has
+// its result, as a miss may evict a slot a hit earlier in the tile still points at.
+// A tile with no cache hits rests the cache for the next kColorCacheBackoff tiles, so
+// footage without repeated colours pays little more than the run check.
+// Compaction moves a miss to another lane, and maybe into the stages' scalar remainder,
+// so its result agrees with the uncached kernel's to a few ULP rather than bit for bit.
+static void processMemoized(int p_X, int n, const float* p_Input, float* p_Output, const OpenDRTRenderPlan& p_Plan,
+                            int p_InOetf, OpenDRTColorCache& p_Cache)
+{
+    const bool probe = p_Cache.backoff == 0;
+    int missIndex[kSimdTileSize];  // pixel of each miss
+    int missSlot[kSimdTileSize];
+    int source[kSimdTileSize];     // per pixel: index of its miss, or -1 - the cache slot it hit
+    uint32_t key[4] = { 0, 0, 0, (uint32_t)p_InOetf }, last[3];
+    int misses = 0, runHits = 0, cacheHits = 0;
+
+    for (int i = 0; i < n; ++i) {
+        memcpy(key, p_Input + 4*i, 3*sizeof(float));
+        if (i > 0 && key[0] == last[0] && key[1] == last[1] && key[2] == last[2]) {
+            source[i] = source[i - 1];
+            ++runHits;
+            continue;
+        }
+        memcpy(last, key, sizeof(last));
+
+        if (probe) {
+            const int slot = colorCacheSlot(key);
+            if (memcmp(p_Cache.keys[slot], key, sizeof(key)) == 0) {
+                source[i] = -1 - slot;
+                ++cacheHits;
+                continue;
+            }
+            missSlot[misses] = slot;
+        }
+        missIndex[misses] = i;
+        source[i] = misses++;
+    }
+
+    // With nothing to reuse the tile runs in place, else the misses run compacted
+    const bool inPlace = misses == n;
+    float missIn[4*kSimdTileSize], missOut[4*kSimdTileSize];
+    if (inPlace) {
+        processTileSpan(p_X, p_X + n, p_Input, p_Output, p_Plan, p_InOetf, 0);
+    }
+    else {
+        for (int j = 0; j < misses; ++j) memcpy(missIn + 4*j, p_Input + 4*missIndex[j], 4*sizeof(float));
+        if (misses) processTileSpan(p_X, p_X + misses, missIn, missOut, p_Plan, p_InOetf, 0);
+        for (int i = 0; i < n; ++i) {
+            const float* rgb = source[i] >= 0 ? missOut + 4*source[i] : p_Cache.values[-1 - source[i]];
+            p_Output[4*i] = rgb[0];
+            p_Output[4*i + 1] = rgb[1];
+            p_Output[4*i + 2] = rgb[2];
+            p_Output[4*i + 3] = p_Input[4*i + 3];
+        }
+    }
+
+    if (probe) {
+        for (int j = 0; j < misses; ++j) {
+            const int slot = missSlot[j];
+            memcpy(p_Cache.keys[slot], p_Input + 4*missIndex[j], 3*sizeof(float));
+            p_Cache.keys[slot][3] = (uint32_t)p_InOetf;
+            memcpy(p_Cache.values[slot], inPlace ? p_Output + 4*missIndex[j] : missOut + 4*j, 3*sizeof(float));
+        }
+        if (cacheHits == 0) p_Cache.backoff = kColorCacheBackoff;
+    }
+    else {
+        --p_Cache.backoff;
+    }
+
+    p_Cache.stats.pixels += n;
+    p_Cache.stats.runHits += runHits;
+    p_Cache.stats.cacheHits += cacheHits;
+}
+
+/***************************************************
+ Frame patterns
+--------------------------------------------------*/
+// A span of row p_Y through the kernel, with the test patterns and the tonescale overlay
+// drawn around it (OpenDRTOverlay.h). Pattern pixels are generated in the input encoding,
+// so they are always linearized with the plan's transfer function. The scopes, if asked
+// for, read each tile's output while it is still in cache; the kernel's gamut counts are
+// per pixel, so nothing is memoized while they are gathered.
+static void processSpan(int p_Width, int p_Height, int p_X1, int p_X2, int p_Y,
+                        const float* p_Input, float* p_Output, const OpenDRTRenderPlan& p_Plan, int p_InOetf,
+                        OpenDRTScopes* p_Scopes, OpenDRTColorCache* p_Cache)
+{
+    const bool pattern = hasTestPattern(p_Plan.params, p_Y);
+    OpenDRTColorCache* cache = p_Scopes ? 0 : p_Cache;
+    float patternRGBA[4*kSimdTileSize];
+    for (int x = p_X1; x < p_X2; x += kSimdTileSize) {
+        const int n = p_X2 - x < kSimdTileSize ? p_X2 - x : kSimdTileSize;
+        const float* in = p_Input;
+        int inOetf = p_InOetf;
+        if (pattern) {
+            fillTestPattern(p_Width, p_Height, x, x + n, p_Y, p_Input, patternRGBA, p_Plan.params);
+            in = patternRGBA;
+            inOetf = p_Plan.params.inOetf;
+        }
+        if (cache) processMemoized(x, n, in, p_Output, p_Plan, inOetf, *cache);
+        else processTileSpan(x, x + n, in, p_Output, p_Plan, inOetf, p_Scopes);
+        if (p_Plan.overlay) compositeOverlay(*p_Plan.overlay, x, x + n, p_Y, p_Output);
+        if (p_Scopes) accumulateScopes(*p_Scopes, p_Output, x, x + n, p_Width);
+        p_Input += 4*n;
+        p_Output += 4*n;
+    }
+}
+
+void processRow(int p_Width, int p_Height, int p_X1, int p_X2, int p_Y,
+                const float* p_Input, float* p_Output, const OpenDRTRenderPlan& p_Plan, OpenDRTScopes* p_Scopes,
+                OpenDRTColorCache* p_Cache)
+{
+    processSpan(p_Width, p_Height, p_X1, p_X2, p_Y, p_Input, p_Output, p_Plan, p_Plan.params.inOetf, p_Scopes, p_Cache);
+}
+
+// Half-float rows go through the float kernel a tile at a time; the conversions stay in L1
+void processRowHalf(int p_Width, int p_Height, int p_X1, int p_X2, int p_Y,
+                    const uint16_t* p_Input, uint16_t* p_Output, const OpenDRTRenderPlan& p_Plan, OpenDRTScopes* p_Scopes,
+                    OpenDRTColorCache* p_Cache)
+{
+    float in[4*kSimdTileSize], out[4*kSimdTileSize];
+    for (int x = p_X1; x < p_X2; x += kSimdTileSize) {
+        const int n = p_X2 - x < kSimdTileSize ? p_X2 - x : kSimdTileSize;
+        simd_half_to_float_n(p_Input, in, 4*n);
+        processSpan(p_Width, p_Height, x, x + n, p_Y, in, out, p_Plan, p_Plan.params.inOetf, p_Scopes, p_Cache);
+        simd_float_to_half_n(out, p_Output, 4*n);
+        p_Input += 4*n;
+        p_Output += 4*n;
+    }
+}
+
+/***************************************************
+ Integer images
+--------------------------------------------------*/
+// Full-range code values to [0, 1]
+template <typename T>
+static void intToFloat(const T* p_In, float* p_Out, int p_Count, float p_Scale)
+{
+    for (int i = 0; i < p_Count; ++i) p_Out[i] = (float)p_In[i]*p_Scale;
+}
+
+// Quantizes display-encoded RGB to e.codeBits code values with the dither thresholds for
+// frame row p_Y from column p_X, and rounds alpha to the container
+template <typename T>
+static void floatToInt(const float* p_In, T* p_Out, int n, int p_X, int p_Y, const OpenDRTIntEncode& e)
+{
+    const int codeMax = (1 << e.codeBits) - 1;
+    const int containerMax = (1 << e.containerBits) - 1;
+    const float black = e.legalRange ? (float)(16 << (e.codeBits - 8)) : 0.0f;
+    const float scale = e.legalRange ? (float)(219 << (e.codeBits - 8)) : (float)codeMax;
+    const int up = e.containerBits - e.codeBits, down = e.codeBits - up;
+
+    // Thresholds along the row, wrapping every kDitherSize pixels
+    float threshold[kSimdTileSize];
+    const float* row = e.dither ? e.dither + (p_Y & (kDitherSize - 1))*kDitherSize : 0;
+    for (int i = 0; i < n; ++i) threshold[i] = row ? row[(p_X + i) & (kDitherSize - 1)] : 0.5f;
+
+    for (int i = 0; i < n; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            const float v = minf(maxf(p_In[4*i + c]*scale + black + threshold[i], 0.0f), (float)codeMax);
+            const int q = (int)v;
+            p_Out[4*i + c] = (T)(up ? (q << up) | (q >> down) : q);
+        }
+        const float a = minf(maxf(p_In[4*i + 3]*(float)containerMax + 0.5f, 0.0f), (float)containerMax);
+        p_Out[4*i + 3] = (T)(int)a;
+    }
+}
+
+// 16-bit code values straight to linear through the plan's input table; alpha as above
+static void linearizeCodes(const uint16_t* p_In, float* p_Out, int n, const float* p_Table)
+{
+    for (int i = 0; i < n; ++i) {
+        p_Out[4*i] = p_Table[p_In[4*i]];
+        p_Out[4*i + 1] = p_Table[p_In[4*i + 1]];
+        p_Out[4*i + 2] = p_Table[p_In[4*i + 2]];
+        p_Out[4*i + 3] = (float)p_In[4*i + 3]*(1.0f/65535.0f);
+    }
+}
+
+template <typename T>
+static void processRowInt(int p_Width, int p_Height, int p_X1, int p_X2, int p_Y,
+                          const T* p_Input, T* p_Output, const OpenDRTRenderPlan& p_Plan, const OpenDRTIntEncode& p_Encode,
+                          OpenDRTScopes* p_Scopes, OpenDRTColorCache* p_Cache)
+{
+    const float toFloat = 1.0f/(float)((1 << p_Encode.containerBits) - 1);
+    const bool table = sizeof(T) == 2 && p_Plan.inputTable && !runsScalar(p_Plan);
+    float in[4*kSimdTileSize], out[4*kSimdTileSize];
+    for (int x = p_X1; x < p_X2; x += kSimdTileSize) {
+        const int n = p_X2 - x < kSimdTileSize ? p_X2 - x : kSimdTileSize;
+        if (table) {
+            linearizeCodes(reinterpret_cast<const uint16_t*>(p_Input), in, n, p_Plan.inputTable);
+            processSpan(p_Width, p_Height, x, x + n, p_Y, in, out, p_Plan, 0, p_Scopes, p_Cache);
+        }
+        else {
+            intToFloat(p_Input, in, 4*n, toFloat);
+            processSpan(p_Width, p_Height, x, x + n, p_Y, in, out, p_Plan, p_Plan.params.inOetf, p_Scopes, p_Cache);
+        }
+        floatToInt(out, p_Output, n, x, p_Y, p_Encode);
+        p_Input += 4*n;
+        p_Output += 4*n;
+    }
+}
+
+void processRowInt(int p_Width, int p_Height, int p_X1, int p_X2, int p_Y,
+                   const void* p_Input, void* p_Output, const OpenDRTRenderPlan& p_Plan, const OpenDRTIntEncode& p_Encode,
+                   OpenDRTScopes* p_Scopes, OpenDRTColorCache* p_Cache)
+{
+    if (p_Encode.containerBits == 8) {
+        processRowInt(p_Width, p_Height, p_X1, p_X2, p_Y, static_cast<const uint8_t*>(p_Input),
+                      static_cast<uint8_t*>(p_Output), p_Plan, p_Encode, p_Scopes, p_Cache);
+    }
+    else {
+        processRowInt(p_Width, p_Height, p_X1, p_X2, p_Y, static_cast<const uint16_t*>(p_Input),
+                      static_cast<uint16_t*>(p_Output), p_Plan, p_Encode, p_Scopes, p_Cache);
+    }
+}
+
+/***************************************************
+ Several display targets
+--------------------------------------------------*/
+// Each tile goes through the scene side once; every target but the last takes a copy of
+// it for its display side, and the last finishes the tile in place
+template <unsigned M>
+static void processTargetTiles(int p_X1, int p_X2, const float* p_Input, int p_Targets,
+                               const OpenDRTRenderPlan* const* p_Plans, float* const* p_Outputs)
+{
+    const OpenDRTRenderPlan& scene = *p_Plans[0];
+    Tile t, display;
+    for (int x = p_X1; x < p_X2; x += kSimdTileSize) {
+        const int n = p_X2 - x < kSimdTileSize ? p_X2 - x : kSimdTileSize;
+        loadTile(t, n, p_Input + 4*(x - p_X1));
+        processSceneTile<M>(t, n, scene, scene.params.inOetf);
+        for (int j = 0; j < p_Targets; ++j) {
+            const bool last = j + 1 == p_Targets;
+            if (!last) display = t;
+            Tile& d = last ? t : display;
+            processDisplayTile<M>(d, n, *p_Plans[j], 0);
+            storeTile(d, n, p_Outputs[j] + 4*(x - p_X1));
+        }
+    }
+}
+
+void processRowTargets(int p_X1, int p_X2, const float* p_Input, int p_Targets,
+                       const OpenDRTRenderPlan* const* p_Plans, float* const* p_Outputs)
+{
+#define OPENDRT_PROCESS_TARGET_TILES(MASK) \
+    case (MASK): processTargetTiles<(MASK)>(p_X1, p_X2, p_Input, p_Targets, p_Plans, p_Outputs); break;
+
+    switch (p_Plans[0]->kernelModules) {
+        OPENDRT_SPECIALIZED_MODULES(OPENDRT_PROCESS_TARGET_TILES)
+        default: processTargetTiles<kModulesDynamic>(p_X1, p_X2, p_Input, p_Targets, p_Plans, p_Outputs); break;
+    }
+#undef OPENDRT_PROCESS_TARGET_TILES
+}
+
+/***************************************************
+ Baked LUT
+--------------------------------------------------*/
+// DaVinci Intermediate encode, the shaper in front of LUTs baked for linear input
+SIMD_STAGE void lutShaperStage(Tile& t, int n)
+{
+    float* ch[3] = { t.r, t.g, t.b };
+    for (int c = 0; c < 3; ++c) {
+        float* v = ch[c];
+        for (int i = 0; i < n; ++i) {
+            const float x = v[i];
+            const float y = (simd_log2f(x + 0.0075f) + 7.0f)*0.07329248f;
+            v[i] = x <= 0.00262409f ? x*10.44426855f : y;
+        }
+    }
+}
+
+// Tetrahedral interpolation. The fractions are sorted with selects instead of branching on
+// the six tetrahedra, so the loop vectorizes with gathers for the four corner fetches.
+SIMD_STAGE void lutStage(Tile& t, int n, const OpenDRTBakedLUT& lut)
+{
+    const float* T = lut.table;
+    const int size = lut.size, last = size - 2;
+    const float lo = lut.domainMin, sc = lut.domainScale, hi = (float)(size - 1);
+    const int sr = 3, sg = 3*size, sb = 3*size*size, s111 = sr + sg + sb;
+    for (int i = 0; i < n; ++i) {
+        const float ur = minf(maxf((t.r[i] - lo)*sc, 0.0f), hi);
+        const float ug = minf(maxf((t.g[i] - lo)*sc, 0.0f), hi);
+        const float ub = minf(maxf((t.b[i] - lo)*sc, 0.0f), hi);
+        int ir = (int)ur, ig = (int)ug, ib = (int)ub;
+        ir = ir > last ? last : ir;
+        ig = ig > last ? last : ig;
+        ib = ib > last ? last : ib;
+        const float fr = ur - (float)ir, fg = ug - (float)ig, fb = ub - (float)ib;
+
+        // Largest and smallest fraction pick the two inner corners of the tetrahedron
+        const bool rMax = fr >= fg && fr >= fb;
+        const bool gMax = !rMax && fg >= fb;
+        const float fMax = rMax ? fr : (gMax ? fg : fb);
+        const int sMax = rMax ? sr : (gMax ? sg : sb);
+        const bool bMin = fb <= fr && fb <= fg;
+        const bool gMin = !bMin && fg <= fr;
+        const float fMin = bMin ? fb : (gMin ? fg : fr);
+        const int sMin = bMin ? sb : (gMin ? sg : sr);
+        const float fMid = fr + fg + fb - fMax - fMin;
+
+        const int v0 = ir*sr + ig*sg + ib*sb;
+        const int v1 = v0 + sMax, v2 = v0 + s111 - sMin, v3 = v0 + s111;
+        const float w0 = 1.0f - fMax, w1 = fMax - fMid, w2 = fMid - fMin, w3 = fMin;
+        t.r[i] = w0*T[v0] + w1*T[v1] + w2*T[v2] + w3*T[v3];
+        t.g[i] = w0*T[v0 + 1] + w1*T[v1 + 1] + w2*T[v2 + 1] + w3*T[v3 + 1];
+        t.b[i] = w0*T[v0 + 2] + w1*T[v1 + 2] + w2*T[v2 + 2] + w3*T[v3 + 2];
+    }
+}
+
+void processLUTRow(int p_X1, int p_X2, const float* p_Input, float* p_Output, const OpenDRTBakedLUT& p_LUT)
+{
+    Tile t;
+    for (int x = p_X1; x < p_X2; x += kSimdTileSize) {
+        const int n = p_X2 - x < kSimdTileSize ? p_X2 - x : kSimdTileSize;
+        loadTile(t, n, p_Input);
+        if (p_LUT.shaper == kLUTShaperIntermediate) lutShaperStage(t, n);
+        lutStage(t, n, p_LUT);
+        storeTile(t, n, p_Output);
+        p_Input += 4*n;
+        p_Output += 4*n;
+    }
+}
+
+void processLUTRowHalf(int p_X1, int p_X2, const uint16_t* p_Input, uint16_t* p_Output, const OpenDRTBakedLUT& p_LUT)
+{
+    float in[4*kSimdTileSize], out[4*kSimdTileSize];
+    for (int x = p_X1; x < p_X2; x += kSimdTileSize) {
+        const int n = p_X2 - x < kSimdTileSize ? p_X2 - x : kSimdTileSize;
+        simd_half_to_float_n(p_Input, in, 4*n);
+        processLUTRow(x, x + n, in, out, p_LUT);
+        simd_float_to_half_n(out, p_Output, 4*n);
+        p_Input += 4*n;
+        p_Output += 4*n;
+    }
+}
+
+template <typename T>
+static void processLUTRowInt(int p_X1, int p_X2, int p_Y, const T* p_Input, T* p_Output,
+                             const OpenDRTBakedLUT& p_LUT, const OpenDRTIntEncode& p_Encode)
+{
+    const float toFloat = 1.0f/(float)((1 << p_Encode.containerBits) - 1);
+    float in[4*kSimdTileSize], out[4*kSimdTileSize];
+    for (int x = p_X1; x < p_X2; x += kSimdTileSize) {
+        const int n = p_X2 - x < kSimdTileSize ? p_X2 - x : kSimdTileSize;
+        intToFloat(p_Input, in, 4*n, toFloat);
+        processLUTRow(x, x + n, in, out, p_LUT);
+        floatToInt(out, p_Output, n, x, p_Y, p_Encode);
+        p_Input += 4*n;
+        p_Output += 4*n;
+    }
+}
+
+void processLUTRowInt(int p_X1, int p_X2, int p_Y, const void* p_Input, void* p_Output,
+                      const OpenDRTBakedLUT& p_LUT, const OpenDRTIntEncode& p_Encode)
+{
+    if (p_Encode.containerBits == 8) {
+        processLUTRowInt(p_X1, p_X2, p_Y, static_cast<const uint8_t*>(p_Input), static_cast<uint8_t*>(p_Output), p_LUT, p_Encode);
+    }
+    else {
+        processLUTRowInt(p_X1, p_X2, p_Y, static_cast<const uint16_t*>(p_Input), static_cast<uint16_t*>(p_Output), p_LUT, p_Encode);
+    }
+}
+
+} // namespace SIMD_KERNEL_NAMESPACE
+
+#ifdef SIMD_KERNEL_DISPATCH
+/***************************************************
+ Runtime dispatch
+--------------------------------------------------*/
+typedef void (*SimdRowFunc)(int, int, int, int, int, const float*, float*, const OpenDRTRenderPlan&, OpenDRTScopes*,
+                            OpenDRTColorCache*);
+typedef void (*SimdLUTRowFunc)(int, int, const float*, float*, const OpenDRTBakedLUT&);
+typedef void (*SimdRowHalfFunc)(int, int, int, int, int, const uint16_t*, uint16_t*, const OpenDRTRenderPlan&, OpenDRTScopes*,
+                                OpenDRTColorCache*);
+typedef void (*SimdLUTRowHalfFunc)(int, int, const uint16_t*, uint16_t*, const OpenDRTBakedLUT&);
+typedef void (*SimdRowIntFunc)(int, int, int, int, int, const void*, void*, const OpenDRTRenderPlan&, const OpenDRTIntEncode&,
+                               OpenDRTScopes*, OpenDRTColorCache*);
+typedef void (*SimdLUTRowIntFunc)(int, int, int, const void*, void*, const OpenDRTBakedLUT&, const OpenDRTIntEncode&);
+typedef void (*SimdRowTargetsFunc)(int, int, const float*, int, const OpenDRTRenderPlan* const*, float* const*);
+
+struct SimdKernelTable
+{
+    SimdRowFunc row;
+    SimdLUTRowFunc lutRow;
+    SimdRowHalfFunc rowHalf;
+    SimdLUTRowHalfFunc lutRowHalf;
+    SimdRowIntFunc rowInt;
+    SimdLUTRowIntFunc lutRowInt;
+    SimdRowTargetsFunc rowTargets;
+    const char* name;
+};
+
+#define SIMD_KERNEL_DECLARE(NS) \
+    namespace NS { \
+    void processRow(int p_Width, int p_Height, int p_X1, int p_X2, int p_Y, \
+                    const float* p_Input, float* p_Output, const OpenDRTRenderPlan& p_Plan, OpenDRTScopes* p_Scopes, \
+                    OpenDRTColorCache* p_Cache); \
+    void processLUTRow(int p_X1, int p_X2, const float* p_Input, float* p_Output, const OpenDRTBakedLUT& p_LUT); \
+    void processRowHalf(int p_Width, int p_Height, int p_X1, int p_X2, int p_Y, \
+                        const uint16_t* p_Input, uint16_t* p_Output, const OpenDRTRenderPlan& p_Plan, OpenDRTScopes* p_Scopes, \
+                        OpenDRTColorCache* p_Cache); \
+    void processLUTRowHalf(int p_X1, int p_X2, const uint16_t* p_Input, uint16_t* p_Output, const OpenDRTBakedLUT& p_LUT); \
+    void processRowInt(int p_Width, int p_Height, int p_X1, int p_X2, int p_Y, \
+                       const void* p_Input, void* p_Output, const OpenDRTRenderPlan& p_Plan, const OpenDRTIntEncode& p_Encode, \
+                       OpenDRTScopes* p_Scopes, OpenDRTColorCache* p_Cache); \
+    void processLUTRowInt(int p_X1, int p_X2, int p_Y, const void* p_Input, void* p_Output, \
+                          const OpenDRTBakedLUT& p_LUT, const OpenDRTIntEncode& p_Encode); \
+    void processRowTargets(int p_X1, int p_X2, const float* p_Input, int p_Targets, \
+                           const OpenDRTRenderPlan* const* p_Plans, float* const* p_Outputs); \
+    }
+
+#ifdef OPENDRT_SIMD_X86_DISPATCH
+SIMD_KERNEL_DECLARE(SimdKernel_avx2)
+SIMD_KERNEL_DECLARE(SimdKernel_avx512)
+#endif
+
+static SimdKernelTable selectSIMDKernel()
+{
+#ifdef OPENDRT_SIMD_X86_DISPATCH
+    // OPENDRT_SIMD_ISA=avx2 or baseline caps the choice, to compare the builds on one
+    // machine (make bench)
+    const char* cap = getenv("OPENDRT_SIMD_ISA");
+    const bool allowAvx512 = !cap || !*cap || strcmp(cap, "avx512") == 0;
+    const bool allowAvx2 = allowAvx512 || strcmp(cap, "avx2") == 0;
+
+    __builtin_cpu_init();
+    // Both x86 builds also use F16C for the half-float conversions
+    const bool f16c = __builtin_cpu_supports("f16c");
+    if (allowAvx512 && __builtin_cpu_supports("avx512f") && f16c) {
+        const SimdKernelTable table = { SimdKernel_avx512::processRow, SimdKernel_avx512::processLUTRow,
+                                        SimdKernel_avx512::processRowHalf, SimdKernel_avx512::processLUTRowHalf,
+                                        SimdKernel_avx512::processRowInt, SimdKernel_avx512::processLUTRowInt,
+                                        SimdKernel_avx512::processRowTargets, "avx512" };
+        return table;
+    }
+    if (allowAvx2 && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && f16c) {
+        const SimdKernelTable table = { SimdKernel_avx2::processRow, SimdKernel_avx2::processLUTRow,
+                                        SimdKernel_avx2::processRowHalf, SimdKernel_avx2::processLUTRowHalf,
+                                        SimdKernel_avx2::processRowInt, SimdKernel_avx2::processLUTRowInt,
+                                        SimdKernel_avx2::processRowTargets, "avx2" };
+        return table;
+    }
+#endif
+    const SimdKernelTable table = { SimdKernel_baseline::processRow, SimdKernel_baseline::processLUTRow,
+                                    SimdKernel_baseline::processRowHalf, SimdKernel_baseline::processLUTRowHalf,
+                                    SimdKernel_baseline::processRowInt, SimdKernel_baseline::processLUTRowInt,
+                                    SimdKernel_baseline::processRowTargets, "baseline" };
+    return table;
+}
+
+static const SimdKernelTable& getSIMDKernel()
+{
+    // Function-local static: initialised once, thread-safe under C++11
+    static const SimdKernelTable table = selectSIMDKernel();
+    return table;
+}
+
+const char* getSIMDKernelISA()
+{
+    return getSIMDKernel().name;
+}
+
+void RunSIMDKernelRow(int p_Width, int p_Height, int p_X1, int p_X2, int p_Y,
+                      const float* p_Input, float* p_Output, const OpenDRTRenderPlan& p_Plan, OpenDRTScopes* p_Scopes,
+                      OpenDRTColorCache* p_Cache)
+{
+    getSIMDKernel().row(p_Width, p_Height, p_X1, p_X2, p_Y, p_Input, p_Output, p_Plan, p_Scopes, p_Cache);
+}
+
+void RunSIMDLUTRow(int p_X1, int p_X2, const float* p_Input, float* p_Output, const OpenDRTBakedLUT& p_LUT)
+{
+    getSIMDKernel().lutRow(p_X1, p_X2, p_Input, p_Output, p_LUT);
+}
+
+void RunSIMDKernelRow(int p_Width, int p_Height, int p_X1, int p_X2, int p_Y,
+                      const uint16_t* p_Input, uint16_t* p_Output, const OpenDRTRenderPlan& p_Plan, OpenDRTScopes* p_Scopes,
+                      OpenDRTColorCache* p_Cache)
+{
+    getSIMDKernel().rowHalf(p_Width, p_Height, p_X1, p_X2, p_Y, p_Input, p_Output, p_Plan, p_Scopes, p_Cache);
+}
+
+void RunSIMDLUTRow(int p_X1, int p_X2, const uint16_t* p_Input, uint16_t* p_Output, const OpenDRTBakedLUT& p_LUT)
+{
+    getSIMDKernel().lutRowHalf(p_X1, p_X2, p_Input, p_Output, p_LUT);
+}
+
+void RunSIMDKernelRow(int p_Width, int p_Height, int p_X1, int p_X2, int p_Y,
+                      const void* p_Input, void* p_Output, const OpenDRTRenderPlan& p_Plan, const OpenDRTIntEncode& p_Encode,
+                      OpenDRTScopes* p_Scopes, OpenDRTColorCache* p_Cache)
+{
+    getSIMDKernel().rowInt(p_Width, p_Height, p_X1, p_X2, p_Y, p_Input, p_Output, p_Plan, p_Encode, p_Scopes, p_Cache);
+}
+
+void RunSIMDLUTRow(int p_X1, int p_X2, int p_Y, const void* p_Input, void* p_Output,
+                   const OpenDRTBakedLUT& p_LUT, const OpenDRTIntEncode& p_Encode)
+{
+    getSIMDKernel().lutRowInt(p_X1, p_X2, p_Y, p_Input, p_Output, p_LUT, p_Encode);
+}
+
+void RunSIMDKernelRowTargets(int p_Width, int p_Height, int p_X1, int p_X2, int p_Y, const float* p_Input,
+                             int p_Targets, const OpenDRTRenderPlan* const* p_Plans, float* const* p_Outputs)
+{
+    // Only the vectorized kernel is split, and the patterns and overlay are per target
+    bool shared = true;
+    for (int j = 0; shared && j < p_Targets; ++j) {
+        const OpenDRTRenderPlan& plan = *p_Plans[j];
+        shared = !runsScalar(plan) && !plan.overlay && !hasTestPattern(plan.params, p_Y) &&
+                 sameSceneSide(*p_Plans[0], plan);
+    }
+    if (!shared) {
+        for (int j = 0; j < p_Targets; ++j) {
+            RunSIMDKernelRow(p_Width, p_Height, p_X1, p_X2, p_Y, p_Input, p_Outputs[j], *p_Plans[j]);
+        }
+        return;
+    }
+    getSIMDKernel().rowTargets(p_X1, p_X2, p_Input, p_Targets, p_Plans, p_Outputs);
+}
+#endif // SIMD_KERNEL_DISPATCH
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include "OpenDRTRenderPlan.h"
+#include "OpenDRTBakedLUT.h"
+#include "OpenDRTDither.h"
+#include "OpenDRTScopes.h"
+#include "OpenDRTColorCache.h"
+
+// Vectorized CPU kernel.
+//
+// SimdKernel.cpp is a structure-of-arrays rewrite of the scalar port in OpenCLKernel.cpp:
+// each row is deinterleaved into tiles of kSimdTileSize pixels (R, G, B, A plus the
+// per-pixel intermediates, 16 KB, so a tile stays in L1), every module runs as a
+// straight loop over the tile and the result is interleaved back into RGBA. The math in
+// SimdMath.h is branch-free so the loops auto-vectorize (4 lanes SSE/NEON, 8 AVX2,
+// 16 AVX-512).
+//
+// On x86-64 Linux the file is compiled three times (baseline, -mavx2, -mavx512f; with FMA/F16C)
+// and RunSIMDKernelRow() picks the widest one the CPU supports the first time it runs;
+// OPENDRT_SIMD_ISA=avx2 or baseline in the environment caps it.
+// Other targets build only the baseline object, which is NEON on arm64.
+//
+// Accuracy against the scalar path, as measured by OpenDRTBench (make bench: every look
+// preset x display encoding x display gamut, linear/Intermediate/ACEScct input over a
+// 33^3 lattice), max abs error in display-encoded output:
+// - analytic tonescale: 7.8e-5 on AVX2 and AVX-512, for PQ (2.2e-5 for the others);
+//   1.5e-5 baseline
+// - the default tables, 256 nodes per stop and the hue tables: 4.4e-5 on every ISA
+// - 64 nodes per stop: 9.3e-4 for PQ, 2.6e-4 for the others
+// The one intended difference is the HLG encode of black and below, which is 0 here
+// instead of the scalar NaN.
+// Rows at Exact precision go through the scalar kernel; the test patterns and tonescale
+// overlay are drawn around either kernel (OpenDRTOverlay.h). OpenDRTBench, one thread,
+// DaVinci Wide Gamut Intermediate to Rec.709 2.4, best of 3 on a loaded single-core VM:
+// Default look 28.5 Mpix/s on AVX-512, 13.7 AVX2, 5.1 baseline, against 2.2 Exact; the
+// Base look 41.8, 30.6 and 8.8 against 3.3.
+//
+// p_Scopes, if set, accumulates the output scopes of the span (OpenDRTScopes.h), and
+// p_Cache, if set, lets repeated colours skip the kernel (OpenDRTColorCache.h); both
+// belong to the calling thread.
+
+#define kSimdTileSize 256
+
+void RunSIMDKernelRow(int p_Width, int p_Height, int p_X1, int p_X2, int p_Y,
+                      const float* p_Input, float* p_Output, const OpenDRTRenderPlan& p_Plan,
+                      OpenDRTScopes* p_Scopes = 0, OpenDRTColorCache* p_Cache = 0);
+
+// Applies a baked LUT (shaper and tetrahedral interpolation) to the packed RGBA span
+// [p_X1, p_X2); alpha passes through
+void RunSIMDLUTRow(int p_X1, int p_X2, const float* p_Input, float* p_Output, const OpenDRTBakedLUT& p_LUT);
+
+// The same for half-float RGBA (IEEE half bits, OFX eBitDepthHalf). Pixels are converted to
+// float a tile at a time on load and back on store (F16C on x86, NEON on arm64) and the
+// transform runs in float, so the output only differs by the final rounding to half.
+void RunSIMDKernelRow(int p_Width, int p_Height, int p_X1, int p_X2, int p_Y,
+                      const uint16_t* p_Input, uint16_t* p_Output, const OpenDRTRenderPlan& p_Plan,
+                      OpenDRTScopes* p_Scopes = 0, OpenDRTColorCache* p_Cache = 0);
+void RunSIMDLUTRow(int p_X1, int p_X2, const uint16_t* p_Input, uint16_t* p_Output, const OpenDRTBakedLUT& p_LUT);
+
+// The same for 8- and 16-bit integer RGBA, as p_Encode.containerBits. Code values are read
+// as full range and the store quantizes and dithers as p_Encode (see OpenDRTDither.h);
+// p_Y, frame-relative, places the dither pattern.
+void RunSIMDKernelRow(int p_Width, int p_Height, int p_X1, int p_X2, int p_Y,
+                      const void* p_Input, void* p_Output, const OpenDRTRenderPlan& p_Plan, const OpenDRTIntEncode& p_Encode,
+                      OpenDRTScopes* p_Scopes = 0, OpenDRTColorCache* p_Cache = 0);
+void RunSIMDLUTRow(int p_X1, int p_X2, int p_Y, const void* p_Input, void* p_Output,
+                   const OpenDRTBakedLUT& p_LUT, const OpenDRTIntEncode& p_Encode);
+
+// One input span rendered for several display targets, say an SDR and an HDR deliverable:
+// p_Outputs[j] receives the span through p_Plans[j]. Plans that agree on the scene side
+// (sameSceneSide()) share it, so each pixel is linearized, matrixed and given its norms
+// and hue windows once, and only the tonescale onwards runs per target; the result is
+// bit-identical to a RunSIMDKernelRow() per target, which is what other plans, Exact
+// precision and the patterns and overlay fall back to.
+void RunSIMDKernelRowTargets(int p_Width, int p_Height, int p_X1, int p_X2, int p_Y, const float* p_Input,
+                             int p_Targets, const OpenDRTRenderPlan* const* p_Plans, float* const* p_Outputs);
+
+// Name of the instruction set the dispatcher selected ("avx512", "avx2" or "baseline")
+const char* getSIMDKernelISA();